@@ -0,0 +1,255 @@
+/**
+ * @file AssetWatcher.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief AssetWatcher class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "AssetWatcher.h"
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+using Clock = std::chrono::steady_clock;
+
+// how long the thread waits for events before checking if it must stop
+static constexpr int POLL_MILLISECONDS = 50;
+
+static bool hasExtension( const std::string &path, const std::string &extension ) {
+    return path.size() >= extension.size() && path.compare( path.size() - extension.size(), extension.size(), extension ) == 0;
+}
+
+/**
+ * Reports the files that have been quiet for SETTLE_TIME.
+ */
+static void reportSettled( std::map<std::string, Clock::time_point> &pending, const AssetWatcher::ChangeCallback &callback ) {
+
+    const Clock::time_point now = Clock::now();
+
+    for ( auto it = pending.begin(); it != pending.end(); ) {
+        if ( now - it->second >= AssetWatcher::SETTLE_TIME ) {
+            callback( it->first );
+            it = pending.erase( it );
+        } else {
+            ++it;
+        }
+    }
+
+}
+
+AssetWatcher::AssetWatcher()
+    :
+    running( false ) {
+}
+
+AssetWatcher::~AssetWatcher() {
+    stop();
+}
+
+bool AssetWatcher::start( const std::string &root, const std::string &extension, ChangeCallback callback ) {
+
+    stop();
+
+    std::error_code ec;
+    if ( !fs::is_directory( root, ec ) ) {
+        return false;
+    }
+
+    this->root = root;
+    this->extension = extension;
+    this->callback = std::move( callback );
+    running = true;
+    thread = std::thread( &AssetWatcher::run, this );
+
+    return true;
+
+}
+
+void AssetWatcher::stop() {
+    running = false;
+    if ( thread.joinable() ) {
+        thread.join();
+    }
+}
+
+bool AssetWatcher::isRunning() const {
+    return running;
+}
+
+#if defined( _WIN32 )
+
+/**
+ * One overlapped ReadDirectoryChangesW over the whole tree, waited on with
+ * a timeout so the thread can be stopped.
+ */
+void AssetWatcher::run() {
+
+    HANDLE directory = CreateFileA( root.c_str(), FILE_LIST_DIRECTORY,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                    OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr );
+
+    if ( directory == INVALID_HANDLE_VALUE ) {
+        running = false;
+        return;
+    }
+
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = CreateEventA( nullptr, TRUE, FALSE, nullptr );
+
+    alignas( DWORD ) char buffer[16384];
+    std::map<std::string, Clock::time_point> pending;
+
+    const DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME;
+    bool reading = ReadDirectoryChangesW( directory, buffer, sizeof( buffer ), TRUE, filter, nullptr, &overlapped, nullptr );
+
+    while ( running && reading ) {
+
+        if ( WaitForSingleObject( overlapped.hEvent, POLL_MILLISECONDS ) == WAIT_OBJECT_0 ) {
+
+            DWORD bytes = 0;
+            GetOverlappedResult( directory, &overlapped, &bytes, FALSE );
+
+            for ( DWORD offset = 0; bytes > 0; ) {
+
+                const FILE_NOTIFY_INFORMATION *info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>( buffer + offset );
+
+                if ( info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME ) {
+                    const int wideLength = static_cast<int>( info->FileNameLength / sizeof( WCHAR ) );
+                    const int length = WideCharToMultiByte( CP_UTF8, 0, info->FileName, wideLength, nullptr, 0, nullptr, nullptr );
+                    std::string name( length, '\0' );
+                    WideCharToMultiByte( CP_UTF8, 0, info->FileName, wideLength, name.data(), length, nullptr, nullptr );
+                    for ( char &c : name ) {
+                        if ( c == '\\' ) {
+                            c = '/';
+                        }
+                    }
+                    if ( hasExtension( name, extension ) ) {
+                        pending[root + '/' + name] = Clock::now();
+                    }
+                }
+
+                if ( info->NextEntryOffset == 0 ) {
+                    break;
+                }
+                offset += info->NextEntryOffset;
+
+            }
+
+            ResetEvent( overlapped.hEvent );
+            reading = ReadDirectoryChangesW( directory, buffer, sizeof( buffer ), TRUE, filter, nullptr, &overlapped, nullptr );
+
+        }
+
+        reportSettled( pending, callback );
+
+    }
+
+    CancelIo( directory );
+    DWORD bytes = 0;
+    GetOverlappedResult( directory, &overlapped, &bytes, TRUE );
+    CloseHandle( overlapped.hEvent );
+    CloseHandle( directory );
+
+}
+
+#else
+
+/**
+ * inotify has no recursive watches: every directory of the tree is watched,
+ * including the ones created later.
+ */
+void AssetWatcher::run() {
+
+    const int fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+
+    if ( fd == -1 ) {
+        running = false;
+        return;
+    }
+
+    std::map<int, std::string> directories;
+
+    const auto watchTree = [&]( const std::string &path ) {
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+        const int wd = inotify_add_watch( fd, path.c_str(), mask );
+        if ( wd != -1 ) {
+            directories[wd] = path;
+        }
+        std::error_code ec;
+        for ( fs::recursive_directory_iterator it( path, ec ), end; it != end; it.increment( ec ) ) {
+            if ( it->is_directory( ec ) ) {
+                const std::string directory = it->path().generic_string();
+                const int subWd = inotify_add_watch( fd, directory.c_str(), mask );
+                if ( subWd != -1 ) {
+                    directories[subWd] = directory;
+                }
+            }
+        }
+    };
+
+    watchTree( root );
+
+    alignas( inotify_event ) char buffer[4096];
+    std::map<std::string, Clock::time_point> pending;
+
+    while ( running ) {
+
+        pollfd request( fd, POLLIN, 0 );
+
+        if ( poll( &request, 1, POLL_MILLISECONDS ) > 0 ) {
+
+            ssize_t length;
+
+            while ( ( length = read( fd, buffer, sizeof( buffer ) ) ) > 0 ) {
+
+                for ( char *p = buffer; p < buffer + length; ) {
+
+                    const inotify_event *event = reinterpret_cast<const inotify_event*>( p );
+                    p += sizeof( inotify_event ) + event->len;
+
+                    const auto directory = directories.find( event->wd );
+                    if ( event->len == 0 || directory == directories.end() ) {
+                        continue;
+                    }
+
+                    const std::string path = directory->second + '/' + event->name;
+
+                    if ( event->mask & IN_ISDIR ) {
+                        if ( event->mask & ( IN_CREATE | IN_MOVED_TO ) ) {
+                            watchTree( path );
+                        }
+                    } else if ( ( event->mask & ( IN_CLOSE_WRITE | IN_MOVED_TO ) ) && hasExtension( path, extension ) ) {
+                        pending[path] = Clock::now();
+                    }
+
+                }
+
+            }
+
+        }
+
+        reportSettled( pending, callback );
+
+    }
+
+    close( fd );
+
+}
+
+#endif
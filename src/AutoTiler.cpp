@@ -0,0 +1,155 @@
+/**
+ * @file AutoTiler.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief AutoTiler class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "AutoTiler.h"
+#include "DirtyRegion.h"
+#include "TileLayer.h"
+
+AutoTiler::AutoTiler() {
+    for ( auto &set : pieces ) {
+        set.fill( TileLayer::EMPTY_TILE );
+    }
+}
+
+AutoTiler::~AutoTiler() = default;
+
+/**
+ * A: fill, B: top, C: left side, D: right side, E: top left corner,
+ * F: top right corner, G: inner corner open to the top left, H: inner
+ * corner open to the top right.
+ */
+static std::array<char, 256> buildPieceTable() {
+
+    std::array<char, 256> table;
+
+    for ( int mask = 0; mask < 256; mask++ ) {
+
+        const bool north = mask & AutoTiler::NORTH;
+        const bool east = mask & AutoTiler::EAST;
+        const bool west = mask & AutoTiler::WEST;
+
+        char piece = 'A';
+
+        if ( !north ) {
+            if ( !west && east ) {
+                piece = 'E';
+            } else if ( !east && west ) {
+                piece = 'F';
+            } else {
+                piece = 'B';
+            }
+        } else if ( !west && east ) {
+            piece = 'C';
+        } else if ( !east && west ) {
+            piece = 'D';
+        } else if ( west && east && !( mask & AutoTiler::NORTH_WEST ) ) {
+            piece = 'G';
+        } else if ( west && east && !( mask & AutoTiler::NORTH_EAST ) ) {
+            piece = 'H';
+        }
+
+        table[mask] = piece;
+
+    }
+
+    return table;
+
+}
+
+const std::array<char, 256> &AutoTiler::getPieceTable() {
+    static const std::array<char, 256> table = buildPieceTable();
+    return table;
+}
+
+/**
+ * Registers the palette indexes of the pieces A..R of a set.
+ */
+void AutoTiler::setPieces( int set, const std::array<uint16_t, 18> &paletteIndexes ) {
+
+    pieces[set] = paletteIndexes;
+
+    for ( int p = 0; p < TERRAIN_PIECES; p++ ) {
+        const uint16_t tileId = paletteIndexes[p];
+        if ( tileId >= terrainSets.size() ) {
+            terrainSets.resize( tileId + 1, 0 );
+        }
+        terrainSets[tileId] = static_cast<uint8_t>( set );
+    }
+
+}
+
+int AutoTiler::getTerrainSet( uint16_t tileId ) const {
+    return tileId < terrainSets.size() ? terrainSets[tileId] : 0;
+}
+
+bool AutoTiler::isTerrain( uint16_t tileId ) const {
+    return getTerrainSet( tileId ) != 0;
+}
+
+/**
+ * Recomputes the terrain cells of the rectangle and of the cells around
+ * it, since their neighbours may have changed. Only the piece of a cell
+ * changes, never whether it is terrain, so one pass is enough. Returns how
+ * many cells changed.
+ */
+int AutoTiler::retile( TileLayer &layer, const DirtyRect &rect ) const {
+
+    const auto &table = getPieceTable();
+    const int lines = layer.getLines();
+    const int columns = layer.getColumns();
+    const int line = std::max( rect.line - 1, 0 );
+    const int column = std::max( rect.column - 1, 0 );
+    const int endLine = std::min( rect.line + rect.lines + 1, lines );
+    const int endColumn = std::min( rect.column + rect.columns + 1, columns );
+
+    static constexpr int offsets[8][2] = {
+        { -1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }
+    };
+
+    int changed = 0;
+
+    for ( int i = line; i < endLine; i++ ) {
+        for ( int j = column; j < endColumn; j++ ) {
+
+            const int p = layer.getIndex( i, j );
+            const uint16_t tileId = layer.getTileId( p );
+            const int set = getTerrainSet( tileId );
+
+            if ( set == 0 ) {
+                continue;
+            }
+
+            uint8_t mask = 0;
+
+            for ( int n = 0; n < 8; n++ ) {
+                const int ni = i + offsets[n][0];
+                const int nj = j + offsets[n][1];
+                const bool outside = ni < 0 || ni >= lines || nj < 0 || nj >= columns;
+                // the top of the map is open, the other borders continue the terrain
+                if ( outside ? ni >= 0 : getTerrainSet( layer.getTileId( layer.getIndex( ni, nj ) ) ) == set ) {
+                    mask |= 1 << n;
+                }
+            }
+
+            const uint16_t pieceId = pieces[set][table[mask] - 'A'];
+
+            if ( pieceId != tileId ) {
+                layer.setTile( p, pieceId, layer.getCollisionType( p ), layer.isVisible( p ) );
+                changed++;
+            }
+
+        }
+    }
+
+    return changed;
+
+}
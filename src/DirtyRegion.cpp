@@ -0,0 +1,64 @@
+/**
+ * @file DirtyRegion.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief DirtyRegion class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+
+#include "DirtyRegion.h"
+
+DirtyRegion::DirtyRegion( int maxLines, int maxColumns )
+    :
+    maxLines( maxLines ),
+    maxColumns( maxColumns ),
+    bounds( DirtyRect( 0, 0, 0, 0 ) ),
+    empty( true ) {
+}
+
+DirtyRegion::~DirtyRegion() = default;
+
+void DirtyRegion::markRect( const DirtyRect &rect ) {
+
+    const int line = std::max( rect.line, 0 );
+    const int column = std::max( rect.column, 0 );
+    const int endLine = std::min( rect.line + rect.lines, maxLines );
+    const int endColumn = std::min( rect.column + rect.columns, maxColumns );
+
+    if ( line >= endLine || column >= endColumn ) {
+        return;
+    }
+
+    if ( empty ) {
+        bounds = DirtyRect( line, column, endLine - line, endColumn - column );
+        empty = false;
+    } else {
+        const int boundsEndLine = std::max( bounds.line + bounds.lines, endLine );
+        const int boundsEndColumn = std::max( bounds.column + bounds.columns, endColumn );
+        bounds.line = std::min( bounds.line, line );
+        bounds.column = std::min( bounds.column, column );
+        bounds.lines = boundsEndLine - bounds.line;
+        bounds.columns = boundsEndColumn - bounds.column;
+    }
+
+}
+
+void DirtyRegion::markAll() {
+    markRect( DirtyRect( 0, 0, maxLines, maxColumns ) );
+}
+
+void DirtyRegion::clear() {
+    if ( !empty ) {
+        bounds = DirtyRect( 0, 0, 0, 0 );
+        empty = true;
+    }
+}
+
+bool DirtyRegion::isEmpty() const {
+    return empty;
+}
+
+const DirtyRect &DirtyRegion::getBounds() const {
+    return bounds;
+}
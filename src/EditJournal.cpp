@@ -0,0 +1,364 @@
+/**
+ * @file EditJournal.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief EditJournal class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "DirtyRegion.h"
+#include "EditJournal.h"
+#include "TileLayer.h"
+
+EditJournal::EditJournal( size_t capacity )
+    :
+    layers( nullptr ),
+    runs( std::max<size_t>( capacity / 4, 1 ) ),
+    words( std::max<size_t>( capacity, 1 ) * 2 ),
+    runHead( 0 ),
+    wordHead( 0 ),
+    applied( 0 ),
+    open( false ),
+    recording( false ),
+    overflowed( false ),
+    mergeKey( 0 ) {
+}
+
+EditJournal::~EditJournal() {
+    if ( layers != nullptr ) {
+        for ( size_t k = 0; k < layers->size(); k++ ) {
+            ( *layers )[k].unsubscribe( listenerIds[k] );
+        }
+    }
+}
+
+/**
+ * The layers vector must not be resized afterwards, since the journal keeps
+ * listening to each layer.
+ */
+void EditJournal::attach( std::vector<TileLayer> &layers ) {
+
+    this->layers = &layers;
+    shadows.resize( layers.size() );
+
+    for ( size_t k = 0; k < layers.size(); k++ ) {
+        const TileLayer &layer = layers[k];
+        shadows[k].cells.assign( layer.getMaxLines() * layer.getMaxColumns(), 0 );
+        syncShadow( static_cast<int>( k ) );
+        listenerIds.push_back( layers[k].subscribe( [this, k]( const DirtyRect &rect, uint8_t changes ) {
+            if ( changes & TileLayer::TILES_CHANGED ) {
+                onChange( static_cast<int>( k ), rect );
+            }
+        }));
+    }
+
+}
+
+/**
+ * Opens a command. Everything changed until endCommand is one step of the
+ * history. A command with a non-zero merge key that follows another one
+ * with the same key is merged into it, so a whole drag is undone at once.
+ */
+void EditJournal::beginCommand( int mergeKey ) {
+    open = true;
+    recording = false;
+    overflowed = false;
+    this->mergeKey = mergeKey;
+}
+
+void EditJournal::endCommand() {
+
+    flushTouched();
+
+    if ( recording ) {
+        if ( overflowed ) {
+            // the command can not be undone, so neither can anything before it
+            commands.clear();
+            applied = 0;
+        } else if ( commands.back().runCount == 0 ) {
+            commands.pop_back();
+            applied = commands.size();
+        }
+    }
+
+    open = false;
+    recording = false;
+
+}
+
+bool EditJournal::undo() {
+
+    if ( open || applied == 0 ) {
+        return false;
+    }
+
+    const Command &command = commands[--applied];
+    uint64_t word = command.firstWord + command.wordCount;
+    for ( size_t i = command.runCount; i > 0; i-- ) {
+        const CellRun &run = runs[( command.firstRun + i - 1 ) % runs.size()];
+        word -= 2 * run.count;
+        apply( run, word, true );
+    }
+
+    return true;
+
+}
+
+bool EditJournal::redo() {
+
+    if ( open || applied == commands.size() ) {
+        return false;
+    }
+
+    const Command &command = commands[applied++];
+    uint64_t word = command.firstWord;
+    for ( size_t i = 0; i < command.runCount; i++ ) {
+        const CellRun &run = runs[( command.firstRun + i ) % runs.size()];
+        apply( run, word, false );
+        word += 2 * run.count;
+    }
+
+    return true;
+
+}
+
+bool EditJournal::canUndo() const {
+    return applied > 0;
+}
+
+bool EditJournal::canRedo() const {
+    return applied < commands.size();
+}
+
+void EditJournal::clear() {
+    commands.clear();
+    applied = 0;
+    recording = false;
+}
+
+/**
+ * Both sides of every change are marked, for the commands that can be
+ * undone and for the ones that can be redone.
+ */
+void EditJournal::markTileIds( std::vector<bool> &used ) const {
+
+    for ( const Command &command : commands ) {
+        uint64_t word = command.firstWord;
+        for ( size_t i = 0; i < command.runCount; i++ ) {
+            const CellRun &run = runs[( command.firstRun + i ) % runs.size()];
+            if ( run.first != RESIZE ) {
+                for ( int k = 0; k < 2 * run.count; k++ ) {
+                    const size_t tileId = words[( word + k ) % words.size()] >> 8;
+                    if ( tileId < used.size() ) {
+                        used[tileId] = true;
+                    }
+                }
+            }
+            word += 2 * run.count;
+        }
+    }
+
+}
+
+/**
+ * Outside of commands the shadow just follows the layer. Inside them the
+ * changed cells are only collected, to be compared when the command ends.
+ * A resize moves every line, so the cells it removes are recorded (where
+ * they were before the resize) followed by the resize itself, and the
+ * shadow is copied again. The layer is notified after it was resized, so
+ * the cells touched before are read where the resize moved them.
+ */
+void EditJournal::onChange( int layer, const DirtyRect &rect ) {
+
+    const TileLayer &tileLayer = ( *layers )[layer];
+    Shadow &shadow = shadows[layer];
+
+    if ( shadow.lines != tileLayer.getLines() || shadow.columns != tileLayer.getColumns() ) {
+
+        if ( open ) {
+
+            flushTouched( layer, tileLayer.getLines() - shadow.lines );
+
+            const uint32_t emptyCell = TileLayer::DEFAULT_FLAGS;
+            const int removedLines = std::max( shadow.lines - tileLayer.getLines(), 0 );
+
+            for ( int i = 0; i < shadow.lines; i++ ) {
+                for ( int j = 0; j < shadow.columns; j++ ) {
+                    const int p = tileLayer.getIndex( i, j );
+                    if ( ( i < removedLines || j >= tileLayer.getColumns() ) && shadow.cells[p] != emptyCell ) {
+                        append( layer, p, shadow.cells[p], emptyCell );
+                    }
+                }
+            }
+
+            append( layer, RESIZE,
+                static_cast<uint32_t>( shadow.lines << 16 | shadow.columns ),
+                static_cast<uint32_t>( tileLayer.getLines() << 16 | tileLayer.getColumns() ) );
+
+        }
+
+        syncShadow( layer );
+        return;
+
+    }
+
+    const int endLine = std::min( rect.line + rect.lines, shadow.lines );
+    const int endColumn = std::min( rect.column + rect.columns, shadow.columns );
+
+    for ( int i = std::max( rect.line, 0 ); i < endLine; i++ ) {
+        for ( int j = std::max( rect.column, 0 ); j < endColumn; j++ ) {
+            const int p = tileLayer.getIndex( i, j );
+            if ( open ) {
+                touched.emplace_back( layer, p );
+            } else {
+                shadow.cells[p] = tileLayer.getCell( p );
+            }
+        }
+    }
+
+}
+
+/**
+ * A cell touched more than once is recorded the first time and then
+ * matches its shadow. The cells are sorted first, so neighbouring cells
+ * end up in the same run. While resizedLayer is being resized its cells
+ * are read lineShift lines away from where they were touched; the ones the
+ * resize removed are skipped, since the resize records them from the
+ * shadow.
+ */
+void EditJournal::flushTouched( int resizedLayer, int lineShift ) {
+
+    std::sort( touched.begin(), touched.end() );
+
+    for ( const auto &[layer, p] : touched ) {
+
+        const TileLayer &tileLayer = ( *layers )[layer];
+        int current = p;
+
+        if ( layer == resizedLayer ) {
+            const int line = p / tileLayer.getMaxColumns() + lineShift;
+            const int column = p % tileLayer.getMaxColumns();
+            if ( line < 0 || line >= tileLayer.getLines() || column >= tileLayer.getColumns() ) {
+                continue;
+            }
+            current = tileLayer.getIndex( line, column );
+        }
+
+        const uint32_t cell = tileLayer.getCell( current );
+        uint32_t &shadowCell = shadows[layer].cells[p];
+        if ( shadowCell != cell ) {
+            append( layer, p, shadowCell, cell );
+            shadowCell = cell;
+        }
+
+    }
+
+    touched.clear();
+
+}
+
+void EditJournal::syncShadow( int layer ) {
+
+    const TileLayer &tileLayer = ( *layers )[layer];
+    Shadow &shadow = shadows[layer];
+
+    shadow.lines = tileLayer.getLines();
+    shadow.columns = tileLayer.getColumns();
+
+    for ( int i = 0; i < tileLayer.getMaxLines(); i++ ) {
+        for ( int j = 0; j < tileLayer.getMaxColumns(); j++ ) {
+            const int p = tileLayer.getIndex( i, j );
+            shadow.cells[p] = tileLayer.getCell( p );
+        }
+    }
+
+}
+
+/**
+ * The first change of a command drops the commands that could be redone
+ * and starts a new command, or reopens the last one when they merge. A
+ * change of the cell right after the last run of the command extends it.
+ * When either ring is full the oldest commands are dropped; a command that
+ * does not fit alone is marked as overflowed.
+ */
+void EditJournal::append( int layer, int index, uint32_t before, uint32_t after ) {
+
+    if ( !recording ) {
+
+        if ( applied < commands.size() ) {
+            runHead = commands[applied].firstRun;
+            wordHead = commands[applied].firstWord;
+            commands.resize( applied );
+        }
+
+        if ( mergeKey == 0 || commands.empty() || commands.back().mergeKey != mergeKey ) {
+            commands.push_back( Command( runHead, wordHead, 0, 0, mergeKey ) );
+        }
+
+        applied = commands.size();
+        recording = true;
+
+    }
+
+    if ( overflowed ) {
+        return;
+    }
+
+    CellRun *last = commands.back().runCount > 0 ? &runs[( runHead - 1 ) % runs.size()] : nullptr;
+    const bool extends = last != nullptr && index != RESIZE && last->first != RESIZE &&
+                         last->layer == layer && last->first + last->count == index;
+    const uint64_t newRuns = extends ? 0 : 1;
+
+    while ( runHead + newRuns - commands.front().firstRun > runs.size() ||
+            wordHead + 2 - commands.front().firstWord > words.size() ) {
+        if ( commands.size() == 1 ) {
+            overflowed = true;
+            return;
+        }
+        commands.pop_front();
+        applied--;
+    }
+
+    Command &command = commands.back();
+
+    if ( extends ) {
+        last->count++;
+    } else {
+        runs[runHead % runs.size()] = CellRun( layer, index, 1 );
+        runHead++;
+        command.runCount++;
+    }
+
+    words[wordHead % words.size()] = before;
+    words[( wordHead + 1 ) % words.size()] = after;
+    wordHead += 2;
+    command.wordCount += 2;
+
+}
+
+/**
+ * Changes are applied outside of any command, so the journal listener only
+ * brings the shadow up to date. The words of the run start at word.
+ */
+void EditJournal::apply( const CellRun &run, uint64_t word, bool undo ) {
+
+    TileLayer &layer = ( *layers )[run.layer];
+    const uint64_t side = undo ? 0 : 1;
+
+    if ( run.first == RESIZE ) {
+        const uint32_t value = words[( word + side ) % words.size()];
+        layer.resize( static_cast<int>( value >> 16 ), static_cast<int>( value & 0xffff ) );
+        return;
+    }
+
+    for ( int k = 0; k < run.count; k++ ) {
+        layer.setCell( run.first + k, words[( word + 2 * k + side ) % words.size()] );
+    }
+
+}
@@ -0,0 +1,175 @@
+/**
+ * @file FrameProfiler.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief FrameProfiler class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "FrameProfiler.h"
+#include "raylib.h"
+
+FrameProfiler::Clock::time_point FrameProfiler::origin = FrameProfiler::Clock::now();
+std::array<FrameProfiler::Clock::time_point, FrameProfiler::PHASES> FrameProfiler::starts;
+std::array<double, FrameProfiler::PHASES> FrameProfiler::frameTotals{};
+std::array<std::array<float, FrameProfiler::HISTORY>, FrameProfiler::PHASES> FrameProfiler::samples{};
+int FrameProfiler::frameCount = 0;
+std::vector<FrameProfiler::TraceEvent> FrameProfiler::trace;
+size_t FrameProfiler::traceNext = 0;
+bool FrameProfiler::overlayVisible = false;
+
+FrameProfiler::Scope::Scope( Phase phase )
+    :
+    phase( phase ) {
+    begin( phase );
+}
+
+FrameProfiler::Scope::~Scope() {
+    end( phase );
+}
+
+long long FrameProfiler::toMicroseconds( Clock::time_point time ) {
+    return std::chrono::duration_cast<std::chrono::microseconds>( time - origin ).count();
+}
+
+const char *FrameProfiler::getPhaseName( Phase phase ) {
+    static constexpr std::array<const char*, PHASES> names{
+        "frame", "input", "palette setup", "music", "tiles", "previews", "gui", "present"
+    };
+    return names[static_cast<int>( phase )];
+}
+
+void FrameProfiler::beginFrame() {
+    frameTotals.fill( 0 );
+    begin( Phase::frame );
+}
+
+void FrameProfiler::endFrame() {
+
+    end( Phase::frame );
+
+    const int slot = frameCount % HISTORY;
+    for ( int i = 0; i < PHASES; i++ ) {
+        samples[i][slot] = static_cast<float>( frameTotals[i] );
+    }
+    frameCount++;
+
+}
+
+void FrameProfiler::begin( Phase phase ) {
+    starts[static_cast<int>( phase )] = Clock::now();
+}
+
+/**
+ * A phase can run more than once in a frame; its times are added up.
+ */
+void FrameProfiler::end( Phase phase ) {
+
+    const Clock::time_point now = Clock::now();
+    const Clock::time_point start = starts[static_cast<int>( phase )];
+
+    frameTotals[static_cast<int>( phase )] += std::chrono::duration<double, std::milli>( now - start ).count();
+
+    const TraceEvent event( phase, toMicroseconds( start ), toMicroseconds( now ) - toMicroseconds( start ) );
+
+    if ( trace.size() < TRACE_CAPACITY ) {
+        trace.push_back( event );
+    } else {
+        trace[traceNext] = event;
+    }
+    traceNext = ( traceNext + 1 ) % TRACE_CAPACITY;
+
+}
+
+FrameProfiler::Stats FrameProfiler::getStats( Phase phase ) {
+
+    const int n = std::min( frameCount, HISTORY );
+
+    if ( n == 0 ) {
+        return Stats( 0, 0, 0 );
+    }
+
+    std::array<float, HISTORY> sorted = samples[static_cast<int>( phase )];
+    std::sort( sorted.begin(), sorted.begin() + n );
+
+    float sum = 0;
+    for ( int i = 0; i < n; i++ ) {
+        sum += sorted[i];
+    }
+
+    const int p99 = std::max( static_cast<int>( std::ceil( n * 0.99 ) ) - 1, 0 );
+
+    return Stats( sorted[0], sum / n, sorted[p99] );
+
+}
+
+void FrameProfiler::toggleOverlay() {
+    overlayVisible = !overlayVisible;
+}
+
+bool FrameProfiler::isOverlayVisible() {
+    return overlayVisible;
+}
+
+void FrameProfiler::drawOverlay( int x, int y ) {
+
+    if ( !overlayVisible ) {
+        return;
+    }
+
+    const int lineHeight = 14;
+    const int width = 250;
+    const int height = lineHeight * ( PHASES + 2 ) + 10;
+
+    DrawRectangle( x, y, width, height, Fade( BLACK, 0.75f ) );
+    DrawText( TextFormat( "%-14s %7s %7s %7s", "ms", "min", "avg", "p99" ), x + 8, y + 5, 10, YELLOW );
+
+    for ( int i = 0; i < PHASES; i++ ) {
+        const Stats stats = getStats( static_cast<Phase>( i ) );
+        DrawText( TextFormat( "%-14s %7.2f %7.2f %7.2f", getPhaseName( static_cast<Phase>( i ) ), stats.min, stats.avg, stats.p99 ),
+                  x + 8, y + 5 + lineHeight * ( i + 1 ), 10, i == 0 ? WHITE : LIGHTGRAY );
+    }
+
+    DrawText( TextFormat( "last %d frames, F3: hide, F4: export trace", std::min( frameCount, HISTORY ) ),
+              x + 8, y + 5 + lineHeight * ( PHASES + 1 ), 10, GRAY );
+
+}
+
+/**
+ * Writes the kept events, oldest first, as complete ("X") events of the
+ * Chrome trace event format. Phases inside the frame nest under it.
+ */
+bool FrameProfiler::exportChromeTrace( const std::string &path ) {
+
+    std::ofstream file( path, std::ios::binary );
+
+    if ( !file ) {
+        TraceLog( LOG_WARNING, "PROFILER: Could not write [%s]", path.c_str() );
+        return false;
+    }
+
+    const size_t first = trace.size() < TRACE_CAPACITY ? 0 : traceNext;
+
+    file << "{\"traceEvents\":[";
+
+    for ( size_t i = 0; i < trace.size(); i++ ) {
+        const TraceEvent &event = trace[( first + i ) % trace.size()];
+        file << ( i == 0 ? "\n" : ",\n" )
+             << "{\"name\":\"" << getPhaseName( event.phase ) << "\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":" << event.start
+             << ",\"dur\":" << event.duration << ",\"pid\":1,\"tid\":1}";
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    TraceLog( LOG_INFO, "PROFILER: [%s] %d events written", path.c_str(), static_cast<int>( trace.size() ) );
+
+    return static_cast<bool>( file );
+
+}
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <string>
 
+#include "FrameProfiler.h"
 #include "GameWindow.h"
 #include "raylib.h"
 
@@ -95,8 +96,10 @@ void GameWindow::init() {
         initialized = true;
 
         while ( !WindowShouldClose() ) {
+            FrameProfiler::beginFrame();
             gw.inputAndUpdate();
             gw.draw();
+            FrameProfiler::endFrame();
         }
 
         GameWorld::unloadResources();
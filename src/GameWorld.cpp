@@ -7,6 +7,7 @@
  */
 #include <iostream>
 #include <string>
+#include "FrameProfiler.h"
 #include "GameWorld.h"
 #include "ResourceManager.h"
 #include "raylib.h"
@@ -22,7 +23,17 @@ GameWorld::GameWorld()
 GameWorld::~GameWorld() = default;
 
 void GameWorld::inputAndUpdate() {
+
+    if ( IsKeyPressed( KEY_F3 ) ) {
+        FrameProfiler::toggleOverlay();
+    } else if ( IsKeyPressed( KEY_F4 ) ) {
+        FrameProfiler::exportChromeTrace( "profile.json" );
+    }
+
+    ResourceManager::applyReloadedImages();
+    ResourceManager::applyPrefetchedResources();
     mapEditor.inputAndUpdate();
+
 }
 
 void GameWorld::draw() {
@@ -31,8 +42,12 @@ void GameWorld::draw() {
     ClearBackground( WHITE );
 
     mapEditor.draw();
+    FrameProfiler::drawOverlay( GetScreenWidth() - 260, 10 );
 
+    // swapping buffers, and waiting for the target FPS
+    FrameProfiler::begin( FrameProfiler::Phase::present );
     EndDrawing();
+    FrameProfiler::end( FrameProfiler::Phase::present );
 
 }
 
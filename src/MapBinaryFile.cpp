@@ -0,0 +1,609 @@
+/**
+ * @file MapBinaryFile.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief MapBinaryFile class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "MapBinaryFile.h"
+#include "MapFile.h"
+#include "MappedFile.h"
+#include "TileLayer.h"
+
+static constexpr size_t HEADER_SIZE = 24;
+static constexpr size_t LAYER_ENTRY_SIZE = 12;
+
+static void addError( std::vector<MapError> &errors, int line, int column, const std::string &message ) {
+    errors.push_back( MapError( line, column, message ) );
+}
+
+static void putU8( std::string &out, uint8_t value ) {
+    out.push_back( static_cast<char>( value ) );
+}
+
+static void putU16( std::string &out, uint16_t value ) {
+    putU8( out, value & 0xff );
+    putU8( out, value >> 8 );
+}
+
+static void putU32( std::string &out, uint32_t value ) {
+    putU16( out, value & 0xffff );
+    putU16( out, value >> 16 );
+}
+
+static void setU32( std::string &out, size_t offset, uint32_t value ) {
+    for ( int i = 0; i < 4; i++ ) {
+        out[offset + i] = static_cast<char>( ( value >> ( i * 8 ) ) & 0xff );
+    }
+}
+
+static void putString( std::string &out, const std::string &value ) {
+    putU32( out, static_cast<uint32_t>( value.size() ) );
+    out.append( value );
+}
+
+/**
+ * Bounds checked little endian reader over the mapped bytes. Once a read
+ * runs past the end every following read fails too, so callers check
+ * only once at the end of a block.
+ */
+class ByteReader {
+
+    const unsigned char *data;
+    size_t size;
+    size_t position;
+    bool failed;
+
+public:
+
+    ByteReader( const unsigned char *data, size_t size, size_t position )
+        :
+        data( data ),
+        size( size ),
+        position( position ),
+        failed( position > size ) {
+    }
+
+    bool ok() const {
+        return !failed;
+    }
+
+    const unsigned char *take( size_t count ) {
+        if ( failed || count > size - position ) {
+            failed = true;
+            return nullptr;
+        }
+        const unsigned char *bytes = data + position;
+        position += count;
+        return bytes;
+    }
+
+    uint32_t u32() {
+        const unsigned char *b = take( 4 );
+        return b == nullptr ? 0 : b[0] | ( b[1] << 8 ) | ( b[2] << 16 ) | ( static_cast<uint32_t>( b[3] ) << 24 );
+    }
+
+    uint16_t u16() {
+        const unsigned char *b = take( 2 );
+        return b == nullptr ? 0 : static_cast<uint16_t>( b[0] | ( b[1] << 8 ) );
+    }
+
+    uint8_t u8() {
+        const unsigned char *b = take( 1 );
+        return b == nullptr ? 0 : b[0];
+    }
+
+    std::string string() {
+        const uint32_t length = u32();
+        const unsigned char *b = take( length );
+        return b == nullptr ? std::string() : std::string( reinterpret_cast<const char*>( b ), length );
+    }
+
+};
+
+struct BinaryHeader {
+    int layerCount;
+    int lines;
+    int columns;
+    uint32_t metadataOffset;
+    uint32_t metadataSize;
+};
+
+static bool readHeader( const MappedFile &file, BinaryHeader &header, const std::string &path, std::vector<MapError> &errors ) {
+
+    ByteReader reader( file.getData(), file.getSize(), 0 );
+    const unsigned char *magic = reader.take( 4 );
+
+    if ( magic == nullptr || std::memcmp( magic, MapBinaryFile::MAGIC, 4 ) != 0 ) {
+        addError( errors, 0, 0, path + " is not a binary map" );
+        return false;
+    }
+
+    const uint16_t version = reader.u16();
+    header.layerCount = reader.u16();
+    header.lines = static_cast<int32_t>( reader.u32() );
+    header.columns = static_cast<int32_t>( reader.u32() );
+    header.metadataOffset = reader.u32();
+    header.metadataSize = reader.u32();
+
+    if ( !reader.ok() ) {
+        addError( errors, 0, 0, "truncated header" );
+        return false;
+    }
+
+    if ( version != MapBinaryFile::VERSION ) {
+        addError( errors, 0, 0, "unsupported version " + std::to_string( version ) );
+        return false;
+    }
+
+    if ( header.layerCount > MapBinaryFile::MAX_LAYERS ||
+         header.lines < 0 || header.lines > MapBinaryFile::MAX_SIZE ||
+         header.columns < 0 || header.columns > MapBinaryFile::MAX_SIZE ||
+         static_cast<size_t>( header.lines ) * header.columns > MapBinaryFile::MAX_CELLS ) {
+        addError( errors, 0, 0, "invalid map size" );
+        return false;
+    }
+
+    // the smallest a layer can be is one 3 byte run per 255 cells
+    const size_t cells = static_cast<size_t>( header.lines ) * header.columns;
+    const size_t tableEnd = HEADER_SIZE + LAYER_ENTRY_SIZE * header.layerCount;
+    const size_t minLayersSize = ( cells + 254 ) / 255 * 3 * header.layerCount;
+
+    if ( tableEnd > file.getSize() || minLayersSize > file.getSize() - tableEnd ) {
+        addError( errors, 0, 0, "the map size does not fit in the file" );
+        return false;
+    }
+
+    return true;
+
+}
+
+/**
+ * Decodes the whole file into the layers. Layers missing from the file are
+ * left empty; layers that do not fit are skipped with an error. Palette
+ * entries are resolved up front, so layers are decoded by copying cells.
+ */
+static bool decode( const MappedFile &file, const BinaryHeader &header, MapMetadata &metadata, std::vector<TileLayer> &layers,
+                    const MapFile::GlyphResolver &glyphResolver, const MapBinaryFile::ColorResolver &colorResolver,
+                    std::vector<MapError> &errors ) {
+
+    const size_t initialErrors = errors.size();
+    const size_t size = file.getSize();
+
+    // metadata first, since glyphs of tiles A..Z depend on the tile set
+    ByteReader meta( file.getData(), std::min<size_t>( size, static_cast<size_t>( header.metadataOffset ) + header.metadataSize ), header.metadataOffset );
+
+    const unsigned char *color = meta.take( 4 );
+    if ( color != nullptr ) {
+        metadata.backgroundColor = Color( color[0], color[1], color[2], color[3] );
+    }
+    metadata.backgroundTextureId = static_cast<int32_t>( meta.u32() );
+    metadata.tileSetId = static_cast<int32_t>( meta.u32() );
+    metadata.musicId = static_cast<int32_t>( meta.u32() );
+    metadata.timeToFinish = static_cast<int32_t>( meta.u32() );
+
+    metadata.messages.clear();
+    metadata.comments.clear();
+    metadata.headerComments.clear();
+    metadata.headerLines.clear();
+    metadata.firstGridLine = 1;    // positions are grid lines and columns
+
+    const uint32_t messageCount = meta.u32();
+    for ( uint32_t i = 0; i < messageCount && meta.ok(); i++ ) {
+        metadata.messages.push_back( meta.string() );
+    }
+    const uint32_t commentCount = meta.u32();
+    for ( uint32_t i = 0; i < commentCount && meta.ok(); i++ ) {
+        metadata.comments.push_back( meta.string() );
+    }
+    const uint32_t headerCommentCount = meta.u32();
+    for ( uint32_t i = 0; i < headerCommentCount && meta.ok(); i++ ) {
+        const char key = static_cast<char>( meta.u8() );
+        metadata.headerComments[key] = meta.string();
+    }
+
+    if ( !meta.ok() ) {
+        addError( errors, 0, 0, "truncated metadata" );
+    }
+
+    for ( auto &layer : layers ) {
+        layer.resize( 0, 0 );
+    }
+
+    // cells of the palette entries; entry 0 and the unresolved ones stay empty
+    ByteReader palette( file.getData(), size, HEADER_SIZE + LAYER_ENTRY_SIZE * header.layerCount );
+    const uint16_t paletteSize = palette.u16();
+    std::vector<uint32_t> paletteCells( static_cast<size_t>( paletteSize ) + 1, TileLayer::EMPTY_TILE );
+    MapGlyphDecoder decoder( glyphResolver, metadata.tileSetId );
+
+    for ( size_t e = 1; e <= paletteSize; e++ ) {
+
+        const uint8_t type = palette.u8();
+        const uint8_t glyph = palette.u8();
+        const unsigned char *rgba = palette.take( 4 );
+        const uint8_t flags = palette.u8() & ( TileLayer::COLLISION_MASK | TileLayer::VISIBLE_FLAG );
+
+        if ( !palette.ok() ) {
+            addError( errors, 0, 0, "truncated palette" );
+            break;
+        }
+
+        uint16_t tileId = TileLayer::EMPTY_TILE;
+        std::string error;
+
+        if ( type == MapBinaryFile::GLYPH_ENTRY ) {
+            error = decoder.resolve( glyph, tileId );
+        } else if ( type == MapBinaryFile::COLOR_ENTRY ) {
+            tileId = colorResolver( Color( rgba[0], rgba[1], rgba[2], rgba[3] ) );
+        } else {
+            error = "unknown type " + std::to_string( type );
+        }
+
+        if ( !error.empty() ) {
+            addError( errors, 0, 0, "palette entry " + std::to_string( e ) + ": " + error );
+        }
+
+        if ( tileId != TileLayer::EMPTY_TILE ) {
+            paletteCells[e] = static_cast<uint32_t>( tileId ) << 8 | flags;
+        }
+
+    }
+
+    ByteReader table( file.getData(), size, HEADER_SIZE );
+    const size_t cells = static_cast<size_t>( header.lines ) * header.columns;
+
+    for ( int k = 0; k < header.layerCount; k++ ) {
+
+        const uint32_t offset = table.u32();
+        const uint32_t layerSize = table.u32();
+        const uint8_t encoding = table.u8();
+        table.take( 3 );
+
+        if ( !table.ok() ) {
+            addError( errors, 0, 0, "truncated layer table" );
+            break;
+        }
+
+        if ( k >= static_cast<int>( layers.size() ) ) {
+            addError( errors, 0, 0, "layer " + std::to_string( k ) + " was skipped, only " + std::to_string( layers.size() ) + " are supported" );
+            continue;
+        }
+
+        TileLayer &layer = layers[k];
+
+        if ( header.lines > layer.getMaxLines() || header.columns > layer.getMaxColumns() ) {
+            addError( errors, 0, 0, "map does not fit in " + std::to_string( layer.getMaxLines() ) + "x" + std::to_string( layer.getMaxColumns() ) );
+            break;
+        }
+
+        layer.resize( header.lines, header.columns );
+
+        ByteReader reader( file.getData(), std::min<size_t>( size, static_cast<size_t>( offset ) + layerSize ), offset );
+
+        size_t cell = 0;
+        bool badIndex = false;
+
+        auto setCells = [&]( uint16_t index, size_t count ) {
+            count = std::min( count, cells - cell );
+            if ( index > paletteSize ) {
+                badIndex = true;
+                cell += count;
+                return;
+            }
+            const uint32_t value = paletteCells[index];
+            if ( ( value >> 8 ) == TileLayer::EMPTY_TILE ) {
+                cell += count;
+                return;
+            }
+            for ( ; count > 0; count--, cell++ ) {
+                layer.setCell( layer.getIndex( static_cast<int>( cell / header.columns ), static_cast<int>( cell % header.columns ) ), value );
+            }
+        };
+
+        if ( encoding == MapBinaryFile::RAW_ENCODING ) {
+            while ( cell < cells && reader.ok() ) {
+                const uint16_t index = reader.u16();
+                if ( reader.ok() ) {
+                    setCells( index, 1 );
+                }
+            }
+        } else if ( encoding == MapBinaryFile::RUN_LENGTH_ENCODING ) {
+            while ( cell < cells && reader.ok() ) {
+                const uint8_t count = reader.u8();
+                const uint16_t index = reader.u16();
+                if ( reader.ok() ) {
+                    setCells( index, count );
+                }
+            }
+        } else {
+            addError( errors, 0, 0, "layer " + std::to_string( k ) + " has unknown encoding " + std::to_string( encoding ) );
+            continue;
+        }
+
+        if ( badIndex ) {
+            addError( errors, 0, 0, "layer " + std::to_string( k ) + " has palette indices out of range" );
+        }
+
+        if ( !reader.ok() || cell < cells ) {
+            addError( errors, 0, 0, "layer " + std::to_string( k ) + " is truncated" );
+        }
+
+    }
+
+    for ( auto &layer : layers ) {
+        layer.resize( header.lines, header.columns );
+    }
+
+    return errors.size() == initialErrors;
+
+}
+
+bool MapBinaryFile::load( const std::string &path, MapMetadata &metadata, std::vector<TileLayer> &layers,
+                          const MapFile::GlyphResolver &glyphResolver, const ColorResolver &colorResolver,
+                          std::vector<MapError> &errors ) {
+
+    MappedFile file;
+
+    if ( !file.open( path ) ) {
+        addError( errors, 0, 0, "could not open " + path );
+        return false;
+    }
+
+    BinaryHeader header;
+
+    if ( !readHeader( file, header, path, errors ) ) {
+        return false;
+    }
+
+    return decode( file, header, metadata, layers, glyphResolver, colorResolver, errors );
+
+}
+
+/**
+ * Each distinct cell (tile and flags) gets one palette entry, and each
+ * layer is stored with the smaller of its two encodings. Shipped maps are
+ * mostly empty cells and long floors, so runs usually win by far. Nothing
+ * is written when a tile has neither a glyph nor a color.
+ */
+bool MapBinaryFile::save( const std::string &path, const MapMetadata &metadata, const std::vector<TileLayer> &layers,
+                          const std::vector<char> &paletteGlyphs, const std::vector<Color> &paletteColors,
+                          std::vector<MapError> &errors ) {
+
+    const size_t initialErrors = errors.size();
+    const int lines = layers.empty() ? 0 : layers[0].getLines();
+    const int columns = layers.empty() ? 0 : layers[0].getColumns();
+    const size_t cells = static_cast<size_t>( lines ) * columns;
+
+    std::unordered_map<uint32_t, uint16_t> paletteIndices;
+    std::string palette;
+    std::vector<std::string> layerData( layers.size() );
+    std::vector<uint8_t> layerEncodings( layers.size() );
+    std::vector<uint16_t> indices( cells );
+    std::string raw;
+    std::string runs;
+
+    // palette index of a cell, adding an entry on first use; 0 when it can't be stored
+    const auto getIndex = [&]( uint32_t cell, size_t k, int i, int j ) -> uint16_t {
+
+        const auto it = paletteIndices.find( cell );
+        if ( it != paletteIndices.end() ) {
+            return it->second;
+        }
+
+        const uint16_t tileId = static_cast<uint16_t>( cell >> 8 );
+        const char glyph = tileId < paletteGlyphs.size() ? paletteGlyphs[tileId] : 0;
+        uint16_t index = 0;
+
+        if ( glyph == 0 ) {
+            addError( errors, i + 1, j + 1, "tile of layer " + std::to_string( k ) + " has no glyph in the map format" );
+        } else if ( glyph == MapFile::COLORED_TILE && tileId >= paletteColors.size() ) {
+            addError( errors, i + 1, j + 1, "colored tile of layer " + std::to_string( k ) + " has no color" );
+        } else if ( paletteIndices.size() >= UINT16_MAX ) {
+            addError( errors, i + 1, j + 1, "too many distinct tiles" );
+        } else {
+            const bool colored = glyph == MapFile::COLORED_TILE;
+            const Color color = colored ? paletteColors[tileId] : Color( 0, 0, 0, 0 );
+            putU8( palette, colored ? COLOR_ENTRY : GLYPH_ENTRY );
+            putU8( palette, colored ? 0 : static_cast<uint8_t>( glyph ) );
+            putU8( palette, color.r );
+            putU8( palette, color.g );
+            putU8( palette, color.b );
+            putU8( palette, color.a );
+            putU8( palette, static_cast<uint8_t>( cell & 0xff ) );
+            index = static_cast<uint16_t>( paletteIndices.size() + 1 );
+        }
+
+        paletteIndices.emplace( cell, index );
+        return index;
+
+    };
+
+    for ( size_t k = 0; k < layers.size(); k++ ) {
+
+        const TileLayer &layer = layers[k];
+
+        for ( int i = 0; i < lines; i++ ) {
+            for ( int j = 0; j < columns; j++ ) {
+                const uint32_t cell = layer.getCell( layer.getIndex( i, j ) );
+                indices[static_cast<size_t>( i ) * columns + j] = ( cell >> 8 ) == TileLayer::EMPTY_TILE ? 0 : getIndex( cell, k, i, j );
+            }
+        }
+
+        raw.clear();
+        for ( const uint16_t index : indices ) {
+            putU16( raw, index );
+        }
+
+        runs.clear();
+        for ( size_t p = 0; p < cells; ) {
+            size_t run = 1;
+            while ( run < 255 && p + run < cells && indices[p + run] == indices[p] ) {
+                run++;
+            }
+            putU8( runs, static_cast<uint8_t>( run ) );
+            putU16( runs, indices[p] );
+            p += run;
+        }
+
+        const bool useRuns = runs.size() < raw.size();
+        layerData[k] = useRuns ? runs : raw;
+        layerEncodings[k] = useRuns ? RUN_LENGTH_ENCODING : RAW_ENCODING;
+
+    }
+
+    // never replace a file with a map that lost tiles
+    if ( errors.size() != initialErrors ) {
+        addError( errors, 0, 0, path + " was not written, some tiles have no glyph" );
+        return false;
+    }
+
+    std::string out;
+    out.reserve( HEADER_SIZE + LAYER_ENTRY_SIZE * layers.size() + 2 + palette.size() + cells * 2 * layers.size() );
+    out.append( MAGIC, 4 );
+    putU16( out, VERSION );
+    putU16( out, static_cast<uint16_t>( layers.size() ) );
+    putU32( out, static_cast<uint32_t>( lines ) );
+    putU32( out, static_cast<uint32_t>( columns ) );
+    putU32( out, 0 );
+    putU32( out, 0 );
+
+    const size_t tableOffset = out.size();
+    out.append( LAYER_ENTRY_SIZE * layers.size(), '\0' );
+
+    putU16( out, static_cast<uint16_t>( paletteIndices.size() ) );
+    out.append( palette );
+
+    for ( size_t k = 0; k < layers.size(); k++ ) {
+        const size_t entry = tableOffset + LAYER_ENTRY_SIZE * k;
+        setU32( out, entry, static_cast<uint32_t>( out.size() ) );
+        setU32( out, entry + 4, static_cast<uint32_t>( layerData[k].size() ) );
+        out[entry + 8] = static_cast<char>( layerEncodings[k] );
+        out.append( layerData[k] );
+    }
+
+    const size_t metadataOffset = out.size();
+    const Color &color = metadata.backgroundColor;
+    putU8( out, color.r );
+    putU8( out, color.g );
+    putU8( out, color.b );
+    putU8( out, color.a );
+    putU32( out, static_cast<uint32_t>( metadata.backgroundTextureId ) );
+    putU32( out, static_cast<uint32_t>( metadata.tileSetId ) );
+    putU32( out, static_cast<uint32_t>( metadata.musicId ) );
+    putU32( out, static_cast<uint32_t>( metadata.timeToFinish ) );
+
+    putU32( out, static_cast<uint32_t>( metadata.messages.size() ) );
+    for ( const auto &message : metadata.messages ) {
+        putString( out, message );
+    }
+    putU32( out, static_cast<uint32_t>( metadata.comments.size() ) );
+    for ( const auto &comment : metadata.comments ) {
+        putString( out, comment );
+    }
+    putU32( out, static_cast<uint32_t>( metadata.headerComments.size() ) );
+    for ( const auto &[key, comment] : metadata.headerComments ) {
+        putU8( out, static_cast<uint8_t>( key ) );
+        putString( out, comment );
+    }
+
+    setU32( out, 16, static_cast<uint32_t>( metadataOffset ) );
+    setU32( out, 20, static_cast<uint32_t>( out.size() - metadataOffset ) );
+
+    std::ofstream file( path, std::ios::binary );
+
+    if ( !file || !file.write( out.data(), static_cast<std::streamsize>( out.size() ) ) ) {
+        addError( errors, 0, 0, "could not write " + path );
+    }
+
+    return errors.size() == initialErrors;
+
+}
+
+/**
+ * The converters work on glyphs only, each glyph being its own palette
+ * index, so no texture is needed and they can run without a window. A map
+ * that had errors is not converted, so no partial file is left behind.
+ */
+bool MapBinaryFile::convertTextToBinary( const std::string &textPath, const std::string &binaryPath, std::vector<MapError> &errors ) {
+
+    std::ifstream file( textPath, std::ios::binary );
+
+    if ( !file ) {
+        addError( errors, 0, 0, "could not open " + textPath );
+        return false;
+    }
+
+    std::stringstream ss;
+    ss << file.rdbuf();
+    const std::string text = ss.str();
+
+    // a layer big enough for the whole file, header lines included
+    int lineCount = 1;
+    int width = 0;
+    for ( size_t start = 0, end; start <= text.size(); start = end + 1, lineCount++ ) {
+        end = std::min( text.find( '\n', start ), text.size() );
+        width = std::max( width, static_cast<int>( end - start ) );
+    }
+
+    const size_t initialErrors = errors.size();
+    MapMetadata metadata;
+    std::vector<TileLayer> layers;
+    layers.emplace_back( lineCount, std::max( width, 1 ), 0, 0 );
+
+    // a map that was not fully read is not converted
+    if ( !MapFile::parse( text, metadata, layers[0], MapFile::resolveGlyphAsIndex, errors ) ) {
+        return false;
+    }
+
+    save( binaryPath, metadata, layers, MapFile::getGlyphIndexPalette(), {}, errors );
+
+    return errors.size() == initialErrors;
+
+}
+
+bool MapBinaryFile::convertBinaryToText( const std::string &binaryPath, const std::string &textPath, std::vector<MapError> &errors ) {
+
+    MappedFile file;
+
+    if ( !file.open( binaryPath ) ) {
+        addError( errors, 0, 0, "could not open " + binaryPath );
+        return false;
+    }
+
+    BinaryHeader header;
+
+    if ( !readHeader( file, header, binaryPath, errors ) ) {
+        return false;
+    }
+
+    const size_t initialErrors = errors.size();
+    MapMetadata metadata;
+    std::vector<TileLayer> layers;
+    for ( int k = 0; k < std::max( header.layerCount, 1 ); k++ ) {
+        layers.emplace_back( std::max( header.lines, 1 ), std::max( header.columns, 1 ), 0, 0 );
+    }
+
+    // a map that was not fully read is not converted
+    if ( !decode( file, header, metadata, layers, MapFile::resolveGlyphAsIndex, resolveColorAsIndex, errors ) ) {
+        return false;
+    }
+
+    MapFile::save( textPath, metadata, layers, MapFile::getGlyphIndexPalette(), errors );
+
+    return errors.size() == initialErrors;
+
+}
+
+uint16_t MapBinaryFile::resolveColorAsIndex( Color color ) {
+    return MapFile::COLORED_TILE;
+}
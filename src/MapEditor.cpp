@@ -5,15 +5,29 @@
  *
  * @copyright Copyright (c) 2024
  */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "FrameProfiler.h"
 #include "GameWorld.h"
+#include "MapBinaryFile.h"
 #include "MapEditor.h"
 #include "ResourceManager.h"
 #include "Tile.h"
+#include "TileBatchRenderer.h"
+#include "TileLayer.h"
 #include "raylib.h"
 #include "ComponentInsertionType.h"
 #include "TileCollisionType.h"
 #include "TilePaintingType.h"
 
+#include "rlgl.h"
+
 #define RAYGUI_IMPLEMENTATION
 #include "raygui.h"
 #undef RAYGUI_IMPLEMENTATION
@@ -28,12 +42,14 @@ MapEditor::MapEditor( Vector2 pos, GameWorld *gw )
     lines( minLines ),
     previousLines( minLines ),
     pressedLine( -1 ),
+    dragLine( -1 ),
 
     minColumns( 18 ),
     maxColumns( 400 ),
     columns( minColumns ),
     previousColumns( minColumns ),
     pressedColumn( -1 ),
+    dragColumn( -1 ),
 
     tileComposerDim( Vector2( minColumns * Tile::TILE_WIDTH, minLines * Tile::TILE_WIDTH ) ),
 
@@ -41,8 +57,22 @@ MapEditor::MapEditor( Vector2 pos, GameWorld *gw )
     startColumn( columns - minColumns ),
     viewOffsetLine( 0 ),
     viewOffsetColumn( 0 ),
-    
-    firstSelectedTile( nullptr ),
+
+    journal( 1 << 16 ),
+    paintStroke( 0 ),
+
+    autoTileDirtyRegion( maxLines, maxColumns ),
+    autoTile( false ),
+    retiling( false ),
+
+    tilesBackbuffer(),
+    tilesDirtyRegion( maxLines, maxColumns ),
+    backbufferStartLine( -1 ),
+    backbufferStartColumn( -1 ),
+    backbufferAssetRevision( 0 ),
+    overflowPaletteSize( 0 ),
+    tileOverflow( 0 ),
+
     currentLayer( 1 ),
     maxLayers( 7 ),
 
@@ -73,11 +103,14 @@ MapEditor::MapEditor( Vector2 pos, GameWorld *gw )
     colorPickerTileRect( Rectangle( colorPickerTileContainerRect.x + 10, colorPickerTileContainerRect.y + 10, 100, 100 ) ),
     sliderAlphaTileRect( Rectangle( colorPickerTileRect.x, colorPickerTileRect.y + colorPickerTileRect.height + 10, colorPickerTileRect.width, 20 ) ),
     checkVisibleRect( Rectangle( colorPickerTileContainerRect.x, colorPickerTileContainerRect.y + colorPickerTileContainerRect.height + 10, 20, 20 ) ),
+    checkAutoTileRect( Rectangle( checkVisibleRect.x + 75, checkVisibleRect.y, 20, 20 ) ),
     tileCollisionType( static_cast<int>(TileCollisionType::solid) ),
     tilePaintingType( static_cast<int>(TilePaintingType::textured) ), 
     tileVisible( true ),
 
     coloredModelTile( Vector2( 0, 0 ), BLACK, 1, true, Vector2( pos.x, pos.y ) ),
+    pickedColorTile( Vector2( 0, 0 ), BLACK, 1, true, Vector2( pos.x, pos.y ) ),
+    pickedColorTileId( TileLayer::EMPTY_TILE ),
 
     backgroundColor( WHITE ),
     backgroundTextureId( 1 ),
@@ -86,6 +119,8 @@ MapEditor::MapEditor( Vector2 pos, GameWorld *gw )
     showGrid( true ),
     playMusic( false ),
     previousSelectedMusicId( musicId ),
+    prefetchedBackgroundTextureId( -1 ),
+    prefetchedMusicId( -1 ),
 
     terrainRect( Rectangle(
         comboTileCollisionTypeRect.x + comboTileCollisionTypeRect.width + 10,
@@ -112,37 +147,70 @@ MapEditor::MapEditor( Vector2 pos, GameWorld *gw )
     selectedBlock( nullptr ),
     selectedItem( nullptr ),
     selectedBaddie( nullptr ),
-    mario( Vector2( 0, 0 ), nullptr, 1, false, Vector2( 0, -8 ) ),
-    lastMarioTile( nullptr )
+    mario( Vector2( 0, 0 ), nullptr, 1, false, Vector2( 0, -8 ) )
 
 {
 
     for ( int k = 0; k < maxLayers; k++ ) {
-        layers.emplace_back();
-        layersState.emplace_back( true );
-        for ( int i = 0; i < lines; i++ ) {
-            for ( int j = 0; j < columns; j++ ) {
-                layers[k].push_back( new Tile( Vector2( j * Tile::TILE_WIDTH, i * Tile::TILE_WIDTH ), WHITE, 0, true, Vector2( pos.x, pos.y ) ) );
+        layers.emplace_back( maxLines, maxColumns, lines, columns );
+        layersState.emplace_back( true, RenderTexture2D(), 0, -1, -1 );
+        backbufferLayersVisible.push_back( true );
+    }
+
+    for ( auto &layer : layers ) {
+        layer.subscribe( [this]( const DirtyRect &rect, uint8_t changes ) {
+            if ( changes & TileLayer::TILES_CHANGED ) {
+                tilesDirtyRegion.markRect( rect );
             }
-        }
+        });
+    }
+
+    journal.attach( layers );
+
+    for ( int k = 0; k < maxLayers; k++ ) {
+        layers[k].subscribe( [this, k]( const DirtyRect &rect, uint8_t changes ) {
+            if ( autoTile && !retiling && k == currentLayer - 1 && ( changes & TileLayer::TILES_CHANGED ) ) {
+                autoTileDirtyRegion.markRect( rect );
+            }
+        });
     }
 
+    // palette entry 0 is the empty tile
+    palette.emplace_back( Vector2( 0, 0 ), WHITE, 0, false, Vector2( pos.x, pos.y ) );
+
     bool first = true;
     for ( auto const& c : pipeColors ) {
         pipeColorOptions += ( first ? "": ";" ) + c;
         first = false;
     }
 
+    // registry handles are stable, so they can be reserved before loading
+    for ( int i = 1; i <= 10; i++ ) {
+        backgroundTextureHandles.push_back( ResourceManager::getTextures().reserve( "background" + std::to_string( i ) ) );
+    }
+
+    for ( int i = 1; i <= 9; i++ ) {
+        musicHandles.push_back( ResourceManager::getMusics().reserve( "music" + std::to_string( i ) ) );
+    }
+
+    for ( int i = 1; i <= std::max( maxLines, maxColumns ); i++ ) {
+        rulerLabels.push_back( std::to_string( i ) );
+    }
+
 }
 
 MapEditor::~MapEditor() {
-
-    for ( const auto &layer : layers ) {
-        for ( const auto* tile : layer ) {
-            delete tile;
+    // the GL context may be gone when the editor is destroyed
+    if ( IsWindowReady() ) {
+        if ( tilesBackbuffer.id != 0 ) {
+            UnloadRenderTexture( tilesBackbuffer );
+        }
+        for ( const auto &state : layersState ) {
+            if ( state.preview.id != 0 ) {
+                UnloadRenderTexture( state.preview );
+            }
         }
     }
-    
 }
 
 void MapEditor::computePressedLineAndColumn( Vector2 &mousePos, int &line, int &column ) const {
@@ -172,15 +240,14 @@ void MapEditor::selectTile( Vector2 &mousePos ) {
     computePressedLineAndColumn( mousePos, line, column );
 
     if ( isTilePositionValid( line, column ) ) {
-        layers[currentLayer - 1][line * columns + column]->setSelected( true );
-        if ( firstSelectedTile == nullptr ) {
-            firstSelectedTile = layers[currentLayer - 1][line * columns + column];
-        }
+        TileLayer &layer = layers[currentLayer - 1];
+        const int index = layer.getIndex( line, column );
+        layer.setSelected( index, true );
     }
 
 }
 
-Tile* MapEditor::getTileFromPosition( Vector2& mousePos ) {
+int MapEditor::getTileIndexFromPosition( Vector2& mousePos ) const {
 
     int line;
     int column;
@@ -188,10 +255,10 @@ Tile* MapEditor::getTileFromPosition( Vector2& mousePos ) {
     computePressedLineAndColumn( mousePos, line, column );
 
     if ( isTilePositionValid( line, column ) ) {
-        return layers[currentLayer - 1][line * columns + column];
+        return layers[currentLayer - 1].getIndex( line, column );
     }
 
-    return nullptr;
+    return -1;
 
 }
 
@@ -203,21 +270,15 @@ void MapEditor::deselectTile( Vector2 &mousePos ) {
     computePressedLineAndColumn( mousePos, line, column );
 
     if ( isTilePositionValid( line, column ) ) {
-        Tile *tile = layers[currentLayer - 1][line * columns + column];
-        tile->setSelected( false );
-        if ( firstSelectedTile == tile ) {
-            firstSelectedTile = nullptr;
-        }
+        TileLayer &layer = layers[currentLayer - 1];
+        const int index = layer.getIndex( line, column );
+        layer.setSelected( index, false );
     }
 
 }
 
 void MapEditor::deselectTiles() {
-    for ( auto *tile : layers[currentLayer - 1] ) {
-        tile->setSelected( false );
-    }
-    firstSelectedTile = nullptr;
-    selectedTiles.clear();
+    layers[currentLayer - 1].deselectAll();
 }
 
 bool MapEditor::isTileSelected( Vector2 &mousePos ) const {
@@ -228,7 +289,8 @@ bool MapEditor::isTileSelected( Vector2 &mousePos ) const {
     computePressedLineAndColumn( mousePos, line, column );
 
     if ( isTilePositionValid( line, column ) ) {
-        return layers[currentLayer - 1][line * columns + column]->isSelected();
+        const TileLayer &layer = layers[currentLayer - 1];
+        return layer.isSelected( layer.getIndex( line, column ) );
     }
 
     return false;
@@ -246,28 +308,376 @@ bool MapEditor::isMouseInsideEditor( const Vector2 &mousePos ) const {
            mousePos.y <= pos.y + minLines * Tile::TILE_WIDTH;
 }
 
-void MapEditor::drawLayerPreview( int x, int y, int tileWidth, bool active, const std::vector<Tile*>& tiles ) const {
+/**
+ * Returns the palette index of a tile with the model's data, adding it when
+ * there is none. A full palette is compacted first; when that frees nothing
+ * the tile is not added and EMPTY_TILE is returned.
+ */
+uint16_t MapEditor::getPaletteIndex( const Tile &model ) {
 
-    for ( int i = startLine; i < startLine + minLines; i++ ) {
-        for ( int j = startColumn; j < startColumn + minColumns; j++ ) {
-            int p = i * columns + j;
-            if ( p < tiles.size() ) {
-                Tile *tile = tiles[p];
-                if ( tile->isVisible() ) {
-                    if ( tile->getTexture() != nullptr ) {
-                        DrawTextureEx(
-                            *( tile->getTexture() ),
-                            Vector2( x + ( j - startColumn ) * tileWidth, y + ( i - startLine ) * tileWidth ),
-                            0,
-                            static_cast<float>( tileWidth ) / Tile::TILE_WIDTH,
-                            WHITE );
-                    } else {
-                        DrawRectangle( x + ( j - startColumn ) * tileWidth, y + ( i - startLine ) * tileWidth, tileWidth, tileWidth, Fade( *( tile->getColor() ), *( tile->getAlpha() ) ) );
-                    }
+    const size_t hash = model.getDataHash();
+    const auto [begin, end] = paletteIndices.equal_range( hash );
+
+    for ( auto it = begin; it != end; ++it ) {
+        if ( palette[it->second].hasSameData( model ) ) {
+            return it->second;
+        }
+    }
+
+    const uint16_t index = addPaletteEntry( model );
+
+    if ( index != TileLayer::EMPTY_TILE ) {
+        paletteIndices.emplace( hash, index );
+    }
+
+    return index;
+
+}
+
+/**
+ * Returns the palette index standing for a glyph the editor has no image
+ * for, adding it on first use. It is drawn as a magenta colored tile and
+ * is never shared with painted tiles, so saving writes the glyph back.
+ */
+uint16_t MapEditor::getPlaceholderIndex( char glyph ) {
+
+    for ( const auto &[index, placeholderGlyph] : placeholderGlyphs ) {
+        if ( placeholderGlyph == glyph ) {
+            return index;
+        }
+    }
+
+    const uint16_t index = addPaletteEntry( Tile( Vector2( 0, 0 ), MAGENTA, 1, false, Vector2( pos.x, pos.y ) ) );
+
+    if ( index != TileLayer::EMPTY_TILE ) {
+        placeholderGlyphs.emplace( index, glyph );
+        TraceLog( LOG_WARNING, "MAP: No image for glyph '%c', it is kept as a placeholder", glyph );
+    }
+
+    return index;
+
+}
+
+/**
+ * Stores a copy of the model in a free palette slot or at the end. A full
+ * palette is compacted first; when that frees nothing EMPTY_TILE is
+ * returned.
+ */
+uint16_t MapEditor::addPaletteEntry( const Tile &model ) {
+
+    if ( freePaletteIndices.empty() && palette.size() >= MAX_PALETTE_SIZE ) {
+        compactPalette();
+    }
+
+    uint16_t index;
+
+    if ( !freePaletteIndices.empty() ) {
+        index = freePaletteIndices.back();
+        freePaletteIndices.pop_back();
+        palette[index] = model;
+        overflowPaletteSize = std::min<size_t>( overflowPaletteSize, index );
+    } else if ( palette.size() < MAX_PALETTE_SIZE ) {
+        index = static_cast<uint16_t>( palette.size() );
+        palette.push_back( model );
+    } else {
+        TraceLog( LOG_ERROR, "MAP: The tile palette is full (%zu tiles in use)", palette.size() );
+        return TileLayer::EMPTY_TILE;
+    }
+
+    Tile &entry = palette[index];
+    entry.setPos( 0, 0 );
+    entry.setSelected( false );
+
+    return index;
+
+}
+
+/**
+ * Colored tiles are the only entries with no bound, one for each color
+ * ever painted, so the ones no cell and no journal change refers to are
+ * freed for reuse, placeholders included. Textured entries are few and
+ * the auto tiler holds the indices of the terrain ones, so they are
+ * always kept.
+ */
+void MapEditor::compactPalette() {
+
+    std::vector<bool> used( palette.size(), false );
+    used[TileLayer::EMPTY_TILE] = true;
+
+    for ( const auto &layer : layers ) {
+        for ( int i = 0; i < layer.getLines(); i++ ) {
+            for ( int j = 0; j < layer.getColumns(); j++ ) {
+                used[layer.getTileId( layer.getIndex( i, j ) )] = true;
+            }
+        }
+    }
+
+    journal.markTileIds( used );
+
+    for ( size_t i = 1; i < palette.size(); i++ ) {
+
+        if ( used[i] || palette[i].getTexture() != nullptr ) {
+            continue;
+        }
+
+        if ( placeholderGlyphs.erase( static_cast<uint16_t>( i ) ) > 0 ) {
+            freePaletteIndices.push_back( static_cast<uint16_t>( i ) );
+            continue;
+        }
+
+        const auto [begin, end] = paletteIndices.equal_range( palette[i].getDataHash() );
+        for ( auto it = begin; it != end; ++it ) {
+            if ( it->second == i ) {
+                paletteIndices.erase( it );
+                freePaletteIndices.push_back( static_cast<uint16_t>( i ) );
+                break;
+            }
+        }
+
+    }
+
+    TraceLog( LOG_INFO, "MAP: Tile palette compacted, %zu entries freed", freePaletteIndices.size() );
+
+}
+
+/**
+ * Points the color picker at the first selected cell of the current layer
+ * when it holds a colored tile, copying its palette entry once, so the
+ * picker can edit it and the selection is recolored from the copy. The
+ * copy is kept while the first cell still holds the entry it came from.
+ */
+void MapEditor::updatePickedColorTile() {
+
+    const TileLayer &layer = layers[currentLayer - 1];
+    const int first = layer.getSelection().getFirst();
+    const uint16_t tileId = first == -1 ? TileLayer::EMPTY_TILE : layer.getTileId( first );
+
+    if ( tileId == TileLayer::EMPTY_TILE || palette[tileId].getTexture() != nullptr || placeholderGlyphs.contains( tileId ) ) {
+        pickedColorTileId = TileLayer::EMPTY_TILE;
+        return;
+    }
+
+    if ( tileId != pickedColorTileId ) {
+        pickedColorTile = palette[tileId];
+        pickedColorTileId = tileId;
+    }
+
+}
+
+Tile MapEditor::createAtlasTile( Vector2 tilePos, const std::string &textureKey, Vector2 mapEditorOffset, Vector2 drawOffset ) const {
+    Rectangle source;
+    Texture2D *texture = ResourceManager::getAtlas().getTexture( textureKey, source );
+    return Tile( tilePos, texture, source, 1, false, mapEditorOffset, drawOffset );
+}
+
+void MapEditor::drawAtlasTexture( int textureHandle, int x, int y ) const {
+    Rectangle source;
+    const Texture2D *texture = ResourceManager::getAtlas().getTexture( textureHandle, source );
+    if ( texture != nullptr ) {
+        DrawTextureRec( *texture, source, Vector2( x, y ), WHITE );
+    }
+}
+
+void MapEditor::removeTiles( uint16_t tileId ) {
+    for ( auto &layer : layers ) {
+        for ( int i = 0; i < layer.getLines(); i++ ) {
+            for ( int j = 0; j < layer.getColumns(); j++ ) {
+                const int p = layer.getIndex( i, j );
+                if ( layer.getTileId( p ) == tileId ) {
+                    layer.resetTile( p );
                 }
             }
         }
     }
+}
+
+void MapEditor::undo() {
+    deselectTiles();
+    if ( journal.undo() ) {
+        autoTileDirtyRegion.clear();
+        lines = layers[0].getLines();
+        columns = layers[0].getColumns();
+        previousLines = lines;
+        previousColumns = columns;
+    }
+}
+
+void MapEditor::redo() {
+    deselectTiles();
+    if ( journal.redo() ) {
+        autoTileDirtyRegion.clear();
+        lines = layers[0].getLines();
+        columns = layers[0].getColumns();
+        previousLines = lines;
+        previousColumns = columns;
+    }
+}
+
+/**
+ * Cells between the pressed cell and the last cell dragged over.
+ */
+DirtyRect MapEditor::getRubberBand() const {
+    const int line = std::min( pressedLine, dragLine );
+    const int column = std::min( pressedColumn, dragColumn );
+    return DirtyRect( line, column, std::abs( pressedLine - dragLine ) + 1, std::abs( pressedColumn - dragColumn ) + 1 );
+}
+
+/**
+ * How many cells around its own cell a palette tile may cover, considering
+ * sprites larger than a cell and draw offsets.
+ */
+int MapEditor::getTileOverflow() {
+
+    for ( ; overflowPaletteSize < palette.size(); overflowPaletteSize++ ) {
+
+        Tile &tile = palette[overflowPaletteSize];
+
+        if ( tile.getTexture() != nullptr ) {
+            const Rectangle &source = tile.getSource();
+            const Vector2 &offset = tile.getDrawOffset();
+            const float extent = std::max( {
+                -offset.x, -offset.y,
+                offset.x + std::fabs( source.width ) - Tile::TILE_WIDTH,
+                offset.y + source.height - Tile::TILE_WIDTH } );
+            tileOverflow = std::max( tileOverflow, static_cast<int>( std::ceil( extent / Tile::TILE_WIDTH ) ) );
+        }
+
+    }
+
+    return tileOverflow;
+
+}
+
+/**
+ * Scrolling or toggling the visibility of a layer redraws the whole
+ * backbuffer. Otherwise only the bounds of the changed cells are cleared and
+ * the tiles that may reach them are drawn again, clipped to that area. The
+ * backbuffer has a margin of one cell around the view, so sprites drawn
+ * beyond the border cells are kept. Colors are accumulated premultiplied by
+ * alpha, so translucent tiles compose correctly over the background.
+ */
+void MapEditor::updateTilesBackbuffer() {
+
+    const int margin = Tile::TILE_WIDTH;
+
+    if ( tilesBackbuffer.id == 0 ) {
+        tilesBackbuffer = LoadRenderTexture( minColumns * Tile::TILE_WIDTH + margin * 2, minLines * Tile::TILE_WIDTH + margin * 2 );
+        tilesDirtyRegion.markAll();
+    }
+
+    bool fullRedraw = startLine != backbufferStartLine || startColumn != backbufferStartColumn;
+
+    // textures reloaded from disk: redraw everything cached, previews included
+    if ( backbufferAssetRevision != ResourceManager::getAssetRevision() ) {
+        backbufferAssetRevision = ResourceManager::getAssetRevision();
+        fullRedraw = true;
+        for ( auto &state : layersState ) {
+            state.previewStartLine = -1;
+        }
+    }
+
+    for ( int k = 0; k < maxLayers; k++ ) {
+        if ( backbufferLayersVisible[k] != layersState[k].visible ) {
+            backbufferLayersVisible[k] = layersState[k].visible;
+            fullRedraw = true;
+        }
+    }
+
+    if ( fullRedraw ) {
+        backbufferStartLine = startLine;
+        backbufferStartColumn = startColumn;
+        tilesDirtyRegion.markAll();
+    }
+
+    if ( tilesDirtyRegion.isEmpty() ) {
+        return;
+    }
+
+    const int overflow = getTileOverflow();
+    const DirtyRect &dirty = tilesDirtyRegion.getBounds();
+    const int endLine = startLine + minLines;
+    const int endColumn = startColumn + minColumns;
+
+    // area affected by the changes, in cells of the view
+    const int line0 = std::max( dirty.line - overflow, startLine );
+    const int line1 = std::min( dirty.line + dirty.lines + overflow, endLine );
+    const int column0 = std::max( dirty.column - overflow, startColumn );
+    const int column1 = std::min( dirty.column + dirty.columns + overflow, endColumn );
+
+    if ( line0 < line1 && column0 < column1 ) {
+
+        // clip area, reaching the margin when the affected area touches the border
+        const int clipX = column0 == startColumn ? 0 : margin + ( column0 - startColumn ) * Tile::TILE_WIDTH;
+        const int clipY = line0 == startLine ? 0 : margin + ( line0 - startLine ) * Tile::TILE_WIDTH;
+        const int clipX1 = column1 == endColumn ? tilesBackbuffer.texture.width : margin + ( column1 - startColumn ) * Tile::TILE_WIDTH;
+        const int clipY1 = line1 == endLine ? tilesBackbuffer.texture.height : margin + ( line1 - startLine ) * Tile::TILE_WIDTH;
+
+        // tiles that may reach the affected area
+        const int drawLine0 = std::max( line0 - overflow, startLine );
+        const int drawLine1 = std::min( line1 + overflow, endLine );
+        const int drawColumn0 = std::max( column0 - overflow, startColumn );
+        const int drawColumn1 = std::min( column1 + overflow, endColumn );
+
+        BeginTextureMode( tilesBackbuffer );
+        BeginScissorMode( clipX, clipY, clipX1 - clipX, clipY1 - clipY );
+        ClearBackground( BLANK );
+
+        rlSetBlendFactorsSeparate( RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD );
+        BeginBlendMode( BLEND_CUSTOM_SEPARATE );
+
+        for ( int k = 0; k < maxLayers; k++ ) {
+            if ( layersState[k].visible ) {
+                tileRenderer.drawLayer(
+                    layers[k], palette,
+                    drawLine0, drawColumn0, drawLine1 - drawLine0, drawColumn1 - drawColumn0,
+                    margin + ( drawColumn0 - startColumn ) * Tile::TILE_WIDTH,
+                    margin + ( drawLine0 - startLine ) * Tile::TILE_WIDTH,
+                    Tile::TILE_WIDTH, true );
+            }
+        }
+
+        EndBlendMode();
+        EndScissorMode();
+        EndTextureMode();
+
+    }
+
+    tilesDirtyRegion.clear();
+
+}
+
+/**
+ * Each preview is cached in a render texture and only redrawn when the
+ * tiles of the layer or the visible window of the map change.
+ */
+void MapEditor::drawLayerPreview( int x, int y, int tileWidth, bool active, const TileLayer &layer, LayerState &state ) {
+
+    const int width = minColumns * tileWidth;
+    const int height = minLines * tileWidth;
+
+    if ( state.preview.id == 0 ) {
+        state.preview = LoadRenderTexture( width, height );
+        state.previewStartLine = -1;
+    }
+
+    if ( state.previewRevision != layer.getRevision() ||
+         state.previewStartLine != startLine ||
+         state.previewStartColumn != startColumn ) {
+
+        // cleared with the screen background, so translucent tiles blend as if drawn directly
+        BeginTextureMode( state.preview );
+        ClearBackground( WHITE );
+        tileRenderer.drawLayer( layer, palette, startLine, startColumn, minLines, minColumns, 0, 0, tileWidth, false );
+        EndTextureMode();
+
+        state.previewRevision = layer.getRevision();
+        state.previewStartLine = startLine;
+        state.previewStartColumn = startColumn;
+
+    }
+
+    // render textures are stored upside down
+    DrawTextureRec( state.preview.texture, Rectangle( 0, 0, width, -height ), Vector2( x, y ), WHITE );
 
     DrawRectangleLines( x, y, minColumns * tileWidth, minLines * tileWidth, active ? BLACK : LIGHTGRAY );
 
@@ -280,9 +690,11 @@ void MapEditor::highlightSelectedTile( Tile& tile ) const {
 
 void MapEditor::inputAndUpdate() {
 
-    std::map<std::string, Texture2D>& textures = ResourceManager::getTextures();
+    TextureAtlas &atlas = ResourceManager::getAtlas();
 
-    if ( !resourceDependantComponentsCreated && !textures.empty() ) {
+    if ( !resourceDependantComponentsCreated && atlas.isBuilt() ) {
+
+        FrameProfiler::Scope scope( FrameProfiler::Phase::paletteSetup );
 
         for ( int k = 1; k < 5; k++ ) {
 
@@ -290,26 +702,22 @@ void MapEditor::inputAndUpdate() {
 
             for ( int i = 0; i < 18; i += 2 ) {
                 tilesToSelect.push_back(
-                    Tile( 
+                    createAtlasTile(
                         Vector2( 
                             terrainRect.x + 10,
                             terrainRect.y + 10 + ( Tile::TILE_WIDTH + 4 ) * p
                         ),
-                        &textures[TextFormat( "%c%d", 'A' + i, k )], 
-                        1,
-                        false,
+                        TextFormat( "%c%d", 'A' + i, k ),
                         Vector2( pos.x, pos.y )
                     )
                 );
                 tilesToSelect.push_back(
-                    Tile(
+                    createAtlasTile(
                         Vector2(
                             terrainRect.x + 15 + Tile::TILE_WIDTH,
                             terrainRect.y + 10 + ( Tile::TILE_WIDTH + 4 ) * p
                         ),
-                        &textures[TextFormat( "%c%d", 'A' + ( i + 1 ), k )],
-                        1,
-                        false,
+                        TextFormat( "%c%d", 'A' + ( i + 1 ), k ),
                         Vector2( pos.x, pos.y )
                     )
                 );
@@ -324,14 +732,12 @@ void MapEditor::inputAndUpdate() {
 
             for ( int i = 0; i < 4; i++ ) {
                 pipesToSelect.push_back(
-                    Tile(
+                    createAtlasTile(
                         Vector2(
                             pipesRect.x + 10,
                             pipesRect.y + 10 + ( Tile::TILE_WIDTH + 4 ) * p
                         ),
-                        &textures[TextFormat( "pipe_%s%d", color.c_str(), i )],
-                        1,
-                        false,
+                        TextFormat( "pipe_%s%d", color.c_str(), i ),
                         Vector2( pos.x, pos.y )
                     )
                 );
@@ -339,14 +745,12 @@ void MapEditor::inputAndUpdate() {
             }
             for ( int i = 4; i < 6; i++ ) {
                 pipesToSelect.push_back(
-                    Tile(
+                    createAtlasTile(
                         Vector2(
                             pipesRect.x + 10,
                             pipesRect.y + 10 + ( Tile::TILE_WIDTH + 4 ) * p
                         ),
-                        &textures[TextFormat( "sm_pipe_%s%d", color.c_str(), ( i - 4 ) )],
-                        1,
-                        false,
+                        TextFormat( "sm_pipe_%s%d", color.c_str(), ( i - 4 ) ),
                         Vector2( pos.x, pos.y )
                     )
                 );
@@ -358,16 +762,22 @@ void MapEditor::inputAndUpdate() {
         selectedTile = tilesToSelect.data();
         selectedTile->setSelected( true );
 
+        for ( int k = 1; k <= AutoTiler::SETS; k++ ) {
+            std::array<uint16_t, AutoTiler::PIECES> pieces;
+            for ( int p = 0; p < AutoTiler::PIECES; p++ ) {
+                pieces[p] = getPaletteIndex( tilesToSelect[( k - 1 ) * AutoTiler::PIECES + p] );
+            }
+            autoTiler.setPieces( k, pieces );
+        }
+
         for ( int i = 0; i < 5; i++ ) {
             blocksToSelect.push_back(
-                Tile(
+                createAtlasTile(
                     Vector2(
                         staticRect.x + 10,
                         staticRect.y + 10 + ( Tile::TILE_WIDTH + 4 ) * i
                     ),
-                    &textures[TextFormat( "block%d", i )],
-                    1,
-                    false,
+                    TextFormat( "block%d", i ),
                     Vector2( pos.x, pos.y )
                 )
             );
@@ -375,14 +785,12 @@ void MapEditor::inputAndUpdate() {
 
         for ( int i = 5; i < 9; i++ ) {
             blocksToSelect.push_back(
-                Tile(
+                createAtlasTile(
                     Vector2(
                         interactiveRect.x + 10,
                         interactiveRect.y + 10 + ( Tile::TILE_WIDTH + 4 ) * ( i - 5 )
                     ),
-                    &textures[TextFormat( "block%d", i )],
-                    1,
-                    false,
+                    TextFormat( "block%d", i ),
                     Vector2( pos.x, pos.y )
                 )
             );
@@ -390,14 +798,12 @@ void MapEditor::inputAndUpdate() {
 
         for ( int i = 9; i < 15; i++ ) {
             blocksToSelect.push_back(
-                Tile(
+                createAtlasTile(
                     Vector2(
                         interactiveRect.x + 10 + Tile::TILE_WIDTH + 4,
                         interactiveRect.y + 10 + ( Tile::TILE_WIDTH + 4 ) * ( i - 9 )
                     ),
-                    &textures[TextFormat( "block%d", i )],
-                    1,
-                    false,
+                    TextFormat( "block%d", i ),
                     Vector2( pos.x, pos.y )
                 )
             );
@@ -406,48 +812,46 @@ void MapEditor::inputAndUpdate() {
         selectedBlock = blocksToSelect.data();
         selectedBlock->setSelected( true );
 
-        std::vector itemsTextures{ &textures["coin"], &textures["yoshiCoin"] };
+        std::vector<std::string> itemsTextures{ "coin", "yoshiCoin" };
         std::vector itemsOffsets{ Vector2( 0, 0 ), Vector2( 0, 0 ) };
         int offset = 0;
 
         for ( size_t i = 0; i < itemsTextures.size(); i++ ) {
             itemsToSelect.push_back(
-                Tile(
+                createAtlasTile(
                     Vector2(
                         componentPropertiesRect.x + 10,
                         componentPropertiesRect.y + 10 + offset
                     ),
                     itemsTextures[i],
-                    1,
-                    false,
                     Vector2( pos.y, pos.y ),
                     itemsOffsets[i]
                 )
             );
-            offset += itemsTextures[i]->height + 4;
+            offset += atlas.getRegion( itemsTextures[i] ).source.height + 4;
         }
 
         selectedItem = itemsToSelect.data();
         selectedItem->setSelected( true );
 
-        std::vector baddiesTextures{
-            &textures["goombaL"],
-            &textures["flyingGoombaL"],
-            &textures["redKoopaTroopaL"],
-            &textures["greenKoopaTroopaL"],
-            &textures["blueKoopaTroopaL"],
-            &textures["yellowKoopaTroopaL"],
-            &textures["rexL"],
-            &textures["montyMoleL"],
-            &textures["bobOmbL"],
-            &textures["bulletBillL"],
-            &textures["buzzyBeetleL"],
-            &textures["mummyBeetleL"],
-            &textures["swooperL"],
-            &textures["banzaiBillL"],
-            &textures["muncher"],
-            &textures["piranhaPlant"],
-            &textures["jumpingPiranhaPlant"]
+        std::vector<std::string> baddiesTextures{
+            "goombaL",
+            "flyingGoombaL",
+            "redKoopaTroopaL",
+            "greenKoopaTroopaL",
+            "blueKoopaTroopaL",
+            "yellowKoopaTroopaL",
+            "rexL",
+            "montyMoleL",
+            "bobOmbL",
+            "bulletBillL",
+            "buzzyBeetleL",
+            "mummyBeetleL",
+            "swooperL",
+            "banzaiBillL",
+            "muncher",
+            "piranhaPlant",
+            "jumpingPiranhaPlant"
         };
 
         offset = 0;
@@ -472,25 +876,25 @@ void MapEditor::inputAndUpdate() {
             size_t end = static_cast<size_t>( interval.y );
 
             for ( size_t i = ini; i < end; i++ ) {
-                if ( maxWidth < baddiesTextures[i]->width ) {
-                    maxWidth = baddiesTextures[i]->width;
+                const int width = std::fabs( atlas.getRegion( baddiesTextures[i] ).source.width );
+                if ( maxWidth < width ) {
+                    maxWidth = width;
                 }
             }
 
             for ( size_t i = ini; i < end; i++ ) {
+                const Rectangle &source = atlas.getRegion( baddiesTextures[i] ).source;
                 baddiesToSelect.push_back(
-                    Tile(
+                    createAtlasTile(
                         Vector2(
-                            componentPropertiesRect.x + marginLeft + maxWidth / 2 - baddiesTextures[i]->width / 2,
+                            componentPropertiesRect.x + marginLeft + maxWidth / 2 - static_cast<int>( std::fabs( source.width ) ) / 2,
                             componentPropertiesRect.y + 10 + offset
                         ),
                         baddiesTextures[i],
-                        1,
-                        false,
                         Vector2( pos.y, pos.y )
                     )
                 );
-                offset += baddiesTextures[i]->height + 10;
+                offset += source.height + 10;
             }
 
         }
@@ -498,12 +902,20 @@ void MapEditor::inputAndUpdate() {
         selectedBaddie = baddiesToSelect.data();
         selectedBaddie->setSelected( true );
 
-        mario.setTexture( &textures["marioR"] );
+        Rectangle marioSource;
+        Texture2D *marioTexture = atlas.getTexture( "marioR", marioSource );
+        mario.setTexture( marioTexture, marioSource );
+
+        for ( const auto &key : { "B1", "block9", "coin", "goombaR", "marioR", "selectBlock" } ) {
+            insertOptionTextureHandles.push_back( atlas.getHandle( key ) );
+        }
 
         resourceDependantComponentsCreated = true;
 
     }
 
+    FrameProfiler::begin( FrameProfiler::Phase::input );
+
     guiContainerRect.width = GetScreenWidth() - ( tileComposerDim.x + 60 );
     guiContainerRect.height = GetScreenHeight() - 20;
 
@@ -518,6 +930,15 @@ void MapEditor::inputAndUpdate() {
     staticRect.height = componentPropertiesRect.height - 25;
     interactiveRect.height = staticRect.height;
 
+    // maps are opened by dropping them on the window
+    if ( IsFileDropped() ) {
+        FilePathList files = LoadDroppedFiles();
+        if ( files.count > 0 && IsFileExtension( files.paths[0], ".txt;.rmap" ) ) {
+            loadMap( files.paths[0] );
+        }
+        UnloadDroppedFiles( files );
+    }
+
     Vector2 mousePos = GetMousePosition();
 
     if ( isMouseInsideEditor( mousePos ) ) {
@@ -530,6 +951,13 @@ void MapEditor::inputAndUpdate() {
         SetMouseCursor( MOUSE_CURSOR_ARROW );
     }
 
+    if ( IsMouseButtonPressed( MOUSE_BUTTON_LEFT ) ) {
+        paintStroke++;
+    }
+
+    journal.beginCommand( IsMouseButtonDown( MOUSE_BUTTON_LEFT ) ? paintStroke : 0 );
+    updatePickedColorTile();
+
     if ( IsMouseButtonPressed( MOUSE_BUTTON_LEFT ) ) {    
 
         for ( int i = maxLayers - 1; i >= 0; i-- ) {
@@ -537,7 +965,8 @@ void MapEditor::inputAndUpdate() {
                                    layersPreviewRect.y + 10 + ( maxLayers - i - 1 ) * ( previewTileWidth * minLines + 10 ),
                                    previewTileWidth * minColumns,
                                    previewTileWidth * minLines );
-            if ( CheckCollisionPointRec( mousePos, previewRect ) ) {
+            if ( CheckCollisionPointRec( mousePos, previewRect ) && currentLayer != i + 1 ) {
+                deselectTiles();
                 currentLayer = i + 1;
             }
         }
@@ -545,47 +974,52 @@ void MapEditor::inputAndUpdate() {
         if ( isMouseInsideEditor( mousePos ) ) {
 
             computePressedLineAndColumn( mousePos, pressedLine, pressedColumn );
+            dragLine = pressedLine;
+            dragColumn = pressedColumn;
 
-            Tile* tile = getTileFromPosition( mousePos );
+            TileLayer &layer = layers[currentLayer - 1];
+            const int tile = getTileIndexFromPosition( mousePos );
 
-            if ( tile != nullptr ) {
+            if ( tile != -1 ) {
                 if ( activeInsertOption == static_cast<int>( ComponentInsertionType::tiles ) ) {
                     if ( tilePaintingType == static_cast<int>( TilePaintingType::textured ) ) {
                         if ( selectedTile != nullptr ) {
-                            tile->copyData( *selectedTile, Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
+                            layer.setTile( tile, getPaletteIndex( *selectedTile ), Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
                         }
                     } else { // colored
-                        tile->copyData( coloredModelTile, Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
+                        layer.setTile( tile, getPaletteIndex( coloredModelTile ), Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
                     }
                 } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::blocks ) ) {
                     if ( selectedBlock != nullptr ) {
-                        tile->copyData( *selectedBlock, TileCollisionType::solid, true );
+                        layer.setTile( tile, getPaletteIndex( *selectedBlock ), TileCollisionType::solid, true );
                     }
                 } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::items ) ) {
                     if ( selectedItem != nullptr ) {
-                        tile->copyData( *selectedItem, TileCollisionType::solid, true );
+                        layer.setTile( tile, getPaletteIndex( *selectedItem ), TileCollisionType::solid, true );
                     }
                 } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::baddies ) ) {
                     if ( selectedBaddie != nullptr ) {
-                        tile->copyData( *selectedBaddie, TileCollisionType::solid, true );
+                        layer.setTile( tile, getPaletteIndex( *selectedBaddie ), TileCollisionType::solid, true );
                     }
                 } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::mario ) ) {
-                    tile->copyData( mario, TileCollisionType::solid, true );
-                    if ( lastMarioTile != nullptr ) {
-                        Tile::resetTile( *lastMarioTile );
-                    }
-                    lastMarioTile = tile;
-                } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::select ) ) {
-                    if ( !tile->isSelected() ) {
-                        tile->setSelected( true );
-                        selectedTiles.push_back( tile );
+                    const uint16_t marioId = getPaletteIndex( mario );
+                    removeTiles( marioId );
+                    layer.setTile( tile, marioId, TileCollisionType::solid, true );
+                } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::fill ) ) {
+                    if ( tilePaintingType == static_cast<int>( TilePaintingType::textured ) ) {
+                        if ( selectedTile != nullptr ) {
+                            layer.floodFill( tile, getPaletteIndex( *selectedTile ), Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
+                        }
+                    } else { // colored
+                        layer.floodFill( tile, getPaletteIndex( coloredModelTile ), Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
                     }
                 }
             }
             
         }
 
-        if ( activeInsertOption == static_cast<int>( ComponentInsertionType::tiles) && !terrainPageEdit && !pipesPageEdit ) {
+        if ( ( activeInsertOption == static_cast<int>( ComponentInsertionType::tiles ) ||
+               activeInsertOption == static_cast<int>( ComponentInsertionType::fill ) ) && !terrainPageEdit && !pipesPageEdit ) {
 
             int ini = currentTerrainTile * 18;
             int end = ini + 18;
@@ -667,84 +1101,121 @@ void MapEditor::inputAndUpdate() {
 
             computePressedLineAndColumn( mousePos, currentLine, currentColumn );
 
+            if ( currentLine != -1 ) {
+                dragLine = currentLine;
+                dragColumn = currentColumn;
+            }
+
             if ( pressedLine != currentLine || 
                  pressedColumn != currentColumn ) {
 
-                Tile* tile = getTileFromPosition( mousePos );
+                TileLayer &layer = layers[currentLayer - 1];
+                const int tile = getTileIndexFromPosition( mousePos );
 
-                if ( tile != nullptr ) {
+                if ( tile != -1 ) {
                     if ( activeInsertOption == static_cast<int>( ComponentInsertionType::tiles ) ) {
                         if ( tilePaintingType == static_cast<int>( TilePaintingType::textured ) ) {
                             if ( selectedTile != nullptr ) {
-                                tile->copyData( *selectedTile, Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
+                                layer.setTile( tile, getPaletteIndex( *selectedTile ), Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
                             }
                         } else { // colored
-                            tile->copyData( coloredModelTile, Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
+                            layer.setTile( tile, getPaletteIndex( coloredModelTile ), Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
                         }
                     } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::blocks ) ) {
                         if ( selectedBlock != nullptr ) {
-                            tile->copyData( *selectedBlock, TileCollisionType::solid, true );
+                            layer.setTile( tile, getPaletteIndex( *selectedBlock ), TileCollisionType::solid, true );
                         }
                     } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::items ) ) {
                         if ( selectedItem != nullptr ) {
-                            tile->copyData( *selectedItem, TileCollisionType::solid, true );
+                            layer.setTile( tile, getPaletteIndex( *selectedItem ), TileCollisionType::solid, true );
                         }
                     } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::baddies ) ) {
                         if ( selectedBaddie != nullptr ) {
-                            tile->copyData( *selectedBaddie, TileCollisionType::solid, true );
-                        }
-                    } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::select ) ) {
-                        if ( !tile->isSelected() ) {
-                            tile->setSelected( true );
-                            selectedTiles.push_back( tile );
+                            layer.setTile( tile, getPaletteIndex( *selectedBaddie ), TileCollisionType::solid, true );
                         }
                     }
                 }
 
             }
 
-        } else {
-            if ( !selectedTiles.empty() ) {
-                for ( Tile* t : selectedTiles ) {
-                    Tile::resetTile( *t );
-                    if ( activeInsertOption == static_cast<int>( ComponentInsertionType::tiles ) ) {
-                        if ( tilePaintingType == static_cast<int>( TilePaintingType::textured ) ) {
-                            if ( selectedTile != nullptr ) {
-                                t->copyData( *selectedTile, Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
-                            }
-                        } else {
-                            t->copyData( coloredModelTile, Tile::getCollisionTypeFromInt( tileCollisionType ), tileVisible );
-                        }
-                    } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::blocks ) ) {
-                        if ( selectedBlock != nullptr ) {
-                            t->copyData( *selectedBlock, TileCollisionType::solid, true );
-                        }
-                    } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::items ) ) {
-                        if ( selectedItem != nullptr ) {
-                            t->copyData( *selectedItem, TileCollisionType::solid, true );
-                        }
-                    } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::baddies ) ) {
-                        if ( selectedBaddie != nullptr ) {
-                            t->copyData( *selectedBaddie, TileCollisionType::solid, true );
+        } else if ( pressedLine == -1 ) {
+            // the GUI configuration goes to the selected tiles (unless a
+            // rubber band started in the editor is being dragged out of it)
+            TileLayer &layer = layers[currentLayer - 1];
+
+            if ( !layer.getSelection().empty() ) {
+
+                // resolved once for the whole selection; empty when nothing is chosen
+                uint16_t tileId = TileLayer::EMPTY_TILE;
+                TileCollisionType collisionType = TileCollisionType::non_solid;
+                bool visible = true;
+
+                if ( activeInsertOption == static_cast<int>( ComponentInsertionType::tiles ) ) {
+                    if ( tilePaintingType == static_cast<int>( TilePaintingType::textured ) ) {
+                        if ( selectedTile != nullptr ) {
+                            tileId = getPaletteIndex( *selectedTile );
+                            collisionType = Tile::getCollisionTypeFromInt( tileCollisionType );
+                            visible = tileVisible;
                         }
+                    } else {
+                        // recolors the selection from the picked tile, if any
+                        tileId = getPaletteIndex( pickedColorTileId != TileLayer::EMPTY_TILE ? pickedColorTile : coloredModelTile );
+                        collisionType = Tile::getCollisionTypeFromInt( tileCollisionType );
+                        visible = tileVisible;
+                    }
+                } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::blocks ) ) {
+                    if ( selectedBlock != nullptr ) {
+                        tileId = getPaletteIndex( *selectedBlock );
+                        collisionType = TileCollisionType::solid;
                     }
+                } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::items ) ) {
+                    if ( selectedItem != nullptr ) {
+                        tileId = getPaletteIndex( *selectedItem );
+                        collisionType = TileCollisionType::solid;
+                    }
+                } else if ( activeInsertOption == static_cast<int>( ComponentInsertionType::baddies ) ) {
+                    if ( selectedBaddie != nullptr ) {
+                        tileId = getPaletteIndex( *selectedBaddie );
+                        collisionType = TileCollisionType::solid;
+                    }
+                }
+
+                // an empty tile keeps the default flags, as resetTile does
+                if ( tileId == TileLayer::EMPTY_TILE ) {
+                    collisionType = TileCollisionType::non_solid;
+                    visible = true;
                 }
+
+                layer.fillSelection( tileId, collisionType, visible );
+
             }
+
         }
 
 
         /* else if ( CheckCollisionPointRec( mousePos, colorPickerTileContainerRect ) ) {
 
-            for ( auto& tile : layers[currentLayer - 1] ) {
-                if ( tile->isSelected() && firstSelectedTile != nullptr ) {
-                    tile->setColor( *(firstSelectedTile->getColor()) );
-                    tile->setAlpha( *(firstSelectedTile->getAlpha()) );
-                }
-            }
+            TileLayer &layer = layers[currentLayer - 1];
+            layer.getSelection().forEach( [&]( int t ) {
+                layer.setTile( t, getPaletteIndex( coloredModelTile ), layer.getCollisionType( t ), layer.isVisible( t ) );
+            });
 
         }*/
 
     } else if ( IsMouseButtonReleased( MOUSE_BUTTON_LEFT ) ) {
+
+        // rubber band selection: replaces the selection, Shift adds to it
+        // and Alt removes from it
+        if ( activeInsertOption == static_cast<int>( ComponentInsertionType::select ) && pressedLine != -1 ) {
+            TileLayer &layer = layers[currentLayer - 1];
+            const bool add = IsKeyDown( KEY_LEFT_SHIFT ) || IsKeyDown( KEY_RIGHT_SHIFT );
+            const bool subtract = IsKeyDown( KEY_LEFT_ALT ) || IsKeyDown( KEY_RIGHT_ALT );
+            if ( !add && !subtract ) {
+                layer.deselectAll();
+            }
+            layer.selectRect( getRubberBand(), !subtract );
+        }
+
         pressedLine = -1;
         pressedColumn = -1;
     }
@@ -754,16 +1225,42 @@ void MapEditor::inputAndUpdate() {
     }
 
     if ( IsKeyPressed( KEY_DELETE ) ) {
-        if ( !selectedTiles.empty() ) {
-            for ( Tile* t : selectedTiles ) {
-                t->setSelected( false );
-                Tile::resetTile( *t );
-            }
-            selectedTiles.clear();
+        TileLayer &layer = layers[currentLayer - 1];
+        layer.getSelection().forEach( [&layer]( int t ) {
+            layer.resetTile( t, true );
+        });
+    }
+
+    const bool controlDown = IsKeyDown( KEY_LEFT_CONTROL ) || IsKeyDown( KEY_RIGHT_CONTROL );
+    const bool shiftDown = IsKeyDown( KEY_LEFT_SHIFT ) || IsKeyDown( KEY_RIGHT_SHIFT );
+
+    // copy tools: Ctrl+arrow repeats the selection up to the edge of the map,
+    // Ctrl+Shift+left/right over the whole row and Ctrl+Shift+up/down over
+    // the whole column
+    if ( controlDown && !layers[currentLayer - 1].getSelection().empty() ) {
+        TileLayer &layer = layers[currentLayer - 1];
+        if ( IsKeyPressed( KEY_RIGHT ) ) {
+            layer.replicateSelection( shiftDown, true, false, false );
+        } else if ( IsKeyPressed( KEY_LEFT ) ) {
+            layer.replicateSelection( true, shiftDown, false, false );
+        } else if ( IsKeyPressed( KEY_UP ) ) {
+            layer.replicateSelection( false, false, true, shiftDown );
+        } else if ( IsKeyPressed( KEY_DOWN ) ) {
+            layer.replicateSelection( false, false, shiftDown, true );
         }
     }
 
-    if ( IsKeyDown( KEY_LEFT_SHIFT ) ) {
+    // the pieces around what changed this frame are part of the same command
+    if ( autoTile && !autoTileDirtyRegion.isEmpty() ) {
+        retiling = true;
+        autoTiler.retile( layers[currentLayer - 1], autoTileDirtyRegion.getBounds() );
+        retiling = false;
+    }
+    autoTileDirtyRegion.clear();
+
+    journal.endCommand();
+
+    if ( IsKeyDown( KEY_LEFT_SHIFT ) && !controlDown ) {
         if ( IsKeyDown( KEY_W ) || IsKeyDown( KEY_UP ) ) {
             viewOffsetLine++;
         } else if ( IsKeyDown( KEY_S ) || IsKeyDown( KEY_DOWN ) ) {
@@ -790,7 +1287,23 @@ void MapEditor::inputAndUpdate() {
         }
     }
 
-    if ( IsKeyPressed( KEY_W ) || IsKeyPressed( KEY_UP ) ) {
+    if ( controlDown ) {
+        if ( IsKeyPressed( KEY_S ) ) {
+            saveMap( mapPath.empty() ? "map.txt" : mapPath );
+        } else if ( IsKeyPressed( KEY_Z ) ) {
+            if ( shiftDown ) {
+                redo();
+            } else {
+                undo();
+            }
+        } else if ( IsKeyPressed( KEY_Y ) ) {
+            redo();
+        } else if ( IsKeyPressed( KEY_A ) ) {
+            layers[currentLayer - 1].selectRect( DirtyRect( 0, 0, lines, columns ), true );
+        } else if ( IsKeyPressed( KEY_I ) ) {
+            layers[currentLayer - 1].invertSelection();
+        }
+    } else if ( IsKeyPressed( KEY_W ) || IsKeyPressed( KEY_UP ) ) {
         viewOffsetLine++;
     } else if ( IsKeyPressed( KEY_S ) || IsKeyPressed( KEY_DOWN ) ) {
         viewOffsetLine--;
@@ -817,25 +1330,53 @@ void MapEditor::inputAndUpdate() {
     }
 
 
-    std::map<std::string, Music>& musics = ResourceManager::getMusics();
-    const Music currentSelectedMusic = musics[TextFormat( "music%d", musicId )];
-    const Music previousSelectedMusic = musics[TextFormat( "music%d", previousSelectedMusicId )];
+    FrameProfiler::end( FrameProfiler::Phase::input );
+    FrameProfiler::Scope musicScope( FrameProfiler::Phase::music );
 
-    if ( playMusic ) {
-        if ( musicId != previousSelectedMusicId ) {
-            StopMusicStream( previousSelectedMusic );
-            PlayMusicStream( currentSelectedMusic );
-        } else {
-            if ( IsMusicStreamPlaying( currentSelectedMusic ) ) {
-                UpdateMusicStream( currentSelectedMusic );
-            } else {
-                PlayMusicStream( currentSelectedMusic );
+    // the neighbours of what the spinners select are read in the background
+    if ( backgroundTextureId != prefetchedBackgroundTextureId ) {
+        for ( int id = backgroundTextureId - 1; id <= backgroundTextureId + 1; id += 2 ) {
+            if ( id >= 1 && id <= static_cast<int>( backgroundTextureHandles.size() ) ) {
+                ResourceManager::prefetchTexture( backgroundTextureHandles[id - 1] );
+            }
+        }
+        prefetchedBackgroundTextureId = backgroundTextureId;
+    }
+
+    // the selected track is read in the background too, and only played once
+    // it has been uploaded, so neither the spinner nor the checkbox stall a frame
+    const int musicHandle = musicHandles[musicId - 1];
+
+    if ( musicId != prefetchedMusicId ) {
+        ResourceManager::prefetchMusic( musicHandle );
+        for ( int id = musicId - 1; id <= musicId + 1; id += 2 ) {
+            if ( id >= 1 && id <= static_cast<int>( musicHandles.size() ) ) {
+                ResourceManager::prefetchMusic( musicHandles[id - 1] );
             }
         }
+        prefetchedMusicId = musicId;
+    }
+
+    // the previous track is only stopped, so it is not loaded again if evicted
+    const Music &previousSelectedMusic = ResourceManager::getMusics().get( musicHandles[previousSelectedMusicId - 1] );
+
+    if ( musicId != previousSelectedMusicId && IsMusicStreamPlaying( previousSelectedMusic ) ) {
+        StopMusicStream( previousSelectedMusic );
+    }
+
+    if ( playMusic && ResourceManager::getMusics().isLoaded( musicHandle ) ) {
+        const Music &currentSelectedMusic = ResourceManager::useMusic( musicHandle );
+        if ( IsMusicStreamPlaying( currentSelectedMusic ) ) {
+            UpdateMusicStream( currentSelectedMusic );
+        } else {
+            PlayMusicStream( currentSelectedMusic );
+        }
     } else {
-        if ( IsMusicStreamPlaying( previousSelectedMusic ) ) {
-            StopMusicStream( previousSelectedMusic );
+        // no-op while the track is still being read, brings it back if evicted
+        if ( playMusic ) {
+            ResourceManager::prefetchMusic( musicHandle );
         }
+        const Music &currentSelectedMusic = ResourceManager::getMusics().get( musicHandle );
         if ( IsMusicStreamPlaying( currentSelectedMusic ) ) {
             StopMusicStream( currentSelectedMusic );
         }
@@ -848,8 +1389,6 @@ void MapEditor::inputAndUpdate() {
 
 void MapEditor::draw() {
 
-    std::map<std::string, Texture2D> &textures = ResourceManager::getTextures();
-
     startLine = lines - minLines - viewOffsetLine;
     startColumn = viewOffsetColumn;
 
@@ -857,8 +1396,8 @@ void MapEditor::draw() {
     DrawRectangle( pos.x, pos.y, minColumns * Tile::TILE_WIDTH, minLines * Tile::TILE_WIDTH, backgroundColor );
 
     if ( backgroundTextureId > 0 ) {
-        const Texture2D backgroundTexture = textures[TextFormat( "background%d", backgroundTextureId )];
-        const int repeats = ( columns * Tile::TILE_WIDTH ) / backgroundTexture.width + 1;
+        const Texture2D &backgroundTexture = ResourceManager::useTexture( backgroundTextureHandles[backgroundTextureId - 1] );
+        const int repeats = backgroundTexture.width > 0 ? ( columns * Tile::TILE_WIDTH ) / backgroundTexture.width + 1 : 0;
 
         for ( int i = 0; i < repeats; i++ ) {
             DrawTexture(
@@ -876,76 +1415,110 @@ void MapEditor::draw() {
     DrawRectangle( pos.x + minColumns * Tile::TILE_WIDTH, 0, GetScreenWidth(), GetScreenHeight(), WHITE );
 
     // tiles
-    for ( int k = 0; k < maxLayers; k++ ) {
-        if ( layersState[k].visible ) {
-            for ( int i = startLine; i < startLine + minLines; i++ ) {
-                for ( int j = startColumn; j < startColumn + minColumns; j++ ) {
-                    layers[k][i * columns + j]->draw( Vector2( pos.x + ( j - startColumn ) * Tile::TILE_WIDTH, pos.y + ( i - startLine ) * Tile::TILE_WIDTH ) );
-                }
-            }
-        }
-    }
+    FrameProfiler::begin( FrameProfiler::Phase::tiles );
+    updateTilesBackbuffer();
+    BeginBlendMode( BLEND_ALPHA_PREMULTIPLY );
+    DrawTextureRec(
+        tilesBackbuffer.texture,
+        Rectangle( 0, 0, tilesBackbuffer.texture.width, -tilesBackbuffer.texture.height ),
+        Vector2( pos.x - Tile::TILE_WIDTH, pos.y - Tile::TILE_WIDTH ),
+        WHITE );
+    EndBlendMode();
+    FrameProfiler::end( FrameProfiler::Phase::tiles );
 
     // rulers background
     DrawRectangle( pos.x + tileComposerDim.x, pos.y, Tile::TILE_WIDTH, minLines * Tile::TILE_WIDTH + 1, Fade( LIGHTGRAY, 0.5 ) );
     DrawRectangle( pos.x-1, pos.y + tileComposerDim.y, minColumns * Tile::TILE_WIDTH + 1, Tile::TILE_WIDTH, Fade( LIGHTGRAY, 0.5 ) );
 
-    // grid and rulers
+    // grid and rulers (all lines go in one batch, then all labels share the font texture)
+    rlBegin( RL_LINES );
+    rlColor4ub( BLACK.r, BLACK.g, BLACK.b, BLACK.a );
+
     for ( int i = 0; i <= minLines + 1; i++ ) {
         if ( showGrid || i == 0 || ( i >= minLines ) ) {
-            DrawLine( pos.x - 1, pos.y + i * Tile::TILE_WIDTH, pos.x + minColumns * Tile::TILE_WIDTH, pos.y + i * Tile::TILE_WIDTH, BLACK );
-        }
-        if ( i < minLines ) {
-            const char* t = TextFormat( "%d", startLine + i + 1 );
-            DrawText( t, pos.x + tileComposerDim.x + Tile::TILE_WIDTH / 2 - MeasureText( t, 10 ) / 2, pos.y + i * Tile::TILE_WIDTH + 12, 10, BLACK );
+            rlVertex2f( pos.x - 1, pos.y + i * Tile::TILE_WIDTH );
+            rlVertex2f( pos.x + minColumns * Tile::TILE_WIDTH, pos.y + i * Tile::TILE_WIDTH );
         }
     }
 
     for ( int i = 0; i <= minColumns + 1; i++ ) {
         if ( showGrid || i == 0 || ( i >= minColumns ) ) {
-            DrawLine( pos.x + i * Tile::TILE_WIDTH, pos.y, pos.x + i * Tile::TILE_WIDTH, pos.y + minLines * Tile::TILE_WIDTH + 1, BLACK );
-        }
-        if ( i < minColumns ) {
-            const char* t = TextFormat( "%d", startColumn + i + 1 );
-            DrawText( t, pos.x + i * Tile::TILE_WIDTH + Tile::TILE_WIDTH / 2 - MeasureText( t, 10 ) / 2, pos.y + tileComposerDim.y + 12, 10, BLACK );
+            rlVertex2f( pos.x + i * Tile::TILE_WIDTH, pos.y );
+            rlVertex2f( pos.x + i * Tile::TILE_WIDTH, pos.y + minLines * Tile::TILE_WIDTH + 1 );
         }
     }
 
+    rlEnd();
+
+    for ( int i = 0; i < minLines; i++ ) {
+        const char* t = rulerLabels[startLine + i].c_str();
+        DrawText( t, pos.x + tileComposerDim.x + Tile::TILE_WIDTH / 2 - MeasureText( t, 10 ) / 2, pos.y + i * Tile::TILE_WIDTH + 12, 10, BLACK );
+    }
+
+    for ( int i = 0; i < minColumns; i++ ) {
+        const char* t = rulerLabels[startColumn + i].c_str();
+        DrawText( t, pos.x + i * Tile::TILE_WIDTH + Tile::TILE_WIDTH / 2 - MeasureText( t, 10 ) / 2, pos.y + tileComposerDim.y + 12, 10, BLACK );
+    }
+
     // selected tiles
-    /*for ( int i = startLine; i < startLine + minLines; i++ ) {
+    const TileLayer &currentTileLayer = layers[currentLayer - 1];
+    for ( int i = startLine; i < startLine + minLines; i++ ) {
         for ( int j = startColumn; j < startColumn + minColumns; j++ ) {
-            if ( layers[currentLayer - 1][i * columns + j]->isSelected() ) {
+            if ( currentTileLayer.isSelected( currentTileLayer.getIndex( i, j ) ) ) {
                 Vector2 p( pos.x + ( j - startColumn ) * Tile::TILE_WIDTH, pos.y + ( i - startLine ) * Tile::TILE_WIDTH );
                 Vector2 d( Tile::TILE_WIDTH, Tile::TILE_WIDTH );
                 DrawRectangleLinesEx( Rectangle( p.x - 2, p.y - 1, d.x + 3, d.y + 3 ), 3, BLACK );
                 DrawCircle( p.x + d.x - 6, p.y + d.y - 5, 2, Fade( BLACK, 0.5 ) );
             }
         }
-    }*/
+    }
+
+    // rubber band
+    if ( activeInsertOption == static_cast<int>( ComponentInsertionType::select ) &&
+         IsMouseButtonDown( MOUSE_BUTTON_LEFT ) && pressedLine != -1 ) {
+        const DirtyRect band = getRubberBand();
+        const Rectangle bandRect(
+            pos.x + ( band.column - startColumn ) * Tile::TILE_WIDTH,
+            pos.y + ( band.line - startLine ) * Tile::TILE_WIDTH,
+            band.columns * Tile::TILE_WIDTH,
+            band.lines * Tile::TILE_WIDTH );
+        BeginScissorMode( pos.x, pos.y, tileComposerDim.x, tileComposerDim.y );
+        DrawRectangleRec( bandRect, Fade( BLUE, 0.2 ) );
+        DrawRectangleLinesEx( bandRect, 2, BLUE );
+        EndScissorMode();
+    }
 
     // GUI
+    FrameProfiler::begin( FrameProfiler::Phase::gui );
     GuiCheckBox( checkShowGridRect, "Show Grid", &showGrid );
     GuiCheckBox( checkPlayMusicRect, "Play Music", &playMusic );
 
-    GuiToggleGroup( toogleGroupInsertRect, ";;;;;", &activeInsertOption );
-    DrawTexture( textures["B1"], toogleGroupInsertRect.x + 6, toogleGroupInsertRect.y + 6, WHITE );
-    DrawTexture( textures["block9"], toogleGroupInsertRect.x + toogleGroupInsertRect.width + 8, toogleGroupInsertRect.y + 6, WHITE );
-    DrawTexture( textures["coin"], toogleGroupInsertRect.x + toogleGroupInsertRect.width * 2 + 10, toogleGroupInsertRect.y + 6, WHITE );
-    DrawTexture( textures["goombaR"], toogleGroupInsertRect.x + toogleGroupInsertRect.width * 3 + 12, toogleGroupInsertRect.y + 6, WHITE );
-    DrawTexture( textures["marioR"], toogleGroupInsertRect.x + toogleGroupInsertRect.width * 4 + 12, toogleGroupInsertRect.y + 2, WHITE );
-    DrawTexture( textures["selectBlock"], toogleGroupInsertRect.x + toogleGroupInsertRect.width * 5 + 16, toogleGroupInsertRect.y + 6, WHITE );
+    GuiToggleGroup( toogleGroupInsertRect, ";;;;;;#29#", &activeInsertOption );
+    if ( resourceDependantComponentsCreated ) {
+        drawAtlasTexture( insertOptionTextureHandles[0], toogleGroupInsertRect.x + 6, toogleGroupInsertRect.y + 6 );
+        drawAtlasTexture( insertOptionTextureHandles[1], toogleGroupInsertRect.x + toogleGroupInsertRect.width + 8, toogleGroupInsertRect.y + 6 );
+        drawAtlasTexture( insertOptionTextureHandles[2], toogleGroupInsertRect.x + toogleGroupInsertRect.width * 2 + 10, toogleGroupInsertRect.y + 6 );
+        drawAtlasTexture( insertOptionTextureHandles[3], toogleGroupInsertRect.x + toogleGroupInsertRect.width * 3 + 12, toogleGroupInsertRect.y + 6 );
+        drawAtlasTexture( insertOptionTextureHandles[4], toogleGroupInsertRect.x + toogleGroupInsertRect.width * 4 + 12, toogleGroupInsertRect.y + 2 );
+        drawAtlasTexture( insertOptionTextureHandles[5], toogleGroupInsertRect.x + toogleGroupInsertRect.width * 5 + 16, toogleGroupInsertRect.y + 6 );
+    }
 
     GuiGroupBox( guiContainerRect, "Options" );
     GuiGroupBox( layersPreviewRect, "Layers" );
+    FrameProfiler::end( FrameProfiler::Phase::gui );
 
+    FrameProfiler::begin( FrameProfiler::Phase::previews );
     for ( int i = maxLayers - 1; i >= 0; i-- ) {
         Vector2 pos( layersPreviewRect.x + 40,
                      layersPreviewRect.y + 10 + ( maxLayers - i - 1 ) * ( previewTileWidth * minLines + 10 ) );
         drawLayerPreview( pos.x, pos.y,
                           previewTileWidth,
-                          i + 1 == currentLayer, layers[i] );
+                          i + 1 == currentLayer, layers[i], layersState[i] );
         GuiCheckBox( Rectangle( pos.x - 30, pos.y + ( previewTileWidth * minLines ) / 2 - 10, 20, 20 ), nullptr, &( layersState[i].visible ) );
     }
+    FrameProfiler::end( FrameProfiler::Phase::previews );
+
+    FrameProfiler::begin( FrameProfiler::Phase::gui );
 
     GuiGroupBox( mapPropertiesRect, "Map Properties" );
     GuiSpinner( spinnerLinesRect, "Lines: ", &lines, minLines, maxLines, linesEdit );
@@ -957,21 +1530,20 @@ void MapEditor::draw() {
     GuiSpinner( spinnerMusicIdRect, "Music: ", &musicId, 1, 9, false );
     if ( GuiSpinner( spinnerTimeToFinishRect, "Time to Finish: ", &timeToFinish, 1, 2000, timeToFinishEdit ) ) timeToFinishEdit = !timeToFinishEdit;
 
-    if ( activeInsertOption == static_cast<int>(ComponentInsertionType::tiles) ) {
+    if ( activeInsertOption == static_cast<int>(ComponentInsertionType::tiles) ||
+         activeInsertOption == static_cast<int>(ComponentInsertionType::fill) ) {
 
-        GuiGroupBox( componentPropertiesRect, "Tiles" );
+        // the bucket fill paints with the tiles configuration
+        GuiGroupBox( componentPropertiesRect, activeInsertOption == static_cast<int>(ComponentInsertionType::fill) ? "Bucket Fill" : "Tiles" );
 
         GuiToggleGroup( togglePaintingTypeRect, "textured;colored", &tilePaintingType );
         GuiCheckBox( checkVisibleRect, "Visible", &tileVisible );
+        GuiCheckBox( checkAutoTileRect, "Auto Tile", &autoTile );
 
         GuiGroupBox( colorPickerTileContainerRect, "Color" );
-        if ( firstSelectedTile != nullptr ) {
-            GuiColorPicker( colorPickerTileRect, nullptr, firstSelectedTile->getColor() );
-            GuiColorBarAlpha( sliderAlphaTileRect, nullptr, firstSelectedTile->getAlpha() );
-        } else {
-            GuiColorPicker( colorPickerTileRect, nullptr, coloredModelTile.getColor() );
-            GuiColorBarAlpha( sliderAlphaTileRect, nullptr, coloredModelTile.getAlpha() );
-        }
+        Tile &pickerTile = pickedColorTileId != TileLayer::EMPTY_TILE ? pickedColorTile : coloredModelTile;
+        GuiColorPicker( colorPickerTileRect, nullptr, pickerTile.getColor() );
+        GuiColorBarAlpha( sliderAlphaTileRect, nullptr, pickerTile.getAlpha() );
 
         if ( GuiDropdownBox( comboTileCollisionTypeRect, "solid;solid from above;solid only for baddies;non-solid", &tileCollisionType, tileCollisionTypeEdit ) ) tileCollisionTypeEdit = !tileCollisionTypeEdit;
 
@@ -1058,11 +1630,16 @@ void MapEditor::draw() {
 
     }
 
+    FrameProfiler::end( FrameProfiler::Phase::gui );
+
     if ( lines != previousLines || columns != previousColumns ) {
         deselectTiles();
+        journal.beginCommand();
         for ( int i = 0; i < maxLayers; i++ ) {
             relocateTiles( layers[i] );
         }
+        journal.endCommand();
+        autoTileDirtyRegion.clear();
     }
 
     previousLines = lines;
@@ -1075,7 +1652,8 @@ void MapEditor::draw() {
         /*mousePos.x -= Tile::TILE_WIDTH / 2;
         mousePos.y -= Tile::TILE_WIDTH / 2;*/
 
-        if ( activeInsertOption == static_cast<int>( ComponentInsertionType::tiles ) ) {
+        if ( activeInsertOption == static_cast<int>( ComponentInsertionType::tiles ) ||
+             activeInsertOption == static_cast<int>( ComponentInsertionType::fill ) ) {
             if ( tilePaintingType == static_cast<int>( TilePaintingType::textured ) ) {
                 if ( selectedTile != nullptr ) {
                     selectedTile->draw( mousePos, true );
@@ -1103,72 +1681,154 @@ void MapEditor::draw() {
 
 }
 
-void MapEditor::relocateTiles( std::vector<Tile*>& tiles ) const {
+/**
+ * Loads a map into the layers. Text maps (.txt) go into the first layer,
+ * clearing the others; binary maps (.rmap) keep their layers. Errors are
+ * logged with their line and column, and whatever could be read stays
+ * loaded, but the map is then saved to a new file. Glyphs with no image
+ * are kept as placeholders.
+ */
+bool MapEditor::loadMap( const std::string &path ) {
 
-    const std::vector<Tile*> prevTiles = tiles;
-    tiles.clear();
+    if ( !resourceDependantComponentsCreated || !FileExists( path.c_str() ) ) {
+        TraceLog( LOG_WARNING, "MAP: Could not load [%s]", path.c_str() );
+        return false;
+    }
 
-    const int lineDiff = abs( lines - previousLines );
-    const int columnDiff = abs( columns - previousColumns );
+    deselectTiles();
 
-    if ( lines > previousLines ) {
+    for ( auto &layer : layers ) {
+        layer.resize( 0, 0 );
+    }
 
-        for ( int i = 0; i < lines; i++ ) {
-            for ( int j = 0; j < columns; j++ ) {
-                if ( i < lineDiff ) {
-                    tiles.push_back( new Tile( Vector2( j * Tile::TILE_WIDTH, i * Tile::TILE_WIDTH ), WHITE, 0, true, Vector2( pos.x, pos.y ) ) );
-                } else {
-                    Tile *tile = prevTiles[( i - lineDiff ) * columns + j];
-                    tile->setPos( j * Tile::TILE_WIDTH, i * Tile::TILE_WIDTH );
-                    tiles.push_back( tile );
-                }
-            }
+    const MapFile::GlyphResolver resolver = [this]( char glyph, const MapGlyph &info, const std::string &textureKey ) -> uint16_t {
+        if ( info.type == MapGlyphType::invisible ) {
+            return getPaletteIndex( Tile( Vector2( 0, 0 ), BLACK, 1, false, Vector2( pos.x, pos.y ) ) );
         }
+        if ( info.type == MapGlyphType::undefined || !ResourceManager::getAtlas().contains( textureKey ) ) {
+            return getPlaceholderIndex( glyph );
+        }
+        return getPaletteIndex( createAtlasTile( Vector2( 0, 0 ), textureKey, Vector2( pos.x, pos.y ) ) );
+    };
 
-    } else if( lines < previousLines ) {
+    const MapBinaryFile::ColorResolver colorResolver = [this]( Color color ) -> uint16_t {
+        return getPaletteIndex( Tile( Vector2( 0, 0 ), color, 1, false, Vector2( pos.x, pos.y ) ) );
+    };
 
-        for ( int i = 0; i < previousLines; i++ ) {
-            for ( int j = 0; j < columns; j++ ) {
-                if ( i < lineDiff ) {
-                    delete prevTiles[i * columns + j];
-                } else {
-                    Tile* tile = prevTiles[i * columns + j];
-                    tile->setPos( j * Tile::TILE_WIDTH, (i-lineDiff) * Tile::TILE_WIDTH );
-                    tiles.push_back( tile );
-                }
-            }
-        }
+    std::vector<MapError> errors;
+    const bool ok = IsFileExtension( path.c_str(), ".rmap" ) ?
+        MapBinaryFile::load( path, mapMetadata, layers, resolver, colorResolver, errors ) :
+        MapFile::load( path, mapMetadata, layers[0], resolver, errors );
+
+    for ( const auto &error : errors ) {
+        TraceLog( LOG_WARNING, "MAP: [%s] %d:%d: %s", path.c_str(), error.line, error.column, error.message.c_str() );
+    }
+
+    lines = std::max( layers[0].getLines(), minLines );
+    columns = std::max( layers[0].getColumns(), minColumns );
+    previousLines = lines;
+    previousColumns = columns;
+    viewOffsetLine = 0;
+    viewOffsetColumn = 0;
+    currentLayer = 1;
 
+    for ( auto &layer : layers ) {
+        relocateTiles( layer );
     }
 
-    if ( columns > previousColumns ) {
+    journal.clear();
+    autoTileDirtyRegion.clear();
+
+    backgroundColor = mapMetadata.backgroundColor;
+    backgroundTextureId = std::clamp( mapMetadata.backgroundTextureId, 0, 10 );
+    musicId = std::clamp( mapMetadata.musicId, 1, 9 );
+    timeToFinish = mapMetadata.timeToFinish;
 
-        for ( int i = 0; i < lines; i++ ) {
-            for ( int j = 0; j < columns; j++ ) {
-                if ( j < previousColumns ) {
-                    Tile* tile = prevTiles[i * previousColumns + j];
-                    tile->setPos( j * Tile::TILE_WIDTH, i * Tile::TILE_WIDTH );
-                    tiles.push_back( tile );
-                } else {
-                    tiles.push_back( new Tile( Vector2( j * Tile::TILE_WIDTH, i * Tile::TILE_WIDTH ), WHITE, 0, true, Vector2( pos.x, pos.y ) ) );
+    // what could not be read would be lost by saving over the file
+    if ( ok ) {
+        mapPath = path;
+        TraceLog( LOG_INFO, "MAP: [%s] loaded (%dx%d)", path.c_str(), lines, columns );
+    } else {
+        mapPath.clear();
+        TraceLog( LOG_WARNING, "MAP: [%s] loaded with errors (%dx%d), it will be saved to a new file", path.c_str(), lines, columns );
+    }
+
+    return ok;
+
+}
+
+/**
+ * Saves the map in the binary format when the path ends with .rmap, keeping
+ * each layer and colored tiles, or else in the text format, merging all
+ * layers into one grid. The glyph of each palette entry is found by matching its atlas
+ * region against the regions of the glyph table (the width tells a
+ * mirrored region from the one it mirrors); placeholders keep the glyph
+ * they were loaded from.
+ */
+bool MapEditor::saveMap( const std::string &path ) {
+
+    TextureAtlas &atlas = ResourceManager::getAtlas();
+    const auto &table = MapFile::getGlyphTable();
+    std::map<std::tuple<unsigned int, float, float, float>, char> glyphsByRegion;
+
+    for ( int g = 0; g < 128; g++ ) {
+        if ( table[g].type == MapGlyphType::textured ) {
+            const int sets = g >= 'A' && g <= 'Z' ? 4 : 1;
+            for ( int set = 1; set <= sets; set++ ) {
+                Rectangle source;
+                const Texture2D *texture = atlas.getTexture( MapFile::getTextureKey( g, set ), source );
+                if ( texture != nullptr ) {
+                    glyphsByRegion.emplace( std::make_tuple( texture->id, source.x, source.y, source.width ), static_cast<char>( g ) );
                 }
             }
         }
+    }
 
-    } else if ( columns < previousColumns ) {
-
-        for ( int i = 0; i < lines; i++ ) {
-            for ( int j = 0; j < previousColumns; j++ ) {
-                if ( j < columns ) {
-                    Tile* tile = prevTiles[i * previousColumns + j];
-                    tile->setPos( j * Tile::TILE_WIDTH, i * Tile::TILE_WIDTH );
-                    tiles.push_back( tile );
-                } else {
-                    delete prevTiles[i * previousColumns + j];
-                }
+    std::vector<char> paletteGlyphs( palette.size(), 0 );
+    std::vector<Color> paletteColors( palette.size(), BLANK );
+
+    for ( size_t i = 1; i < palette.size(); i++ ) {
+        const Texture2D *texture = palette[i].getTexture();
+        const auto placeholder = placeholderGlyphs.find( static_cast<uint16_t>( i ) );
+        if ( placeholder != placeholderGlyphs.end() ) {
+            paletteGlyphs[i] = placeholder->second;
+        } else if ( texture == nullptr ) {
+            paletteGlyphs[i] = MapFile::COLORED_TILE;
+            paletteColors[i] = Fade( *palette[i].getColor(), *palette[i].getAlpha() );
+        } else {
+            const Rectangle &source = palette[i].getSource();
+            const auto it = glyphsByRegion.find( std::make_tuple( texture->id, source.x, source.y, source.width ) );
+            if ( it != glyphsByRegion.end() ) {
+                paletteGlyphs[i] = it->second;
             }
         }
+    }
+
+    mapMetadata.backgroundColor = backgroundColor;
+    mapMetadata.backgroundTextureId = backgroundTextureId;
+    mapMetadata.musicId = musicId;
+    mapMetadata.timeToFinish = timeToFinish;
+
+    std::vector<MapError> errors;
+    const bool ok = IsFileExtension( path.c_str(), ".rmap" ) ?
+        MapBinaryFile::save( path, mapMetadata, layers, paletteGlyphs, paletteColors, errors ) :
+        MapFile::save( path, mapMetadata, layers, paletteGlyphs, errors );
 
+    for ( const auto &error : errors ) {
+        TraceLog( LOG_WARNING, "MAP: [%s] %d:%d: %s", path.c_str(), error.line, error.column, error.message.c_str() );
     }
 
+    if ( ok ) {
+        mapPath = path;
+        TraceLog( LOG_INFO, "MAP: [%s] saved", path.c_str() );
+    } else {
+        TraceLog( LOG_ERROR, "MAP: [%s] not saved", path.c_str() );
+    }
+
+    return ok;
+
+}
+
+void MapEditor::relocateTiles( TileLayer &layer ) const {
+    layer.resize( lines, columns );
 }
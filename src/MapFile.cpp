@@ -0,0 +1,589 @@
+/**
+ * @file MapFile.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief MapFile class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MapFile.h"
+#include "TileCollisionType.h"
+#include "TileLayer.h"
+
+static std::array<MapGlyph, 128> buildGlyphTable() {
+
+    std::array<MapGlyph, 128> table;
+    table.fill( MapGlyph( MapGlyphType::undefined, "", TileCollisionType::non_solid ) );
+
+    table[' '] = MapGlyph( MapGlyphType::empty, "", TileCollisionType::non_solid );
+
+    // tiles
+    table['/'] = MapGlyph( MapGlyphType::invisible, "", TileCollisionType::solid );
+    table['|'] = MapGlyph( MapGlyphType::invisible, "", TileCollisionType::solid_only_for_baddies );
+    for ( char c = 'A'; c <= 'Z'; c++ ) {   // the tile sets have no images for S..Z yet
+        table[c] = MapGlyph( MapGlyphType::textured, "", TileCollisionType::solid );
+    }
+    table['{'] = MapGlyph( MapGlyphType::textured, "tileCourseClearPoleBackTop", TileCollisionType::non_solid );
+    table['['] = MapGlyph( MapGlyphType::textured, "tileCourseClearPoleBackBody", TileCollisionType::non_solid );
+    table['}'] = MapGlyph( MapGlyphType::textured, "tileCourseClearPoleFrontTop", TileCollisionType::non_solid );
+    table[']'] = MapGlyph( MapGlyphType::textured, "tileCourseClearPoleFrontBody", TileCollisionType::non_solid );
+
+    // blocks
+    table['i'] = MapGlyph( MapGlyphType::textured, "block0", TileCollisionType::solid );
+    table['c'] = MapGlyph( MapGlyphType::textured, "block1", TileCollisionType::solid );
+    table['g'] = MapGlyph( MapGlyphType::textured, "block2", TileCollisionType::solid );
+    table['s'] = MapGlyph( MapGlyphType::textured, "block3", TileCollisionType::solid );
+    table['w'] = MapGlyph( MapGlyphType::textured, "block4", TileCollisionType::solid );
+    table['v'] = MapGlyph( MapGlyphType::textured, "block5", TileCollisionType::solid );
+    table['y'] = MapGlyph( MapGlyphType::textured, "block6", TileCollisionType::solid );
+    table['!'] = MapGlyph( MapGlyphType::textured, "block7", TileCollisionType::solid );
+    table['h'] = MapGlyph( MapGlyphType::textured, "block8", TileCollisionType::solid );
+    table['?'] = MapGlyph( MapGlyphType::textured, "block9", TileCollisionType::solid );
+    table['m'] = MapGlyph( MapGlyphType::textured, "block10", TileCollisionType::solid );
+    table['u'] = MapGlyph( MapGlyphType::textured, "block11", TileCollisionType::solid );
+    table['f'] = MapGlyph( MapGlyphType::textured, "block12", TileCollisionType::solid );
+    table['+'] = MapGlyph( MapGlyphType::textured, "block13", TileCollisionType::solid );
+    table['*'] = MapGlyph( MapGlyphType::textured, "block14", TileCollisionType::solid );
+
+    // items
+    table['o'] = MapGlyph( MapGlyphType::textured, "coin", TileCollisionType::solid );
+    table[':'] = MapGlyph( MapGlyphType::textured, "yoshiCoin", TileCollisionType::solid );
+    table['='] = MapGlyph( MapGlyphType::textured, "courseClearToken", TileCollisionType::solid );
+
+    // baddies
+    table['1'] = MapGlyph( MapGlyphType::textured, "goombaL", TileCollisionType::solid );
+    table['2'] = MapGlyph( MapGlyphType::textured, "flyingGoombaL", TileCollisionType::solid );
+    table['3'] = MapGlyph( MapGlyphType::textured, "greenKoopaTroopaL", TileCollisionType::solid );
+    table['4'] = MapGlyph( MapGlyphType::textured, "redKoopaTroopaL", TileCollisionType::solid );
+    table['5'] = MapGlyph( MapGlyphType::textured, "blueKoopaTroopaL", TileCollisionType::solid );
+    table['6'] = MapGlyph( MapGlyphType::textured, "yellowKoopaTroopaL", TileCollisionType::solid );
+    table['7'] = MapGlyph( MapGlyphType::textured, "bobOmbL", TileCollisionType::solid );
+    table['8'] = MapGlyph( MapGlyphType::textured, "bulletBillL", TileCollisionType::solid );
+    table['9'] = MapGlyph( MapGlyphType::textured, "swooperL", TileCollisionType::solid );
+    table['@'] = MapGlyph( MapGlyphType::textured, "buzzyBeetleL", TileCollisionType::solid );
+    table['$'] = MapGlyph( MapGlyphType::textured, "mummyBeetleL", TileCollisionType::solid );
+    table['%'] = MapGlyph( MapGlyphType::textured, "rexL", TileCollisionType::solid );
+    table['&'] = MapGlyph( MapGlyphType::textured, "muncher", TileCollisionType::solid );
+    table['~'] = MapGlyph( MapGlyphType::textured, "piranhaPlant", TileCollisionType::solid );
+    table['^'] = MapGlyph( MapGlyphType::textured, "jumpingPiranhaPlant", TileCollisionType::solid );
+    table['<'] = MapGlyph( MapGlyphType::textured, "banzaiBillL", TileCollisionType::solid );
+    table['.'] = MapGlyph( MapGlyphType::textured, "montyMoleL", TileCollisionType::solid );
+
+    // player
+    table['p'] = MapGlyph( MapGlyphType::textured, "marioR", TileCollisionType::solid );
+
+    return table;
+
+}
+
+/**
+ * Walks the lines of a text in place, without copying them. Line breaks
+ * may be \n or \r\n and a line break at the end of the text does not
+ * start another line. Line numbers start at 1.
+ */
+class LineCursor {
+
+    std::string_view text;
+    size_t position;
+    int lineNumber;
+
+    static bool isTrailing( std::string_view line ) {
+        return line.empty() || line == "\r";
+    }
+
+public:
+
+    explicit LineCursor( std::string_view text )
+        :
+        text( text ),
+        position( 0 ),
+        lineNumber( 0 ) {
+    }
+
+    bool next( std::string_view &line ) {
+
+        if ( position > text.size() ) {
+            return false;
+        }
+
+        size_t end = text.find( '\n', position );
+        if ( end == std::string_view::npos ) {
+            end = text.size();
+        }
+
+        line = text.substr( position, end - position );
+        position = end + 1;
+
+        if ( end == text.size() && isTrailing( line ) && lineNumber > 0 ) {
+            return false;
+        }
+
+        if ( !line.empty() && line.back() == '\r' ) {
+            line.remove_suffix( 1 );
+        }
+
+        lineNumber++;
+        return true;
+
+    }
+
+    int getLineNumber() const {
+        return lineNumber;
+    }
+
+    // lines next() will still return, counted without splitting them
+    int countRemaining() const {
+
+        if ( position > text.size() ) {
+            return 0;
+        }
+
+        const std::string_view rest = text.substr( position );
+        const size_t lastBreak = rest.rfind( '\n' );
+        const std::string_view last = lastBreak == std::string_view::npos ? rest : rest.substr( lastBreak + 1 );
+        const int count = static_cast<int>( std::count( rest.begin(), rest.end(), '\n' ) ) + 1;
+
+        return isTrailing( last ) && lineNumber + count > 1 ? count - 1 : count;
+
+    }
+
+};
+
+static void addError( std::vector<MapError> &errors, int line, int column, const std::string &message ) {
+    errors.push_back( MapError( line, column, message ) );
+}
+
+static bool parseInt( std::string_view token, int &value ) {
+    const auto [end, ec] = std::from_chars( token.data(), token.data() + token.size(), value );
+    return ec == std::errc() && end == token.data() + token.size();
+}
+
+static bool parseColor( std::string_view token, Color &color ) {
+
+    unsigned int value = 0;
+
+    if ( token.size() != 10 || token[0] != '0' || ( token[1] != 'x' && token[1] != 'X' ) ) {
+        return false;
+    }
+
+    const auto [end, ec] = std::from_chars( token.data() + 2, token.data() + token.size(), value, 16 );
+
+    if ( ec != std::errc() || end != token.data() + token.size() ) {
+        return false;
+    }
+
+    color = Color(
+        static_cast<unsigned char>( value >> 24 ),
+        static_cast<unsigned char>( value >> 16 ),
+        static_cast<unsigned char>( value >> 8 ),
+        static_cast<unsigned char>( value ) );
+
+    return true;
+
+}
+
+static bool isHeader( std::string_view line ) {
+    return line.size() >= 2 && line[1] == ':' &&
+           std::string_view( "cbtmfh" ).find( line[0] ) != std::string_view::npos &&
+           ( line.size() == 2 || line[2] == ' ' );
+}
+
+/**
+ * Header values are a single token, everything after it (usually spaces
+ * and a comment) is kept so the file can be written back unchanged.
+ * Messages (h:) take the whole rest of the line.
+ */
+static void parseHeader( std::string_view line, int lineNumber, MapMetadata &metadata, std::vector<MapError> &errors ) {
+
+    const char key = line[0];
+    const std::string_view rest = line.size() > 3 ? line.substr( 3 ) : std::string_view();
+
+    if ( key == 'h' ) {
+        metadata.messages.emplace_back( rest );
+        return;
+    }
+
+    const size_t tokenEnd = std::min( rest.find_first_of( " \t" ), rest.size() );
+    const std::string_view token = rest.substr( 0, tokenEnd );
+    metadata.headerComments[key] = std::string( rest.substr( tokenEnd ) );
+    metadata.headerLines[key] = lineNumber;
+
+    bool valid = false;
+
+    switch ( key ) {
+        case 'c': valid = parseColor( token, metadata.backgroundColor ); break;
+        case 'b': valid = parseInt( token, metadata.backgroundTextureId ); break;
+        case 't': valid = parseInt( token, metadata.tileSetId ) && metadata.tileSetId >= 1 && metadata.tileSetId <= 4; break;
+        case 'm': valid = parseInt( token, metadata.musicId ); break;
+        case 'f': valid = parseInt( token, metadata.timeToFinish ); break;
+    }
+
+    if ( !valid ) {
+        addError( errors, lineNumber, 4, "invalid value \"" + std::string( token ) + "\" for header " + key + ':' );
+    }
+
+}
+
+const std::array<MapGlyph, 128> &MapFile::getGlyphTable() {
+    static const std::array<MapGlyph, 128> table = buildGlyphTable();
+    return table;
+}
+
+std::string MapFile::getTextureKey( char glyph, int tileSetId ) {
+    if ( glyph >= 'A' && glyph <= 'Z' ) {
+        return std::string( 1, glyph ) + std::to_string( tileSetId );
+    }
+    const unsigned char g = static_cast<unsigned char>( glyph );
+    return g < 128 ? getGlyphTable()[g].textureKey : "";
+}
+
+bool MapFile::load( const std::string &path, MapMetadata &metadata, TileLayer &layer,
+                    const GlyphResolver &resolver, std::vector<MapError> &errors ) {
+
+    std::ifstream file( path, std::ios::binary );
+
+    if ( !file ) {
+        addError( errors, 0, 0, "could not open " + path );
+        return false;
+    }
+
+    std::stringstream ss;
+    ss << file.rdbuf();
+    const std::string text = ss.str();
+
+    return parse( text, metadata, layer, resolver, errors );
+
+}
+
+/**
+ * Headers are read until the first grid line, then the grid is written
+ * into the layer line by line as the cursor walks the text. The map grows
+ * upwards, so when it has more lines than the layer can hold the bottom
+ * ones are kept; the grid lines are counted first (a scan for line
+ * breaks) to know how many to skip. Each distinct glyph is resolved only
+ * once.
+ *
+ * Returns false when any error was reported; what could be read is loaded
+ * anyway.
+ */
+bool MapFile::parse( std::string_view text, MapMetadata &metadata, TileLayer &layer,
+                     const GlyphResolver &resolver, std::vector<MapError> &errors ) {
+
+    const size_t initialErrors = errors.size();
+    LineCursor cursor( text );
+    std::string_view line;
+    bool inGrid = false;
+
+    metadata.messages.clear();
+    metadata.comments.clear();
+    metadata.headerComments.clear();
+    metadata.headerLines.clear();
+
+    while ( !inGrid && cursor.next( line ) ) {
+        if ( line.empty() || line[0] == '#' ) {
+            metadata.comments.emplace_back( line );
+        } else if ( isHeader( line ) ) {
+            parseHeader( line, cursor.getLineNumber(), metadata, errors );
+        } else {
+            inGrid = true;
+        }
+    }
+
+    const int maxLines = layer.getMaxLines();
+    const int maxColumns = layer.getMaxColumns();
+    const int firstGridLine = inGrid ? cursor.getLineNumber() : 0;
+    const int rows = inGrid ? cursor.countRemaining() + 1 : 0;
+    const int skippedRows = std::max( rows - maxLines, 0 );
+
+    metadata.firstGridLine = firstGridLine + skippedRows;
+
+    if ( skippedRows > 0 ) {
+        addError( errors, firstGridLine, 1, "the map has " + std::to_string( rows ) + " lines, only the last " + std::to_string( maxLines ) + " were loaded" );
+    }
+
+    layer.resize( 0, 0 );
+    layer.resize( rows - skippedRows, maxColumns );
+
+    MapGlyphDecoder decoder( resolver, metadata.tileSetId );
+    int width = 0;
+
+    for ( int r = 0; r < rows; r++ ) {
+
+        if ( r > 0 ) {
+            cursor.next( line );
+        }
+
+        if ( r < skippedRows ) {
+            continue;
+        }
+
+        const std::string_view row = line;
+        const int currentLine = cursor.getLineNumber();
+        const int lineWidth = std::min( static_cast<int>( row.size() ), maxColumns );
+        const int layerLine = r - skippedRows;
+
+        if ( static_cast<int>( row.size() ) > maxColumns ) {
+            addError( errors, currentLine, maxColumns + 1, "line longer than " + std::to_string( maxColumns ) + " columns, the rest was ignored" );
+        }
+
+        width = std::max( width, lineWidth );
+
+        for ( int c = 0; c < lineWidth; c++ ) {
+
+            const std::string error = decoder.setCell( layer, layer.getIndex( layerLine, c ), static_cast<unsigned char>( row[c] ) );
+
+            if ( !error.empty() ) {
+                addError( errors, currentLine, c + 1, error );
+            }
+
+        }
+
+    }
+
+    layer.resize( rows - skippedRows, width );
+
+    return errors.size() == initialErrors;
+
+}
+
+bool MapFile::save( const std::string &path, const MapMetadata &metadata, const std::vector<TileLayer> &layers,
+                    const std::vector<char> &paletteGlyphs, std::vector<MapError> &errors ) {
+
+    const size_t initialErrors = errors.size();
+    const std::string text = write( metadata, layers, paletteGlyphs, errors );
+
+    // never replace a file with a map that lost tiles
+    if ( errors.size() != initialErrors ) {
+        addError( errors, 0, 0, path + " was not written, some tiles have no glyph" );
+        return false;
+    }
+
+    std::ofstream file( path, std::ios::binary );
+
+    if ( !file || !file.write( text.data(), static_cast<std::streamsize>( text.size() ) ) ) {
+        addError( errors, 0, 0, "could not write " + path );
+    }
+
+    return errors.size() == initialErrors;
+
+}
+
+/**
+ * The whole file is built in one buffer, reserved up front, and each grid
+ * line is filled in place. Cells take the glyph of the topmost layer that
+ * has a tile there. Like the shipped maps, lines are padded with spaces to
+ * the map width and the file does not end with a line break. Errors point
+ * to the line and column of the cell in the written file.
+ */
+std::string MapFile::write( const MapMetadata &metadata, const std::vector<TileLayer> &layers,
+                            const std::vector<char> &paletteGlyphs, std::vector<MapError> &errors ) {
+
+    static const std::map<char, std::string> defaultHeaderComments{
+        { 'c', "     # background color: [0xrrggbbaa]" },
+        { 'b', "              # background id: [0-10]" },
+        { 't', "              # tile set id: [1-4]" },
+        { 'm', "              # music id: [1-9]" },
+        { 'f', "            # time to finish the map" }
+    };
+
+    const int lines = layers.empty() ? 0 : layers[0].getLines();
+    const int columns = layers.empty() ? 0 : layers[0].getColumns();
+
+    std::string text;
+    size_t size = static_cast<size_t>( lines ) * ( columns + 1 ) + 256;
+    for ( const auto &comment : metadata.comments ) {
+        size += comment.size() + 1;
+    }
+    for ( const auto &message : metadata.messages ) {
+        size += message.size() + 4;
+    }
+    text.reserve( size );
+
+    for ( const auto &comment : metadata.comments ) {
+        text += comment;
+        text += '\n';
+    }
+
+    const auto headerComment = [&metadata]( char key ) -> const std::string& {
+        const auto it = metadata.headerComments.find( key );
+        return it != metadata.headerComments.end() ? it->second : defaultHeaderComments.at( key );
+    };
+
+    const Color &c = metadata.backgroundColor;
+    char color[16];
+    std::snprintf( color, sizeof( color ), "c: 0x%02x%02x%02x%02x", c.r, c.g, c.b, c.a );
+    text += color + headerComment( 'c' ) + '\n';
+    text += "b: " + std::to_string( metadata.backgroundTextureId ) + headerComment( 'b' ) + '\n';
+    text += "t: " + std::to_string( metadata.tileSetId ) + headerComment( 't' ) + '\n';
+    text += "m: " + std::to_string( metadata.musicId ) + headerComment( 'm' ) + '\n';
+    text += "f: " + std::to_string( metadata.timeToFinish ) + headerComment( 'f' ) + '\n';
+
+    for ( const auto &message : metadata.messages ) {
+        text += "h: " + message + '\n';
+    }
+
+    const int firstGridLine = static_cast<int>( metadata.comments.size() + metadata.messages.size() ) + 6;
+
+    for ( int i = 0; i < lines; i++ ) {
+
+        const size_t rowStart = text.size();
+        text.append( columns, ' ' );
+        char *row = text.data() + rowStart;
+
+        for ( int j = 0; j < columns; j++ ) {
+
+            for ( int k = static_cast<int>( layers.size() ) - 1; k >= 0; k-- ) {
+
+                const TileLayer &layer = layers[k];
+                const int p = layer.getIndex( i, j );
+
+                if ( layer.getTileId( p ) == TileLayer::EMPTY_TILE ) {
+                    continue;
+                }
+
+                char glyph = getCellGlyph( layer, p, paletteGlyphs );
+
+                if ( glyph == 0 ) {
+                    addError( errors, firstGridLine + i, j + 1, "tile has no glyph in the map format" );
+                    glyph = ' ';
+                }
+
+                row[j] = glyph;
+                break;
+
+            }
+
+        }
+
+        if ( i < lines - 1 ) {
+            text += '\n';
+        }
+
+    }
+
+    return text;
+
+}
+
+/**
+ * Returns the glyph of a cell, ' ' when it is empty or 0 when its tile has
+ * no glyph in the map format.
+ */
+char MapFile::getCellGlyph( const TileLayer &layer, int index, const std::vector<char> &paletteGlyphs ) {
+
+    const uint16_t tileId = layer.getTileId( index );
+
+    if ( tileId == TileLayer::EMPTY_TILE ) {
+        return ' ';
+    }
+
+    const char glyph = tileId < paletteGlyphs.size() ? paletteGlyphs[tileId] : 0;
+
+    if ( glyph == COLORED_TILE ) {
+        if ( layer.isVisible( index ) ) {
+            return 0;
+        }
+        return layer.getCollisionType( index ) == TileCollisionType::solid_only_for_baddies ? '|' : '/';
+    }
+
+    return glyph;
+
+}
+
+MapGlyphDecoder::MapGlyphDecoder( const MapFile::GlyphResolver &resolver, int tileSetId )
+    :
+    resolver( resolver ),
+    tileSetId( tileSetId ) {
+    resolved.fill( -1 );
+}
+
+/**
+ * Returns an empty string when the cell was set (or the glyph is a space),
+ * or the error message otherwise.
+ */
+std::string MapGlyphDecoder::setCell( TileLayer &layer, int index, unsigned char glyph ) {
+
+    uint16_t tileId;
+    const std::string error = resolve( glyph, tileId );
+
+    if ( tileId != TileLayer::EMPTY_TILE ) {
+        const MapGlyph &info = MapFile::getGlyphTable()[glyph];
+        layer.setTile( index, tileId, info.collisionType, info.type != MapGlyphType::invisible );
+    }
+
+    return error;
+
+}
+
+/**
+ * Sets tileId to the palette index of the glyph, EMPTY_TILE when it has
+ * none, and returns the error message, if any. Unknown printable glyphs
+ * are reported but still resolved, so the resolver may keep them and a
+ * save writes them back; control and non ASCII bytes are dropped.
+ */
+std::string MapGlyphDecoder::resolve( unsigned char glyph, uint16_t &tileId ) {
+
+    tileId = TileLayer::EMPTY_TILE;
+
+    if ( glyph == ' ' ) {
+        return std::string();
+    }
+
+    const auto &table = MapFile::getGlyphTable();
+    const bool printable = glyph > ' ' && glyph < 127;
+
+    if ( !printable ) {
+        return std::string( "unknown glyph '" ) + static_cast<char>( glyph ) + '\'';
+    }
+
+    int &resolvedId = resolved[glyph];
+    const bool firstUse = resolvedId == -1;
+
+    if ( firstUse ) {
+        resolvedId = resolver( static_cast<char>( glyph ), table[glyph], MapFile::getTextureKey( static_cast<char>( glyph ), tileSetId ) );
+    }
+
+    tileId = static_cast<uint16_t>( resolvedId );
+
+    if ( table[glyph].type == MapGlyphType::undefined ) {
+        return std::string( "unknown glyph '" ) + static_cast<char>( glyph ) + '\'';
+    }
+
+    if ( tileId == TileLayer::EMPTY_TILE ) {
+        // reported only once per glyph
+        return firstUse ? std::string( "no image for glyph '" ) + static_cast<char>( glyph ) + '\'' : std::string();
+    }
+
+    return std::string();
+
+}
+
+uint16_t MapFile::resolveGlyphAsIndex( char glyph, const MapGlyph &info, const std::string &textureKey ) {
+    return static_cast<uint16_t>( static_cast<unsigned char>( glyph ) );
+}
+
+/**
+ * Palette glyphs matching resolveGlyphAsIndex: each glyph is its own
+ * palette index.
+ */
+const std::vector<char> &MapFile::getGlyphIndexPalette() {
+    static const std::vector<char> glyphs = [] {
+        std::vector<char> g( 128, 0 );
+        for ( int i = 1; i < 128; i++ ) {
+            g[i] = static_cast<char>( i );
+        }
+        return g;
+    }();
+    return glyphs;
+}
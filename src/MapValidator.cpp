@@ -0,0 +1,151 @@
+/**
+ * @file MapValidator.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief MapValidator class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <string>
+#include <vector>
+
+#include "MapFile.h"
+#include "MapValidator.h"
+#include "TileLayer.h"
+
+static void addError( std::vector<MapError> &errors, int line, int column, const std::string &message ) {
+    errors.push_back( MapError( line, column, message ) );
+}
+
+static void checkRange( const MapMetadata &metadata, char key, int value, int min, int max, std::vector<MapError> &errors ) {
+    if ( value < min || value > max ) {
+        const auto it = metadata.headerLines.find( key );
+        addError( errors, it != metadata.headerLines.end() ? it->second : 0, 4,
+                  std::string( 1, key ) + ": " + std::to_string( value ) + " is out of range [" +
+                  std::to_string( min ) + "-" + std::to_string( max ) + "]" );
+    }
+}
+
+/**
+ * The layers are merged once into a grid of glyphs, the topmost layer
+ * winning like when the map is written, and every rule is checked on it.
+ */
+bool MapValidator::validate( const MapMetadata &metadata, const std::vector<TileLayer> &layers, std::vector<MapError> &errors ) {
+
+    const size_t initialErrors = errors.size();
+
+    checkRange( metadata, 'b', metadata.backgroundTextureId, 1, 10, errors );
+    checkRange( metadata, 'm', metadata.musicId, 1, 9, errors );
+    checkRange( metadata, 't', metadata.tileSetId, 1, 4, errors );
+
+    const int lines = layers.empty() ? 0 : layers[0].getLines();
+    const int columns = layers.empty() ? 0 : layers[0].getColumns();
+    const int firstLine = metadata.firstGridLine;
+    const std::vector<char> &palette = MapFile::getGlyphIndexPalette();
+
+    std::string grid( static_cast<size_t>( lines ) * columns, ' ' );
+
+    for ( int i = 0; i < lines; i++ ) {
+        for ( int j = 0; j < columns; j++ ) {
+            for ( int k = static_cast<int>( layers.size() ) - 1; k >= 0; k-- ) {
+                const int p = layers[k].getIndex( i, j );
+                if ( layers[k].getTileId( p ) != TileLayer::EMPTY_TILE ) {
+                    grid[i * columns + j] = MapFile::getCellGlyph( layers[k], p, palette );
+                    break;
+                }
+            }
+        }
+    }
+
+    const auto at = [&]( int i, int j ) -> char {
+        return i >= 0 && i < lines && j >= 0 && j < columns ? grid[i * columns + j] : ' ';
+    };
+
+    if ( lines == 0 || columns == 0 ) {
+        addError( errors, firstLine, 1, "the map is empty" );
+        return false;
+    }
+
+    // framing: the whole top line and both sides
+    int unframedTop = 0;
+    for ( int j = 0; j < columns; j++ ) {
+        if ( at( 0, j ) != '/' && unframedTop++ == 0 ) {
+            addError( errors, firstLine, j + 1, "the top line must be framed with '/'" );
+        }
+    }
+
+    for ( int i = 0; i < lines; i++ ) {
+        if ( at( i, 0 ) != '/' ) {
+            addError( errors, firstLine + i, 1, "the left side must be framed with '/'" );
+        }
+        if ( at( i, columns - 1 ) != '/' ) {
+            addError( errors, firstLine + i, columns, "the right side must be framed with '/'" );
+        }
+    }
+
+    // Mario start
+    int marioCount = 0;
+    for ( int i = 0; i < lines; i++ ) {
+        for ( int j = 0; j < columns; j++ ) {
+            if ( at( i, j ) == 'p' && marioCount++ > 0 ) {
+                addError( errors, firstLine + i, j + 1, "more than one Mario start (p)" );
+            }
+        }
+    }
+
+    if ( marioCount == 0 ) {
+        addError( errors, firstLine, 1, "no Mario start (p)" );
+    }
+
+    // course clear poles: {?} on top of [ ] columns of the same height
+    std::vector<bool> poleCells( grid.size(), false );
+
+    for ( int i = 0; i < lines; i++ ) {
+        for ( int j = 0; j < columns; j++ ) {
+
+            if ( at( i, j ) != '{' ) {
+                continue;
+            }
+
+            if ( at( i, j + 2 ) != '}' ) {
+                addError( errors, firstLine + i, j + 1, "course clear pole back top '{' without its front top '}' two columns to the right" );
+                continue;
+            }
+
+            int back = 0;
+            while ( at( i + 1 + back, j ) == '[' ) {
+                back++;
+            }
+            int front = 0;
+            while ( at( i + 1 + front, j + 2 ) == ']' ) {
+                front++;
+            }
+
+            if ( back == 0 || back != front ) {
+                addError( errors, firstLine + i, j + 1, "course clear pole bodies do not match (" +
+                          std::to_string( back ) + " '[' and " + std::to_string( front ) + " ']')" );
+            }
+
+            poleCells[i * columns + j] = true;
+            poleCells[i * columns + j + 2] = true;
+            for ( int k = 1; k <= back; k++ ) {
+                poleCells[( i + k ) * columns + j] = true;
+            }
+            for ( int k = 1; k <= front; k++ ) {
+                poleCells[( i + k ) * columns + j + 2] = true;
+            }
+
+        }
+    }
+
+    for ( int i = 0; i < lines; i++ ) {
+        for ( int j = 0; j < columns; j++ ) {
+            const char glyph = at( i, j );
+            if ( ( glyph == '}' || glyph == '[' || glyph == ']' ) && !poleCells[i * columns + j] ) {
+                addError( errors, firstLine + i, j + 1, std::string( "course clear pole piece '" ) + glyph + "' outside of a pole" );
+            }
+        }
+    }
+
+    return errors.size() == initialErrors;
+
+}
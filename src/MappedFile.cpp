@@ -0,0 +1,143 @@
+/**
+ * @file MappedFile.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief MappedFile class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <cstddef>
+#include <string>
+
+#include "MappedFile.h"
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    :
+    data( nullptr ),
+    size( 0 )
+#if defined( _WIN32 )
+    ,
+    fileHandle( nullptr ),
+    mappingHandle( nullptr )
+#endif
+    {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#if defined( _WIN32 )
+
+bool MappedFile::open( const std::string &path ) {
+
+    close();
+
+    // FILE_SHARE_DELETE lets a writer rename the file while it is mapped
+    HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    if ( file == INVALID_HANDLE_VALUE ) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if ( !GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart == 0 ) {
+        CloseHandle( file );
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( mapping == nullptr ) {
+        CloseHandle( file );
+        return false;
+    }
+
+    const void *view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+    if ( view == nullptr ) {
+        CloseHandle( mapping );
+        CloseHandle( file );
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const unsigned char*>( view );
+    size = static_cast<size_t>( fileSize.QuadPart );
+
+    return true;
+
+}
+
+void MappedFile::close() {
+    if ( data != nullptr ) {
+        UnmapViewOfFile( data );
+        CloseHandle( mappingHandle );
+        CloseHandle( fileHandle );
+    }
+    data = nullptr;
+    size = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open( const std::string &path ) {
+
+    close();
+
+    const int fd = ::open( path.c_str(), O_RDONLY );
+    if ( fd == -1 ) {
+        return false;
+    }
+
+    struct stat st;
+    if ( fstat( fd, &st ) == -1 || st.st_size == 0 ) {
+        ::close( fd );
+        return false;
+    }
+
+    void *view = mmap( nullptr, static_cast<size_t>( st.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );  // the mapping keeps the file referenced
+
+    if ( view == MAP_FAILED ) {
+        return false;
+    }
+
+    data = static_cast<const unsigned char*>( view );
+    size = static_cast<size_t>( st.st_size );
+
+    return true;
+
+}
+
+void MappedFile::close() {
+    if ( data != nullptr ) {
+        munmap( const_cast<unsigned char*>( data ), size );
+    }
+    data = nullptr;
+    size = 0;
+}
+
+#endif
+
+bool MappedFile::isOpen() const {
+    return data != nullptr;
+}
+
+const unsigned char *MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
@@ -6,9 +6,19 @@
  * @copyright Copyright (c) 2024
  */
 #include "raylib.h"
+#include "AssetManifest.h"
+#include "AssetWatcher.h"
+#include "RresArchive.h"
 #include "ResourceManager.h"
+#include "ResourceRegistry.h"
+#include "TextureAtlas.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <map>
-#include <sstream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utils.h>
 #include <vector>
@@ -18,236 +28,665 @@
 #define RRES_RAYLIB_IMPLEMENTATION
 #include "rres-raylib.h"
 
-std::map<std::string, Texture2D> ResourceManager::textures;
-std::map<std::string, Sound> ResourceManager::sounds;
-std::map<std::string, Music> ResourceManager::musics;
-std::vector<void*> ResourceManager::musicDataStreamDataPointers;
+ResourceRegistry<Texture2D> ResourceManager::textures;
+ResourceRegistry<Sound> ResourceManager::sounds;
+ResourceRegistry<Music> ResourceManager::musics;
+TextureAtlas ResourceManager::atlas( 1024, 2 );
+
+std::string ResourceManager::archiveLocation = "resources/resources.rres";
+RresArchive ResourceManager::archive;
+std::atomic<bool> ResourceManager::archiveChanged( false );
+
+AssetWatcher ResourceManager::watcher;
+std::map<std::string, ResourceManager::ReloadTarget> ResourceManager::reloadTargets;
+std::mutex ResourceManager::reloadedImagesMutex;
+std::vector<ResourceManager::ReloadedImage> ResourceManager::reloadedImages;
+unsigned int ResourceManager::assetRevision = 0;
+std::vector<ResourceManager::ImageRequest> ResourceManager::imageRequests;
+
+std::map<int, ResourceManager::LazyResource> ResourceManager::lazyTextures;
+std::map<int, ResourceManager::LazyResource> ResourceManager::lazyMusics;
+unsigned long long ResourceManager::lazyUseCount = 0;
+std::unique_ptr<ThreadPool> ResourceManager::loader;
+std::mutex ResourceManager::loadedResourcesMutex;
+std::vector<ResourceManager::LoadedResource> ResourceManager::loadedResources;
+
+Image ResourceManager::loadImageFromResource( const std::string& fileName ) {
+
+    Image image{};
+    const unsigned int id = archive.getResourceId( fileName );
+    RresArchive::RawData data;
+
+    if ( archive.getRawData( id, data ) ) {
+        image = LoadImageFromMemory( data.extension.c_str(), data.bytes, static_cast<int>( data.size ) );
+        MemFree( data.buffer );
+    } else {
+        // packed as pixel data or encrypted
+        rresResourceChunk chunk = archive.loadChunk( id );
+        if ( UnpackResourceChunk( &chunk ) == 0 ) {
+            image = LoadImageFromResource( chunk );
+        }
+        rresUnloadResourceChunk( chunk );
+    }
 
-std::string ResourceManager::centralDirLocation = "resources/resources.rres";
-rresCentralDir ResourceManager::centralDir = rresLoadCentralDirectory( centralDirLocation.c_str() );
+    return image;
 
-void ResourceManager::loadTextureFromResource(
-    const std::string& fileName,
-    const std::string& textureKey ) {
+}
 
-    const unsigned int id = rresGetResourceId( centralDir, fileName.c_str() );
-    rresResourceChunk chunk = rresLoadResourceChunk( centralDirLocation.c_str(), id );
-    const int result = UnpackResourceChunk( &chunk );
+void ResourceManager::addAtlasImage( const std::string& key, const std::string& path, const std::string& flippedKey ) {
 
-    if ( result == 0 ) {
-        const Image image = LoadImageFromResource( chunk );
-        textures[textureKey] = LoadTextureFromImage( image );
-        UnloadImage( image );
+    imageRequests.push_back( ImageRequest( key, path, flippedKey, {}, 0.0 ) );
+    reloadTargets[path] = ReloadTarget( key, true );
+
+}
+
+/**
+ * Runs on a pool worker: reads and decodes one requested image. Only CPU
+ * memory is touched here, the GL context
+ * belongs to the main thread.
+ */
+void ResourceManager::decodeRequestedImage( ImageRequest& request ) {
+
+    const auto start = std::chrono::steady_clock::now();
+
+    request.image = loadFromRRES ? loadImageFromResource( request.path ) : LoadImage( request.path.c_str() );
+
+    if ( request.image.data != nullptr ) {
+        ImageFormat( &request.image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 );
     }
 
-    rresUnloadResourceChunk( chunk );
+    request.milliseconds = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
 
 }
 
-void ResourceManager::loadSoundFromResource(
-    const std::string& fileName,
-    const std::string& soundKey ) {
+/**
+ * Decodes every queued image on a thread pool, then uploads them on the
+ * main thread in the order they were queued, so the atlas layout does not
+ * depend on which worker finished first. The images are uploaded in one
+ * batch per page by atlas.build().
+ */
+void ResourceManager::loadRequestedImages() {
 
-    const unsigned int id = rresGetResourceId( centralDir, fileName.c_str() );
-    rresResourceChunk chunk = rresLoadResourceChunk( centralDirLocation.c_str(), id );
-    const int result = UnpackResourceChunk( &chunk );
+    const auto start = std::chrono::steady_clock::now();
+    int threadCount;
 
-    if ( result == 0 ) {
-        const Wave wave = LoadWaveFromResource( chunk );
-        sounds[soundKey] = LoadSoundFromWave( wave );
-        UnloadWave( wave );
+    {
+        ThreadPool pool;
+        threadCount = pool.getThreadCount();
+        pool.parallelFor( static_cast<int>( imageRequests.size() ), []( int i ) {
+            decodeRequestedImage( imageRequests[i] );
+        });
     }
 
-    rresUnloadResourceChunk( chunk );
+    const double decodeWall = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+    double decodeTotal = 0;
 
-}
+    for ( auto &request : imageRequests ) {
 
-void ResourceManager::loadMusicFromResource(
-    const std::string& fileName,
-    const std::string& musicKey ) {
+        decodeTotal += request.milliseconds;
+        TraceLog( LOG_DEBUG, "RESOURCES: [%s] decoded in %.2f ms", request.path.c_str(), request.milliseconds );
+
+        if ( request.image.data == nullptr ) {
+            TraceLog( LOG_WARNING, "RESOURCES: Could not load [%s]", request.path.c_str() );
+            continue;
+        }
+
+        atlas.add( request.key, request.image );
+        if ( !request.flippedKey.empty() ) {
+            atlas.addMirrored( request.flippedKey, request.key );
+        }
 
-    const unsigned int id = rresGetResourceId( centralDir, fileName.c_str() );
-    rresResourceChunk chunk = rresLoadResourceChunk( centralDirLocation.c_str(), id );
-    const int result = UnpackResourceChunk( &chunk );
+    }
 
-    if ( result == 0 ) {
-        unsigned int dataSize = 0;
-        void* data = LoadDataFromResource( chunk, &dataSize );
-        musics[musicKey] = LoadMusicStreamFromMemory( ".mp3", static_cast<unsigned char*>( data ), static_cast<int>( dataSize ) );
-        musicDataStreamDataPointers.push_back( data );
+    std::vector<const ImageRequest*> slowest;
+    for ( const auto &request : imageRequests ) {
+        slowest.push_back( &request );
+    }
+    std::sort( slowest.begin(), slowest.end(), []( const ImageRequest *a, const ImageRequest *b ) {
+        return a->milliseconds > b->milliseconds;
+    });
+
+    TraceLog( LOG_INFO, "RESOURCES: %d images decoded in %.2f ms on %d threads (%.2f ms of decoding)",
+              static_cast<int>( imageRequests.size() ), decodeWall, threadCount, decodeTotal );
+    for ( size_t i = 0; i < slowest.size() && i < 3; i++ ) {
+        TraceLog( LOG_INFO, "RESOURCES:     slowest: [%s] %.2f ms", slowest[i]->path.c_str(), slowest[i]->milliseconds );
     }
 
-    rresUnloadResourceChunk( chunk );
+    imageRequests.clear();
 
 }
 
-void ResourceManager::loadTextures() {
+void ResourceManager::addLazyTexture( const std::string& key, const std::string& path ) {
 
-    if ( textures.empty() ) {
+    lazyTextures[textures.reserve( key )] = LazyResource( key, path, false, false, 0, nullptr );
+    reloadTargets[path] = ReloadTarget( key, false );
 
-        // load textures...
+}
 
-        // mario
-        if ( loadFromRRES ) {
-            loadTextureFromResource( "resources/images/sprites/mario/SmallMario_0.png", "marioR" );
-        } else {
-            textures["marioR"] = LoadTexture( "resources/images/sprites/mario/SmallMario_0.png" );
+void ResourceManager::addLazyMusic( const std::string& key, const std::string& path ) {
+    lazyMusics[musics.reserve( key )] = LazyResource( key, path, false, false, 0, nullptr );
+}
+
+std::map<int, ResourceManager::LazyResource> &ResourceManager::getLazyGroup( LazyGroup group ) {
+    return group == LazyGroup::textures ? lazyTextures : lazyMusics;
+}
+
+bool ResourceManager::isLazyResourceLoaded( LazyGroup group, int handle ) {
+    return group == LazyGroup::textures ? textures.isLoaded( handle ) : musics.isLoaded( handle );
+}
+
+/**
+ * Runs on any thread: images are decoded and music files are read into
+ * memory (or found in the mapped archive), the texture or the stream is
+ * created later by uploadLazyResource on the main thread.
+ */
+ResourceManager::LoadedResource ResourceManager::readLazyResource( LazyGroup group, int handle, const std::string& path ) {
+
+    LoadedResource resource( group, handle, {}, nullptr, nullptr, 0 );
+
+    if ( group == LazyGroup::textures ) {
+        resource.image = loadFromRRES ? loadImageFromResource( path ) : LoadImage( path.c_str() );
+        if ( resource.image.data != nullptr ) {
+            ImageFormat( &resource.image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 );
         }
-        textures["marioL"] = texture2DFlipHorizontal( textures["marioR"] );
-
-
-        // tiles
-        for ( int i = 1; i <= 4; i++ ) {
-            for ( char c = 'A'; c <= 'R'; c++ ) {
-                std::stringstream ss;
-                ss << c << i;
-                if ( loadFromRRES ) {
-                    loadTextureFromResource( TextFormat( "resources/images/tiles/%d/tile_%c.png", i, c ), ss.str() );
-                } else {
-                    textures[ss.str()] = LoadTexture( TextFormat( "resources/images/tiles/%d/tile_%c.png", i, c ) );
-                }
+    } else if ( loadFromRRES ) {
+        const unsigned int id = archive.getResourceId( path );
+        RresArchive::RawData data;
+        if ( archive.getRawData( id, data ) ) {
+            resource.data = data.buffer;
+            resource.bytes = data.bytes;
+            resource.dataSize = data.size;
+        } else {
+            rresResourceChunk chunk = archive.loadChunk( id );
+            if ( UnpackResourceChunk( &chunk ) == 0 ) {
+                resource.data = LoadDataFromResource( chunk, &resource.dataSize );
+                resource.bytes = static_cast<const unsigned char*>( resource.data );
             }
+            rresUnloadResourceChunk( chunk );
         }
+    } else {
+        int dataSize = 0;
+        resource.data = LoadFileData( path.c_str(), &dataSize );
+        resource.bytes = static_cast<const unsigned char*>( resource.data );
+        resource.dataSize = static_cast<unsigned int>( dataSize );
+    }
 
-        // pipes
-        std::vector<std::string> pipeColors = { "blue", "darkgray", "gray", "green", "orange", "pink", "purple", "red", "yellow" };
-        for ( auto const &c : pipeColors ) {
-            for ( int i = 0; i < 4; i++ ) {
-                std::stringstream ss;
-                ss << "pipe_" << c << i;
-                if ( loadFromRRES ) { // will fail! needs to update resource file
-                    loadTextureFromResource( TextFormat( "resources/images/tiles/pipes/%s/tile_%d.png", c.c_str(), i ), ss.str() );
-                } else {
-                    textures[ss.str()] = LoadTexture( TextFormat( "resources/images/tiles/pipes/%s/tile_%d.png", c.c_str(), i ) );
-                }
-            }
-            for ( int i = 0; i < 2; i++ ) {
-                std::stringstream ss;
-                ss << "sm_pipe_" << c << i;
-                if ( loadFromRRES ) { // will fail! needs to update resource file
-                    loadTextureFromResource( TextFormat( "resources/images/tiles/smallPipes/%s/tile_%d.png", c.c_str(), i ), ss.str() );
-                } else {
-                    textures[ss.str()] = LoadTexture( TextFormat( "resources/images/tiles/smallPipes/%s/tile_%d.png", c.c_str(), i ) );
+    return resource;
+
+}
+
+void ResourceManager::releaseLoadedResource( LoadedResource& resource ) {
+    if ( resource.image.data != nullptr ) {
+        UnloadImage( resource.image );
+    }
+    if ( resource.data != nullptr ) {
+        MemFree( resource.data );
+    }
+}
+
+void ResourceManager::uploadLazyResource( LoadedResource& resource ) {
+
+    LazyResource &lazy = getLazyGroup( resource.group ).at( resource.handle );
+    lazy.loading = false;
+
+    if ( isLazyResourceLoaded( resource.group, resource.handle ) ) {
+        releaseLoadedResource( resource );
+        return;
+    }
+
+    if ( resource.image.data == nullptr && resource.bytes == nullptr ) {
+        TraceLog( LOG_WARNING, "RESOURCES: Could not load [%s]", lazy.path.c_str() );
+        lazy.failed = true;
+        return;
+    }
+
+    if ( resource.group == LazyGroup::textures ) {
+        textures.add( lazy.key, LoadTextureFromImage( resource.image ) );
+        UnloadImage( resource.image );
+    } else {
+        // the stream keeps reading from the bytes while it is loaded
+        musics.add( lazy.key, LoadMusicStreamFromMemory( ".mp3", resource.bytes, static_cast<int>( resource.dataSize ) ) );
+        lazy.data = resource.data;
+    }
+
+    TraceLog( LOG_DEBUG, "RESOURCES: [%s] loaded", lazy.path.c_str() );
+    evictLazyResources( resource.group, resource.handle );
+
+}
+
+void ResourceManager::unloadLazyResource( LazyGroup group, int handle ) {
+
+    LazyResource &lazy = getLazyGroup( group ).at( handle );
+
+    if ( group == LazyGroup::textures ) {
+        UnloadTexture( textures.get( handle ) );
+        textures.remove( handle );
+    } else {
+        UnloadMusicStream( musics.get( handle ) );
+        musics.remove( handle );
+        MemFree( lazy.data );
+        lazy.data = nullptr;
+    }
+
+    TraceLog( LOG_DEBUG, "RESOURCES: [%s] evicted", lazy.path.c_str() );
+
+}
+
+/**
+ * Unloads the least recently used resources of the group until it is
+ * within its budget. The one that has just been loaded is kept.
+ */
+void ResourceManager::evictLazyResources( LazyGroup group, int keepHandle ) {
+
+    const int budget = group == LazyGroup::textures ? LAZY_TEXTURE_BUDGET : LAZY_MUSIC_BUDGET;
+    std::map<int, LazyResource> &lazyGroup = getLazyGroup( group );
+
+    while ( true ) {
+
+        int loaded = 0;
+        int oldest = ResourceRegistry<Texture2D>::INVALID_HANDLE;
+
+        for ( const auto &[handle, lazy] : lazyGroup ) {
+            if ( isLazyResourceLoaded( group, handle ) ) {
+                loaded++;
+                if ( handle != keepHandle && ( oldest == ResourceRegistry<Texture2D>::INVALID_HANDLE || lazy.lastUse < lazyGroup.at( oldest ).lastUse ) ) {
+                    oldest = handle;
                 }
             }
         }
 
-        // generic
-        if ( loadFromRRES ) {
-            loadTextureFromResource( "resources/images/tiles/scenario/tile_CourseClearPoleBackTop.png", "tileCourseClearPoleBackTop" );
-            loadTextureFromResource( "resources/images/tiles/scenario/tile_CourseClearPoleBackBody.png", "tileCourseClearPoleBackBody" );
-            loadTextureFromResource( "resources/images/tiles/scenario/tile_CourseClearPoleFrontTop.png", "tileCourseClearPoleFrontTop" );
-            loadTextureFromResource( "resources/images/tiles/scenario/tile_CourseClearPoleFrontBody.png", "tileCourseClearPoleFrontBody" );
-        } else {
-            textures["tileCourseClearPoleBackTop"] = LoadTexture( "resources/images/tiles/scenario/tile_CourseClearPoleBackTop.png" );
-            textures["tileCourseClearPoleBackBody"] = LoadTexture( "resources/images/tiles/scenario/tile_CourseClearPoleBackBody.png" );
-            textures["tileCourseClearPoleFrontTop"] = LoadTexture( "resources/images/tiles/scenario/tile_CourseClearPoleFrontTop.png" );
-            textures["tileCourseClearPoleFrontBody"] = LoadTexture( "resources/images/tiles/scenario/tile_CourseClearPoleFrontBody.png" );
+        if ( loaded <= budget || oldest == ResourceRegistry<Texture2D>::INVALID_HANDLE ) {
+            return;
         }
 
-        // blocks (editor)
-        for ( int i = 0; i < 15; i++ ) {
-            std::stringstream ss;
-            ss << "block" << i;
-            if ( loadFromRRES ) {
-                loadTextureFromResource( TextFormat( "resources/images/sprites/blocks/block%d.png", i ), ss.str() );
-            } else {
-                textures[ss.str()] = LoadTexture( TextFormat( "resources/images/sprites/blocks/block%d.png", i ) );
+        unloadLazyResource( group, oldest );
+
+    }
+
+}
+
+/**
+ * Loads the resource on the calling (main) thread if it is not loaded yet,
+ * a prefetch still running for it is then discarded when it arrives.
+ */
+void ResourceManager::useLazyResource( LazyGroup group, int handle ) {
+
+    std::map<int, LazyResource> &lazyGroup = getLazyGroup( group );
+    const auto it = lazyGroup.find( handle );
+
+    if ( it == lazyGroup.end() ) {
+        return;
+    }
+
+    it->second.lastUse = ++lazyUseCount;
+
+    if ( !it->second.failed && !isLazyResourceLoaded( group, handle ) ) {
+        LoadedResource resource = readLazyResource( group, handle, it->second.path );
+        uploadLazyResource( resource );
+    }
+
+}
+
+void ResourceManager::prefetchLazyResource( LazyGroup group, int handle ) {
+
+    std::map<int, LazyResource> &lazyGroup = getLazyGroup( group );
+    const auto it = lazyGroup.find( handle );
+
+    if ( it == lazyGroup.end() || loader == nullptr ) {
+        return;
+    }
+
+    LazyResource &lazy = it->second;
+    lazy.lastUse = ++lazyUseCount;
+
+    if ( lazy.loading || lazy.failed || isLazyResourceLoaded( group, handle ) ) {
+        return;
+    }
+
+    lazy.loading = true;
+    loader->submit( [group, handle, path = lazy.path] {
+        LoadedResource resource = readLazyResource( group, handle, path );
+        std::lock_guard<std::mutex> lock( loadedResourcesMutex );
+        loadedResources.push_back( resource );
+    });
+
+}
+
+const Texture2D &ResourceManager::useTexture( int handle ) {
+    useLazyResource( LazyGroup::textures, handle );
+    return textures.get( handle );
+}
+
+const Music &ResourceManager::useMusic( int handle ) {
+    useLazyResource( LazyGroup::musics, handle );
+    return musics.get( handle );
+}
+
+void ResourceManager::prefetchTexture( int handle ) {
+    prefetchLazyResource( LazyGroup::textures, handle );
+}
+
+void ResourceManager::prefetchMusic( int handle ) {
+    prefetchLazyResource( LazyGroup::musics, handle );
+}
+
+/**
+ * Called once per frame, uploads what the loader has read since.
+ */
+void ResourceManager::applyPrefetchedResources() {
+
+    std::vector<LoadedResource> resources;
+
+    {
+        std::lock_guard<std::mutex> lock( loadedResourcesMutex );
+        if ( loadedResources.empty() ) {
+            return;
+        }
+        resources.swap( loadedResources );
+    }
+
+    for ( auto &resource : resources ) {
+        uploadLazyResource( resource );
+    }
+
+}
+
+void ResourceManager::discardPrefetchedResources() {
+    std::lock_guard<std::mutex> lock( loadedResourcesMutex );
+    for ( auto &resource : loadedResources ) {
+        releaseLoadedResource( resource );
+    }
+    loadedResources.clear();
+}
+
+/**
+ * Runs on the watcher thread, the archive is reopened on the main thread.
+ */
+void ResourceManager::onArchiveChanged( const std::string& path ) {
+    if ( path == archiveLocation ) {
+        archiveChanged = true;
+    }
+}
+
+/**
+ * Maps the archive again after it has been rebuilt. Nothing may still read
+ * from the old mapping: the loader is drained, backgrounds and musics are
+ * unloaded (they come back from the new archive when used) and the atlas
+ * images are decoded again and rewritten in place.
+ */
+void ResourceManager::reloadArchive() {
+
+    loader->wait();
+    discardPrefetchedResources();
+
+    for ( LazyGroup group : { LazyGroup::textures, LazyGroup::musics } ) {
+        for ( auto &[handle, lazy] : getLazyGroup( group ) ) {
+            if ( isLazyResourceLoaded( group, handle ) ) {
+                unloadLazyResource( group, handle );
             }
+            lazy.loading = false;
+            lazy.failed = false;
         }
+    }
 
-        // tools
-        if ( loadFromRRES ) {
-            loadTextureFromResource( "resources/images/sprites/blocks/selectTool.png", "selectBlock" );
-        } else {
-            textures["selectBlock"] = LoadTexture( "resources/images/sprites/blocks/selectTool.png" );
+    if ( !archive.reload() ) {
+        return;
+    }
+
+    for ( const auto &[path, target] : reloadTargets ) {
+        if ( target.inAtlas ) {
+            imageRequests.push_back( ImageRequest( target.key, path, "", {}, 0.0 ) );
         }
+    }
 
-        // backgrounds
-        if ( loadFromRRES ) {
-            loadTextureFromResource( "resources/images/backgrounds/background1.png", "background1" );
-            loadTextureFromResource( "resources/images/backgrounds/background2.png", "background2" );
-            loadTextureFromResource( "resources/images/backgrounds/background3.png", "background3" );
-            loadTextureFromResource( "resources/images/backgrounds/background4.png", "background4" );
-            loadTextureFromResource( "resources/images/backgrounds/background5.png", "background5" );
-            loadTextureFromResource( "resources/images/backgrounds/background6.png", "background6" );
-            loadTextureFromResource( "resources/images/backgrounds/background7.png", "background7" );
-            loadTextureFromResource( "resources/images/backgrounds/background8.png", "background8" );
-            loadTextureFromResource( "resources/images/backgrounds/background9.png", "background9" );
-            loadTextureFromResource( "resources/images/backgrounds/background10.png", "background10" );
-        } else {
-            textures["background1"] = LoadTexture( "resources/images/backgrounds/background1.png" );
-            textures["background2"] = LoadTexture( "resources/images/backgrounds/background2.png" );
-            textures["background3"] = LoadTexture( "resources/images/backgrounds/background3.png" );
-            textures["background4"] = LoadTexture( "resources/images/backgrounds/background4.png" );
-            textures["background5"] = LoadTexture( "resources/images/backgrounds/background5.png" );
-            textures["background6"] = LoadTexture( "resources/images/backgrounds/background6.png" );
-            textures["background7"] = LoadTexture( "resources/images/backgrounds/background7.png" );
-            textures["background8"] = LoadTexture( "resources/images/backgrounds/background8.png" );
-            textures["background9"] = LoadTexture( "resources/images/backgrounds/background9.png" );
-            textures["background10"] = LoadTexture( "resources/images/backgrounds/background10.png" );
+    {
+        ThreadPool pool;
+        pool.parallelFor( static_cast<int>( imageRequests.size() ), []( int i ) {
+            decodeRequestedImage( imageRequests[i] );
+        });
+    }
+
+    for ( auto &request : imageRequests ) {
+        if ( request.image.data != nullptr ) {
+            atlas.update( atlas.getHandle( request.key ), request.image );
+            UnloadImage( request.image );
         }
+    }
 
-        // items
-        if ( loadFromRRES ) {
-            loadTextureFromResource( "resources/images/sprites/items/coin.png", "coin" );
-            loadTextureFromResource( "resources/images/sprites/items/yoshiCoin.png", "yoshiCoin" );
-        } else {
-            textures["coin"] = LoadTexture( "resources/images/sprites/items/coin.png" );
-            textures["yoshiCoin"] = LoadTexture( "resources/images/sprites/items/yoshiCoin.png" );
+    imageRequests.clear();
+    assetRevision++;
+    TraceLog( LOG_INFO, "RESOURCES: [%s] reloaded", archiveLocation.c_str() );
+
+}
+
+/**
+ * Runs on the watcher thread: the file is decoded here, leaving only the
+ * upload to the main thread. reloadTargets is not changed while the watcher runs.
+ */
+void ResourceManager::decodeChangedImage( const std::string& path ) {
+
+    const auto it = reloadTargets.find( path );
+
+    if ( it == reloadTargets.end() ) {
+        return;
+    }
+
+    Image image = LoadImage( path.c_str() );
+
+    if ( image.data == nullptr ) {
+        TraceLog( LOG_WARNING, "RESOURCES: Could not reload [%s]", path.c_str() );
+        return;
+    }
+
+    ImageFormat( &image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 );
+
+    std::lock_guard<std::mutex> lock( reloadedImagesMutex );
+    reloadedImages.push_back( ReloadedImage( path, image ) );
+
+}
+
+/**
+ * Called once per frame. Atlas images are rewritten in their pages (their
+ * mirrored variants read the same pixels) and
+ * backgrounds get a new texture in the same registry slot, so the handles
+ * and texture pointers held by the editor keep working. Bumping the asset
+ * revision tells cached drawings to redraw.
+ */
+void ResourceManager::applyReloadedImages() {
+
+    if ( archiveChanged.exchange( false ) ) {
+        reloadArchive();
+    }
+
+    std::vector<ReloadedImage> images;
+
+    {
+        std::lock_guard<std::mutex> lock( reloadedImagesMutex );
+        if ( reloadedImages.empty() ) {
+            return;
         }
+        images.swap( reloadedImages );
+    }
 
-        if ( loadFromRRES ) {
-            loadTextureFromResource( "resources/images/sprites/baddies/BlueKoopaTroopa_0.png", "blueKoopaTroopaR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/BobOmb_0.png", "bobOmbR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/BulletBill_0.png", "bulletBillR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/BuzzyBeetle_0.png", "buzzyBeetleR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/FlyingGoomba_0.png", "flyingGoombaR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/Goomba_0.png", "goombaR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/GreenKoopaTroopa_0.png", "greenKoopaTroopaR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/MummyBeetle_0.png", "mummyBeetleR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/Muncher_0.png", "muncher" );
-            loadTextureFromResource( "resources/images/sprites/baddies/PiranhaPlant_0.png", "piranhaPlant" );
-            loadTextureFromResource( "resources/images/sprites/baddies/RedKoopaTroopa_0.png", "redKoopaTroopaR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/Rex_2_0.png", "rexR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/Swooper_1.png", "swooperR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/YellowKoopaTroopa_0.png", "yellowKoopaTroopaR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/MontyMole_0.png", "montyMoleR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/BanzaiBill_0.png", "banzaiBillR" );
-            loadTextureFromResource( "resources/images/sprites/baddies/JumpingPiranhaPlant_0.png", "jumpingPiranhaPlant" );
+    for ( auto &[path, image] : images ) {
+
+        const ReloadTarget &target = reloadTargets.at( path );
+        bool updated = false;
+
+        if ( target.inAtlas ) {
+            updated = atlas.update( atlas.getHandle( target.key ), image );
         } else {
-            textures["blueKoopaTroopaR"] = LoadTexture( "resources/images/sprites/baddies/BlueKoopaTroopa_0.png" );
-            textures["bobOmbR"] = LoadTexture( "resources/images/sprites/baddies/BobOmb_0.png" );
-            textures["bulletBillR"] = LoadTexture( "resources/images/sprites/baddies/BulletBill_0.png" );
-            textures["buzzyBeetleR"] = LoadTexture( "resources/images/sprites/baddies/BuzzyBeetle_0.png" );
-            textures["flyingGoombaR"] = LoadTexture( "resources/images/sprites/baddies/FlyingGoomba_0.png" );
-            textures["goombaR"] = LoadTexture( "resources/images/sprites/baddies/Goomba_0.png" );
-            textures["greenKoopaTroopaR"] = LoadTexture( "resources/images/sprites/baddies/GreenKoopaTroopa_0.png" );
-            textures["mummyBeetleR"] = LoadTexture( "resources/images/sprites/baddies/MummyBeetle_0.png" );
-            textures["muncher"] = LoadTexture( "resources/images/sprites/baddies/Muncher_0.png" );
-            textures["piranhaPlant"] = LoadTexture( "resources/images/sprites/baddies/PiranhaPlant_0.png" );
-            textures["redKoopaTroopaR"] = LoadTexture( "resources/images/sprites/baddies/RedKoopaTroopa_0.png" );
-            textures["rexR"] = LoadTexture( "resources/images/sprites/baddies/Rex_2_0.png" );
-            textures["swooperR"] = LoadTexture( "resources/images/sprites/baddies/Swooper_1.png" );
-            textures["yellowKoopaTroopaR"] = LoadTexture( "resources/images/sprites/baddies/YellowKoopaTroopa_0.png" );
-            textures["montyMoleR"] = LoadTexture( "resources/images/sprites/baddies/MontyMole_0.png" );
-            textures["banzaiBillR"] = LoadTexture( "resources/images/sprites/baddies/BanzaiBill_0.png" );
-            textures["jumpingPiranhaPlant"] = LoadTexture( "resources/images/sprites/baddies/JumpingPiranhaPlant_0.png" );
+            // an evicted background is read again from disk when it is used
+            const int handle = textures.getHandle( target.key );
+            if ( textures.isLoaded( handle ) ) {
+                UnloadTexture( textures.get( handle ) );
+                textures.add( target.key, LoadTextureFromImage( image ) );
+                updated = true;
+            }
+        }
+
+        UnloadImage( image );
+
+        if ( updated ) {
+            assetRevision++;
+            TraceLog( LOG_INFO, "RESOURCES: [%s] reloaded", path.c_str() );
+        }
+
+    }
+
+}
+
+void ResourceManager::discardReloadedImages() {
+    std::lock_guard<std::mutex> lock( reloadedImagesMutex );
+    for ( auto &reloaded : reloadedImages ) {
+        UnloadImage( reloaded.image );
+    }
+    reloadedImages.clear();
+}
+
+unsigned int ResourceManager::getAssetRevision() {
+    return assetRevision;
+}
+
+void ResourceManager::loadSoundFromResource(
+    const std::string& fileName,
+    const std::string& soundKey ) {
+
+    const unsigned int id = archive.getResourceId( fileName );
+    RresArchive::RawData data;
+    Wave wave{};
+
+    if ( archive.getRawData( id, data ) ) {
+        wave = LoadWaveFromMemory( data.extension.c_str(), data.bytes, static_cast<int>( data.size ) );
+        MemFree( data.buffer );
+    } else {
+        rresResourceChunk chunk = archive.loadChunk( id );
+        if ( UnpackResourceChunk( &chunk ) == 0 ) {
+            wave = LoadWaveFromResource( chunk );
+        }
+        rresUnloadResourceChunk( chunk );
+    }
+
+    if ( wave.data != nullptr ) {
+        sounds.add( soundKey, LoadSoundFromWave( wave ) );
+        UnloadWave( wave );
+    }
+
+}
+
+/**
+ * The part of a manifest path between directory and extension, or an
+ * empty string when the path is not under directory or has another
+ * extension.
+ */
+static std::string getAssetName( const std::string& path, const std::string& directory, const std::string& extension ) {
+    if ( path.size() <= directory.size() + extension.size() || !path.starts_with( directory ) || !path.ends_with( extension ) ) {
+        return "";
+    }
+    return path.substr( directory.size(), path.size() - directory.size() - extension.size() );
+}
+
+/**
+ * Atlas key of a tile image, derived from its place in
+ * resources/images/tiles: 1/tile_A is "A1", pipes/green/tile_0 is
+ * "pipe_green0", smallPipes/green/tile_0 is "sm_pipe_green0" and
+ * scenario/tile_X is "tileX". Empty for anything else.
+ */
+static std::string getTileKey( const std::string& path ) {
+
+    const std::string name = getAssetName( path, "resources/images/tiles/", ".png" );
+    const size_t separator = name.rfind( "/tile_" );
+
+    if ( separator == std::string::npos ) {
+        return "";
+    }
+
+    const std::string folder = name.substr( 0, separator );
+    const std::string tile = name.substr( separator + 6 );
+
+    if ( folder.starts_with( "pipes/" ) ) {
+        return "pipe_" + folder.substr( 6 ) + tile;
+    } else if ( folder.starts_with( "smallPipes/" ) ) {
+        return "sm_pipe_" + folder.substr( 11 ) + tile;
+    } else if ( folder == "scenario" ) {
+        return "tile" + tile;
+    } else if ( !folder.empty() && std::all_of( folder.begin(), folder.end(), []( char c ) { return c >= '0' && c <= '9'; } ) ) {
+        return tile + folder;
+    }
+
+    return "";
+
+}
+
+void ResourceManager::loadTextures() {
+
+    if ( lazyTextures.empty() ) {
+
+        // load textures...
+
+        // sprites and tiles are packed into the atlas, mirrored variants
+        // share the pixels of the image they mirror
+
+        // mario
+        addAtlasImage( "marioR", "resources/images/sprites/mario/SmallMario_0.png", "marioL" );
+
+        // tiles, pipes and scenario tiles
+        for ( const AssetManifestEntry &asset : ASSET_MANIFEST ) {
+            const std::string key = getTileKey( asset.path );
+            if ( !key.empty() ) {
+                addAtlasImage( key, asset.path );
+            }
+        }
+
+        // blocks (editor)
+        for ( const AssetManifestEntry &asset : ASSET_MANIFEST ) {
+            const std::string name = getAssetName( asset.path, "resources/images/sprites/blocks/", ".png" );
+            if ( name.starts_with( "block" ) ) {
+                addAtlasImage( name, asset.path );
+            }
+        }
+
+        // tools
+        addAtlasImage( "selectBlock", "resources/images/sprites/blocks/selectTool.png" );
+
+        // items
+        addAtlasImage( "coin", "resources/images/sprites/items/coin.png" );
+        addAtlasImage( "yoshiCoin", "resources/images/sprites/items/yoshiCoin.png" );
+        addAtlasImage( "courseClearToken", "resources/images/sprites/items/CourseClearToken.png" );
+
+        // baddies
+        addAtlasImage( "blueKoopaTroopaR", "resources/images/sprites/baddies/BlueKoopaTroopa_0.png", "blueKoopaTroopaL" );
+        addAtlasImage( "bobOmbR", "resources/images/sprites/baddies/BobOmb_0.png", "bobOmbL" );
+        addAtlasImage( "bulletBillR", "resources/images/sprites/baddies/BulletBill_0.png", "bulletBillL" );
+        addAtlasImage( "buzzyBeetleR", "resources/images/sprites/baddies/BuzzyBeetle_0.png", "buzzyBeetleL" );
+        addAtlasImage( "flyingGoombaR", "resources/images/sprites/baddies/FlyingGoomba_0.png", "flyingGoombaL" );
+        addAtlasImage( "goombaR", "resources/images/sprites/baddies/Goomba_0.png", "goombaL" );
+        addAtlasImage( "greenKoopaTroopaR", "resources/images/sprites/baddies/GreenKoopaTroopa_0.png", "greenKoopaTroopaL" );
+        addAtlasImage( "mummyBeetleR", "resources/images/sprites/baddies/MummyBeetle_0.png", "mummyBeetleL" );
+        addAtlasImage( "muncher", "resources/images/sprites/baddies/Muncher_0.png" );
+        addAtlasImage( "piranhaPlant", "resources/images/sprites/baddies/PiranhaPlant_0.png" );
+        addAtlasImage( "redKoopaTroopaR", "resources/images/sprites/baddies/RedKoopaTroopa_0.png", "redKoopaTroopaL" );
+        addAtlasImage( "rexR", "resources/images/sprites/baddies/Rex_2_0.png", "rexL" );
+        addAtlasImage( "swooperR", "resources/images/sprites/baddies/Swooper_1.png", "swooperL" );
+        addAtlasImage( "yellowKoopaTroopaR", "resources/images/sprites/baddies/YellowKoopaTroopa_0.png", "yellowKoopaTroopaL" );
+        addAtlasImage( "montyMoleR", "resources/images/sprites/baddies/MontyMole_0.png", "montyMoleL" );
+        addAtlasImage( "banzaiBillR", "resources/images/sprites/baddies/BanzaiBill_0.png", "banzaiBillL" );
+        addAtlasImage( "jumpingPiranhaPlant", "resources/images/sprites/baddies/JumpingPiranhaPlant_0.png" );
+
+        loadRequestedImages();
+
+        // white block used to draw colored tiles from the atlas
+        atlas.add( "white", GenImageColor( 3, 3, WHITE ) );
+
+        atlas.build();
+
+        // backgrounds are loaded the first time they are drawn
+        for ( const AssetManifestEntry &asset : ASSET_MANIFEST ) {
+            const std::string name = getAssetName( asset.path, "resources/images/backgrounds/", ".png" );
+            if ( name.starts_with( "background" ) ) {
+                addLazyTexture( name, asset.path );
+            }
         }
-        textures["blueKoopaTroopaL"] = texture2DFlipHorizontal( textures["blueKoopaTroopaR"] );
-        textures["bobOmbL"] = texture2DFlipHorizontal( textures["bobOmbR"] );
-        textures["bulletBillL"] = texture2DFlipHorizontal( textures["bulletBillR"] );
-        textures["buzzyBeetleL"] = texture2DFlipHorizontal( textures["buzzyBeetleR"] );
-        textures["flyingGoombaL"] = texture2DFlipHorizontal( textures["flyingGoombaR"] );
-        textures["goombaL"] = texture2DFlipHorizontal( textures["goombaR"] );
-        textures["greenKoopaTroopaL"] = texture2DFlipHorizontal( textures["greenKoopaTroopaR"] );
-        textures["mummyBeetleL"] = texture2DFlipHorizontal( textures["mummyBeetleR"] );
-        textures["redKoopaTroopaL"] = texture2DFlipHorizontal( textures["redKoopaTroopaR"] );
-        textures["rexL"] = texture2DFlipHorizontal( textures["rexR"] );
-        textures["swooperL"] = texture2DFlipHorizontal( textures["swooperR"] );
-        textures["yellowKoopaTroopaL"] = texture2DFlipHorizontal( textures["yellowKoopaTroopaR"] );
-        textures["montyMoleL"] = texture2DFlipHorizontal( textures["montyMoleR"] );
-        textures["banzaiBillL"] = texture2DFlipHorizontal( textures["banzaiBillR"] );
 
     }
 
@@ -269,28 +708,14 @@ void ResourceManager::loadSounds() {
 
 void ResourceManager::loadMusics() {
 
-    if ( musics.empty() ) {
+    if ( lazyMusics.empty() ) {
 
-        if ( loadFromRRES ) {
-            loadMusicFromResource( "resources/musics/music1.mp3", "music1" );
-            loadMusicFromResource( "resources/musics/music2.mp3", "music2" );
-            loadMusicFromResource( "resources/musics/music3.mp3", "music3" );
-            loadMusicFromResource( "resources/musics/music4.mp3", "music4" );
-            loadMusicFromResource( "resources/musics/music5.mp3", "music5" );
-            loadMusicFromResource( "resources/musics/music6.mp3", "music6" );
-            loadMusicFromResource( "resources/musics/music7.mp3", "music7" );
-            loadMusicFromResource( "resources/musics/music8.mp3", "music8" );
-            loadMusicFromResource( "resources/musics/music9.mp3", "music9" );
-        } else {
-            musics["music1"] = LoadMusicStream( "resources/musics/music1.mp3" );
-            musics["music2"] = LoadMusicStream( "resources/musics/music2.mp3" );
-            musics["music3"] = LoadMusicStream( "resources/musics/music3.mp3" );
-            musics["music4"] = LoadMusicStream( "resources/musics/music4.mp3" );
-            musics["music5"] = LoadMusicStream( "resources/musics/music5.mp3" );
-            musics["music6"] = LoadMusicStream( "resources/musics/music6.mp3" );
-            musics["music7"] = LoadMusicStream( "resources/musics/music7.mp3" );
-            musics["music8"] = LoadMusicStream( "resources/musics/music8.mp3" );
-            musics["music9"] = LoadMusicStream( "resources/musics/music9.mp3" );
+        // a session plays one track: each one is loaded when it is selected
+        for ( const AssetManifestEntry &asset : ASSET_MANIFEST ) {
+            const std::string name = getAssetName( asset.path, "resources/musics/", ".mp3" );
+            if ( name.starts_with( "music" ) ) {
+                addLazyMusic( name, asset.path );
+            }
         }
 
     }
@@ -299,85 +724,118 @@ void ResourceManager::loadMusics() {
 
 void ResourceManager::loadTexture( const std::string& key, const std::string& path ) {
     unloadTexture( key );
-    textures[key] = LoadTexture( path.c_str() );
+    textures.add( key, LoadTexture( path.c_str() ) );
 }
 
 void ResourceManager::loadSound( const std::string& key, const std::string& path ) {
     unloadSound( key );
-    sounds[key] = LoadSound( path.c_str() );
+    sounds.add( key, LoadSound( path.c_str() ) );
 }
 
 void ResourceManager::loadMusic( const std::string& key, const std::string& path ) {
     unloadMusic( key );
-    musics[key] = LoadMusicStream( path.c_str() );
+    musics.add( key, LoadMusicStream( path.c_str() ) );
 }
 
 void ResourceManager::unloadTextures() {
-    for ( auto const& [key, val] : textures ) {
-        UnloadTexture( val );
+    for ( int i = 0; i < textures.size(); i++ ) {
+        if ( textures.isLoaded( i ) ) {
+            UnloadTexture( textures.get( i ) );
+        }
     }
     textures.clear();
+    lazyTextures.clear();
+    atlas.unload();
 }
 
 void ResourceManager::unloadSounds() {
-    for ( auto const& [key, val] : sounds ) {
-        UnloadSound( val );
+    for ( int i = 0; i < sounds.size(); i++ ) {
+        if ( sounds.isLoaded( i ) ) {
+            UnloadSound( sounds.get( i ) );
+        }
     }
     sounds.clear();
 }
 
 void ResourceManager::unloadMusics() {
-    for ( auto const& [key, val] : musics ) {
-        UnloadMusicStream( val );
+    for ( int i = 0; i < musics.size(); i++ ) {
+        if ( musics.isLoaded( i ) ) {
+            UnloadMusicStream( musics.get( i ) );
+        }
     }
     musics.clear();
+    for ( const auto &[handle, lazy] : lazyMusics ) {
+        if ( lazy.data != nullptr ) {
+            MemFree( lazy.data );
+        }
+    }
+    lazyMusics.clear();
 }
 
 void ResourceManager::unloadTexture( const std::string& key ) {
-    if ( textures.contains( key ) ) {
-        UnloadTexture( textures[key] );
-        textures.erase( key );
+    const int handle = textures.getHandle( key );
+    if ( textures.isLoaded( handle ) ) {
+        UnloadTexture( textures.get( handle ) );
+        textures.remove( handle );
     }
 }
 
 void ResourceManager::unloadSound( const std::string& key ) { 
-    if ( sounds.contains( key ) ) {
-        UnloadSound( sounds[key] );
-        sounds.erase( key );
+    const int handle = sounds.getHandle( key );
+    if ( sounds.isLoaded( handle ) ) {
+        UnloadSound( sounds.get( handle ) );
+        sounds.remove( handle );
     }
 }
 
 void ResourceManager::unloadMusic( const std::string& key ) {
-    if ( musics.contains( key ) ) {
-        UnloadMusicStream( musics[key] );
-        musics.erase( key );
+    const int handle = musics.getHandle( key );
+    if ( musics.isLoaded( handle ) ) {
+        UnloadMusicStream( musics.get( handle ) );
+        musics.remove( handle );
     }
 }
 
 void ResourceManager::loadResources() {
+    if ( loadFromRRES ) {
+        archive.open( archiveLocation );
+    }
     loadTextures();
     loadSounds();
     loadMusics();
-    rresUnloadCentralDirectory( centralDir );
+    loader = std::make_unique<ThreadPool>( 1 );
+    if ( loadFromRRES ) {
+        if ( watcher.start( "resources", ".rres", onArchiveChanged ) ) {
+            TraceLog( LOG_INFO, "RESOURCES: Watching [%s] for changes", archiveLocation.c_str() );
+        }
+    } else if ( watcher.start( "resources/images", ".png", decodeChangedImage ) ) {
+        TraceLog( LOG_INFO, "RESOURCES: Watching [resources/images] for changes" );
+    }
 }
 
 void ResourceManager::unloadResources() {
+    watcher.stop();
+    loader.reset();
+    discardReloadedImages();
+    discardPrefetchedResources();
     unloadTextures();
     unloadSounds();
     unloadMusics();
-    for ( const auto& data : musicDataStreamDataPointers ) {
-        MemFree( data );
-    }
+    archive.close();
 }
 
-std::map<std::string, Texture2D> &ResourceManager::getTextures() {
+ResourceRegistry<Texture2D> &ResourceManager::getTextures() {
     return textures;
 }
 
-std::map<std::string, Sound> &ResourceManager::getSounds() {
+TextureAtlas &ResourceManager::getAtlas() {
+    return atlas;
+}
+
+ResourceRegistry<Sound> &ResourceManager::getSounds() {
     return sounds;
 }
 
-std::map<std::string, Music> &ResourceManager::getMusics() {
+ResourceRegistry<Music> &ResourceManager::getMusics() {
     return musics;
 }
\ No newline at end of file
@@ -0,0 +1,284 @@
+/**
+ * @file RresArchive.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief RresArchive class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "raylib.h"
+#include "RresArchive.h"
+#include "rres.h"
+
+static constexpr size_t HEADER_SIZE = sizeof( rresFileHeader );
+static constexpr size_t CHUNK_INFO_SIZE = sizeof( rresResourceChunkInfo );
+
+// the mapping has no alignment guarantee past the chunk headers
+static unsigned int readU32( const unsigned char *p ) {
+    unsigned int value;
+    std::memcpy( &value, p, sizeof( value ) );
+    return value;
+}
+
+/**
+ * Maps the file and walks its chunk headers once, recording where the
+ * first chunk of each id is. Multi chunk resources are not used by the
+ * editor, the following chunks are reached through nextOffset.
+ */
+bool RresArchive::open( const std::string &path ) {
+
+    close();
+    this->path = path;
+
+    if ( !file.open( path ) ) {
+        TraceLog( LOG_WARNING, "RRES: [%s] could not be mapped", path.c_str() );
+        return false;
+    }
+
+    const unsigned char *data = file.getData();
+    const size_t size = file.getSize();
+
+    rresFileHeader header;
+
+    if ( size < HEADER_SIZE ) {
+        TraceLog( LOG_WARNING, "RRES: [%s] is not a valid rres file", path.c_str() );
+        close();
+        return false;
+    }
+
+    std::memcpy( &header, data, HEADER_SIZE );
+
+    if ( std::memcmp( header.id, "rres", 4 ) != 0 || header.version != 100 ) {
+        TraceLog( LOG_WARNING, "RRES: [%s] is not a valid rres file", path.c_str() );
+        close();
+        return false;
+    }
+
+    size_t offset = HEADER_SIZE;
+
+    for ( int i = 0; i < header.chunkCount; i++ ) {
+
+        rresResourceChunkInfo info;
+
+        if ( offset + CHUNK_INFO_SIZE > size ) {
+            break;
+        }
+
+        std::memcpy( &info, data + offset, CHUNK_INFO_SIZE );
+
+        if ( offset + CHUNK_INFO_SIZE + info.packedSize > size ) {
+            TraceLog( LOG_WARNING, "RRES: [%s] is truncated", path.c_str() );
+            break;
+        }
+
+        if ( rresGetDataType( info.type ) == RRES_DATA_DIRECTORY ) {
+            readCentralDirectory( info, data + offset + CHUNK_INFO_SIZE );
+        } else {
+            chunkOffsets.emplace( info.id, offset );
+        }
+
+        offset += CHUNK_INFO_SIZE + info.packedSize;
+
+    }
+
+    TraceLog( LOG_INFO, "RRES: [%s] mapped, %d resources", path.c_str(), getResourceCount() );
+
+    return true;
+
+}
+
+bool RresArchive::reload() {
+    const std::string reloadedPath = path;
+    return open( reloadedPath );
+}
+
+void RresArchive::close() {
+    file.close();
+    chunkOffsets.clear();
+    resourceIds.clear();
+}
+
+/**
+ * Entries: id, offset, reserved, fileNameSize and the file name, NULL
+ * terminated and padded to fileNameSize.
+ */
+void RresArchive::readCentralDirectory( const rresResourceChunkInfo &info, const unsigned char *packed ) {
+
+    if ( info.compType != RRES_COMP_NONE || info.cipherType != RRES_CIPHER_NONE || info.packedSize < 8 ) {
+        TraceLog( LOG_WARNING, "RRES: [%s] central directory is packed, it can't be read", path.c_str() );
+        return;
+    }
+
+    const unsigned int propCount = readU32( packed );
+    const unsigned char *entry = packed + 4 + propCount * 4;
+    const unsigned char *end = packed + info.packedSize;
+
+    if ( propCount == 0 || entry > end ) {
+        return;
+    }
+
+    const unsigned int count = readU32( packed + 4 );
+
+    for ( unsigned int i = 0; i < count && entry + 16 <= end; i++ ) {
+
+        const unsigned int id = readU32( entry );
+        const unsigned int fileNameSize = readU32( entry + 12 );
+
+        if ( entry + 16 + fileNameSize > end ) {
+            break;
+        }
+
+        const char *fileName = reinterpret_cast<const char*>( entry + 16 );
+        resourceIds[std::string( fileName, strnlen( fileName, fileNameSize ) )] = id;
+        entry += 16 + fileNameSize;
+
+    }
+
+}
+
+bool RresArchive::isOpen() const {
+    return file.isOpen();
+}
+
+int RresArchive::getResourceCount() const {
+    return static_cast<int>( chunkOffsets.size() );
+}
+
+unsigned int RresArchive::getResourceId( const std::string &fileName ) const {
+    const auto it = resourceIds.find( fileName );
+    return it == resourceIds.end() ? 0 : it->second;
+}
+
+/**
+ * The packed data is checked against the chunk CRC32 before it is used.
+ */
+bool RresArchive::readChunkInfo( unsigned int id, rresResourceChunkInfo &info, const unsigned char *&packed ) const {
+
+    const auto it = chunkOffsets.find( id );
+
+    if ( it == chunkOffsets.end() ) {
+        return false;
+    }
+
+    std::memcpy( &info, file.getData() + it->second, CHUNK_INFO_SIZE );
+    packed = file.getData() + it->second + CHUNK_INFO_SIZE;
+
+    if ( rresComputeCRC32( const_cast<unsigned char*>( packed ), static_cast<int>( info.packedSize ) ) != info.crc32 ) {
+        TraceLog( LOG_WARNING, "RRES: [ID %08x] CRC32 does not match, data can be corrupted", id );
+        return false;
+    }
+
+    return true;
+
+}
+
+/**
+ * Only raw chunks that are stored or DEFLATE compressed, without
+ * encryption; anything else must go through loadChunk.
+ */
+bool RresArchive::getRawData( unsigned int id, RawData &data ) const {
+
+    rresResourceChunkInfo info;
+    const unsigned char *packed;
+
+    if ( !readChunkInfo( id, info, packed ) ||
+         rresGetDataType( info.type ) != RRES_DATA_RAW ||
+         info.cipherType != RRES_CIPHER_NONE ) {
+        return false;
+    }
+
+    const unsigned char *unpacked = packed;
+    unsigned int unpackedSize = info.packedSize;
+    unsigned char *buffer = nullptr;
+
+    if ( info.compType == RRES_COMP_DEFLATE ) {
+        int size = 0;
+        buffer = DecompressData( packed, static_cast<int>( info.packedSize ), &size );
+        if ( buffer == nullptr || static_cast<unsigned int>( size ) != info.baseSize ) {
+            MemFree( buffer );
+            return false;
+        }
+        unpacked = buffer;
+        unpackedSize = static_cast<unsigned int>( size );
+    } else if ( info.compType != RRES_COMP_NONE ) {
+        return false;
+    }
+
+    // props: size, extension (two big endian fourCCs), reserved
+    const unsigned int propCount = unpackedSize >= 4 ? readU32( unpacked ) : 0;
+    const size_t rawOffset = 4 + static_cast<size_t>( propCount ) * 4;
+
+    if ( propCount < 3 || rawOffset > unpackedSize || rawOffset + readU32( unpacked + 4 ) > unpackedSize ) {
+        MemFree( buffer );
+        return false;
+    }
+
+    char extension[9] = { 0 };
+    for ( int i = 0; i < 2; i++ ) {
+        const unsigned int fourCC = readU32( unpacked + 8 + i * 4 );
+        for ( int j = 0; j < 4; j++ ) {
+            extension[i * 4 + j] = static_cast<char>( ( fourCC >> ( 24 - j * 8 ) ) & 0xff );
+        }
+    }
+
+    data.bytes = unpacked + rawOffset;
+    data.size = readU32( unpacked + 4 );
+    data.extension = extension;
+    data.buffer = buffer;
+
+    return true;
+
+}
+
+/**
+ * Same result as rresLoadResourceChunk, copied from the mapping instead of
+ * read from the file: packed chunks are left for UnpackResourceChunk.
+ */
+rresResourceChunk RresArchive::loadChunk( unsigned int id ) const {
+
+    rresResourceChunk chunk{};
+    rresResourceChunkInfo info;
+    const unsigned char *packed;
+
+    if ( !readChunkInfo( id, info, packed ) || rresGetDataType( info.type ) == RRES_DATA_NULL ) {
+        return chunk;
+    }
+
+    chunk.info = info;
+
+    if ( info.compType == RRES_COMP_NONE && info.cipherType == RRES_CIPHER_NONE ) {
+
+        // stored chunks must hold their whole base size in the mapping
+        if ( info.baseSize > info.packedSize || info.baseSize < 4 ) {
+            return {};
+        }
+
+        const unsigned int propCount = readU32( packed );
+        const size_t rawOffset = 4 + static_cast<size_t>( propCount ) * 4;
+
+        if ( rawOffset > info.baseSize ) {
+            return {};
+        }
+
+        chunk.data.propCount = propCount;
+        if ( propCount > 0 ) {
+            chunk.data.props = static_cast<unsigned int*>( RRES_CALLOC( propCount, sizeof( unsigned int ) ) );
+            std::memcpy( chunk.data.props, packed + 4, propCount * sizeof( unsigned int ) );
+        }
+
+        chunk.data.raw = RRES_MALLOC( info.baseSize - rawOffset );
+        std::memcpy( chunk.data.raw, packed + rawOffset, info.baseSize - rawOffset );
+
+    } else {
+        chunk.data.raw = RRES_MALLOC( info.packedSize );
+        std::memcpy( chunk.data.raw, packed, info.packedSize );
+    }
+
+    return chunk;
+
+}
@@ -0,0 +1,217 @@
+/**
+ * @file SelectionSet.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief SelectionSet class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DirtyRegion.h"
+#include "SelectionSet.h"
+
+SelectionSet::SelectionSet( int maxLines, int maxColumns )
+    :
+    maxLines( maxLines ),
+    maxColumns( maxColumns ),
+    words( ( maxLines * maxColumns + 63 ) / 64, 0 ) {
+}
+
+SelectionSet::~SelectionSet() = default;
+
+bool SelectionSet::test( int index ) const {
+    return words[index / 64] & ( uint64_t( 1 ) << ( index % 64 ) );
+}
+
+/**
+ * Returns true when the cell changed.
+ */
+bool SelectionSet::set( int index, bool selected ) {
+    uint64_t &word = words[index / 64];
+    const uint64_t previous = word;
+    const uint64_t bit = uint64_t( 1 ) << ( index % 64 );
+    word = selected ? word | bit : word & ~bit;
+    return word != previous;
+}
+
+void SelectionSet::setRect( const DirtyRect &rect, bool selected ) {
+    applyRect( rect, selected ? RangeOperation::set : RangeOperation::reset );
+}
+
+void SelectionSet::invertRect( const DirtyRect &rect ) {
+    applyRect( rect, RangeOperation::flip );
+}
+
+void SelectionSet::clear() {
+    std::fill( words.begin(), words.end(), 0 );
+}
+
+bool SelectionSet::empty() const {
+    return std::all_of( words.begin(), words.end(), []( uint64_t word ) {
+        return word == 0;
+    });
+}
+
+size_t SelectionSet::count() const {
+    size_t total = 0;
+    for ( const uint64_t word : words ) {
+        total += std::popcount( word );
+    }
+    return total;
+}
+
+/**
+ * Index of the first selected cell, or -1 when there is none.
+ */
+int SelectionSet::getFirst() const {
+    return findFirst( 0, maxLines * maxColumns );
+}
+
+/**
+ * The first and last set bits give the line range directly; the columns
+ * come from the first and last set bits of each line in that range.
+ */
+DirtyRect SelectionSet::getBounds() const {
+
+    int first = -1;
+    int last = -1;
+
+    for ( size_t w = 0; w < words.size(); w++ ) {
+        if ( words[w] != 0 ) {
+            if ( first == -1 ) {
+                first = static_cast<int>( w * 64 + std::countr_zero( words[w] ) );
+            }
+            last = static_cast<int>( w * 64 + 63 - std::countl_zero( words[w] ) );
+        }
+    }
+
+    if ( first == -1 ) {
+        return DirtyRect( 0, 0, 0, 0 );
+    }
+
+    const int firstLine = first / maxColumns;
+    const int lastLine = last / maxColumns;
+    int firstColumn = maxColumns;
+    int lastColumn = -1;
+
+    for ( int line = firstLine; line <= lastLine; line++ ) {
+        const int begin = line * maxColumns;
+        const int lineFirst = findFirst( begin, begin + maxColumns );
+        if ( lineFirst != -1 ) {
+            firstColumn = std::min( firstColumn, lineFirst - begin );
+            lastColumn = std::max( lastColumn, findLast( begin, begin + maxColumns ) - begin );
+        }
+    }
+
+    return DirtyRect( firstLine, firstColumn, lastLine - firstLine + 1, lastColumn - firstColumn + 1 );
+
+}
+
+/**
+ * Index of the first set bit in [begin, end), or -1 when there is none.
+ */
+int SelectionSet::findFirst( int begin, int end ) const {
+
+    const int firstWord = begin / 64;
+    const int lastWord = ( end - 1 ) / 64;
+
+    for ( int w = firstWord; w <= lastWord; w++ ) {
+        uint64_t bits = words[w];
+        if ( w == firstWord ) {
+            bits &= ~uint64_t( 0 ) << ( begin % 64 );
+        }
+        if ( w == lastWord ) {
+            bits &= ~uint64_t( 0 ) >> ( 63 - ( end - 1 ) % 64 );
+        }
+        if ( bits != 0 ) {
+            return w * 64 + std::countr_zero( bits );
+        }
+    }
+
+    return -1;
+
+}
+
+/**
+ * Index of the last set bit in [begin, end), or -1 when there is none.
+ */
+int SelectionSet::findLast( int begin, int end ) const {
+
+    const int firstWord = begin / 64;
+    const int lastWord = ( end - 1 ) / 64;
+
+    for ( int w = lastWord; w >= firstWord; w-- ) {
+        uint64_t bits = words[w];
+        if ( w == firstWord ) {
+            bits &= ~uint64_t( 0 ) << ( begin % 64 );
+        }
+        if ( w == lastWord ) {
+            bits &= ~uint64_t( 0 ) >> ( 63 - ( end - 1 ) % 64 );
+        }
+        if ( bits != 0 ) {
+            return w * 64 + 63 - std::countl_zero( bits );
+        }
+    }
+
+    return -1;
+
+}
+
+/**
+ * Applies the operation to the bits [begin, end), with partial masks on
+ * the first and last words and whole words in between.
+ */
+void SelectionSet::applyRange( int begin, int end, RangeOperation operation ) {
+
+    auto apply = [operation]( uint64_t &word, uint64_t mask ) {
+        switch ( operation ) {
+            case RangeOperation::set:   word |= mask; break;
+            case RangeOperation::reset: word &= ~mask; break;
+            case RangeOperation::flip:  word ^= mask; break;
+        }
+    };
+
+    const int firstWord = begin / 64;
+    const int lastWord = ( end - 1 ) / 64;
+    const uint64_t firstMask = ~uint64_t( 0 ) << ( begin % 64 );
+    const uint64_t lastMask = ~uint64_t( 0 ) >> ( 63 - ( end - 1 ) % 64 );
+
+    if ( firstWord == lastWord ) {
+        apply( words[firstWord], firstMask & lastMask );
+        return;
+    }
+
+    apply( words[firstWord], firstMask );
+    for ( int w = firstWord + 1; w < lastWord; w++ ) {
+        apply( words[w], ~uint64_t( 0 ) );
+    }
+    apply( words[lastWord], lastMask );
+
+}
+
+void SelectionSet::applyRect( const DirtyRect &rect, RangeOperation operation ) {
+
+    const int line = std::max( rect.line, 0 );
+    const int column = std::max( rect.column, 0 );
+    const int endLine = std::min( rect.line + rect.lines, maxLines );
+    const int endColumn = std::min( rect.column + rect.columns, maxColumns );
+
+    if ( line >= endLine || column >= endColumn ) {
+        return;
+    }
+
+    // whole lines are one run over all of them
+    if ( column == 0 && endColumn == maxColumns ) {
+        applyRange( line * maxColumns, endLine * maxColumns, operation );
+        return;
+    }
+
+    for ( int i = line; i < endLine; i++ ) {
+        applyRange( i * maxColumns + column, i * maxColumns + endColumn, operation );
+    }
+
+}
@@ -0,0 +1,278 @@
+/**
+ * @file TextureAtlas.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief TextureAtlas class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "TextureAtlas.h"
+#include "raylib.h"
+
+TextureAtlas::TextureAtlas( int pageSize, int padding )
+    :
+    pageSize( pageSize ),
+    padding( padding ) {
+}
+
+TextureAtlas::~TextureAtlas() = default;
+
+/**
+ * The handle of a key is assigned here and never changes, even if the atlas
+ * is unloaded and built again.
+ */
+int TextureAtlas::reserve( const std::string &key ) {
+
+    int handle = getHandle( key );
+
+    if ( handle == INVALID_HANDLE ) {
+        handle = static_cast<int>( regions.size() );
+        handles.emplace( key, handle );
+        keys.push_back( key );
+        regions.push_back( AtlasRegion( INVALID_HANDLE, Rectangle( 0, 0, 0, 0 ) ) );
+        mirrorOf.push_back( INVALID_HANDLE );
+    }
+
+    return handle;
+
+}
+
+int TextureAtlas::add( const std::string &key, Image image ) {
+
+    const int handle = reserve( key );
+    mirrorOf[handle] = INVALID_HANDLE;
+
+    ImageFormat( &image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 );
+    pendingImages.push_back( PendingImage( handle, image ) );
+
+    return handle;
+
+}
+
+/**
+ * Nothing is packed for a mirrored key, its region is the one of the
+ * source key with the width negated, set when the atlas is built.
+ */
+int TextureAtlas::addMirrored( const std::string &key, const std::string &sourceKey ) {
+
+    const int sourceHandle = reserve( sourceKey );
+    const int handle = reserve( key );
+    mirrorOf[handle] = sourceHandle;
+
+    return handle;
+
+}
+
+void TextureAtlas::resolveMirrors() {
+    for ( size_t i = 0; i < regions.size(); i++ ) {
+        if ( mirrorOf[i] != INVALID_HANDLE ) {
+            const AtlasRegion &source = regions[mirrorOf[i]];
+            regions[i] = AtlasRegion( source.page, Rectangle( source.source.x, source.source.y, -source.source.width, source.source.height ) );
+        }
+    }
+}
+
+/**
+ * Copies the image into the page and repeats its border pixels over the
+ * padding area, so filtering and subpixel positions never sample texels
+ * from the neighbouring images.
+ */
+void TextureAtlas::copyWithExtrusion( Image &page, const Image &image, int x, int y, int padding ) {
+
+    unsigned char *dst = static_cast<unsigned char*>( page.data );
+    const unsigned char *src = static_cast<const unsigned char*>( image.data );
+
+    for ( int py = -padding; py < image.height + padding; py++ ) {
+        const int sy = std::clamp( py, 0, image.height - 1 );
+        for ( int px = -padding; px < image.width + padding; px++ ) {
+            const int sx = std::clamp( px, 0, image.width - 1 );
+            std::memcpy( dst + ( ( y + py ) * page.width + x + px ) * 4, src + ( sy * image.width + sx ) * 4, 4 );
+        }
+    }
+
+}
+
+/**
+ * Shelf packing: images are sorted by height and placed left to right in
+ * rows (shelves). When a page is full a new one is started. The height of
+ * each page is trimmed to the next power of two that holds its shelves.
+ * Building again after adding more images appends new pages, keeping the
+ * existing page pointers valid.
+ */
+void TextureAtlas::build() {
+
+    if ( pendingImages.empty() ) {
+        return;
+    }
+
+    std::sort( pendingImages.begin(), pendingImages.end(), []( const PendingImage &a, const PendingImage &b ) {
+        if ( a.image.height != b.image.height ) {
+            return a.image.height > b.image.height;
+        }
+        return a.image.width > b.image.width;
+    });
+
+    std::vector<Image> pageImages;
+    std::vector<int> usedHeights;
+    const int firstPage = static_cast<int>( pages.size() );
+
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+
+    for ( auto &[handle, image] : pendingImages ) {
+
+        const int width = image.width + padding * 2;
+        const int height = image.height + padding * 2;
+
+        if ( width > pageSize || height > pageSize ) {
+            TraceLog( LOG_WARNING, "ATLAS: Image [%s] is larger than the atlas page", keys[handle].c_str() );
+            UnloadImage( image );
+            continue;
+        }
+
+        if ( shelfX + width > pageSize ) {
+            shelfX = 0;
+            shelfY += shelfHeight;
+            shelfHeight = 0;
+        }
+
+        if ( pageImages.empty() || shelfY + height > pageSize ) {
+            pageImages.push_back( GenImageColor( pageSize, pageSize, BLANK ) );
+            usedHeights.push_back( 0 );
+            shelfX = 0;
+            shelfY = 0;
+            shelfHeight = 0;
+        }
+
+        const int page = static_cast<int>( pageImages.size() ) - 1;
+        copyWithExtrusion( pageImages[page], image, shelfX + padding, shelfY + padding, padding );
+        regions[handle] = AtlasRegion( firstPage + page, Rectangle( shelfX + padding, shelfY + padding, image.width, image.height ) );
+
+        shelfX += width;
+        shelfHeight = std::max( shelfHeight, height );
+        usedHeights[page] = std::max( usedHeights[page], shelfY + height );
+
+        UnloadImage( image );
+
+    }
+
+    pendingImages.clear();
+    resolveMirrors();
+
+    for ( size_t i = 0; i < pageImages.size(); i++ ) {
+        int height = 1;
+        while ( height < usedHeights[i] ) {
+            height *= 2;
+        }
+        ImageCrop( &pageImages[i], Rectangle( 0, 0, pageSize, height ) );
+        pages.push_back( LoadTextureFromImage( pageImages[i] ) );
+        UnloadImage( pageImages[i] );
+        TraceLog( LOG_INFO, "ATLAS: Page %d built (%dx%d)", firstPage + static_cast<int>( i ), pageSize, height );
+    }
+
+}
+
+/**
+ * Replaces the pixels of a packed image in its page, padding included, so
+ * every region and texture pointer handed out stays valid. Only possible
+ * when the new image has the same size as the old one.
+ */
+bool TextureAtlas::update( int handle, const Image &image ) {
+
+    if ( !contains( handle ) || mirrorOf[handle] != INVALID_HANDLE ) {
+        return false;
+    }
+
+    const AtlasRegion &region = regions[handle];
+
+    if ( image.width != static_cast<int>( region.source.width ) || image.height != static_cast<int>( region.source.height ) ) {
+        TraceLog( LOG_WARNING, "ATLAS: Image [%s] changed size, it can't be updated in place", keys[handle].c_str() );
+        return false;
+    }
+
+    Image converted = ImageCopy( image );
+    ImageFormat( &converted, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 );
+
+    Image padded = GenImageColor( image.width + padding * 2, image.height + padding * 2, BLANK );
+    copyWithExtrusion( padded, converted, padding, padding, padding );
+
+    UpdateTextureRec( pages[region.page],
+                      Rectangle( region.source.x - padding, region.source.y - padding, padded.width, padded.height ),
+                      padded.data );
+
+    UnloadImage( padded );
+    UnloadImage( converted );
+
+    return true;
+
+}
+
+void TextureAtlas::unload() {
+    for ( const auto &page : pages ) {
+        UnloadTexture( page );
+    }
+    for ( const auto &pending : pendingImages ) {
+        UnloadImage( pending.image );
+    }
+    pages.clear();
+    pendingImages.clear();
+    for ( auto &region : regions ) {
+        region.page = INVALID_HANDLE;
+    }
+}
+
+bool TextureAtlas::isBuilt() const {
+    return !pages.empty();
+}
+
+bool TextureAtlas::contains( int handle ) const {
+    return handle >= 0 && handle < static_cast<int>( regions.size() ) && regions[handle].page >= 0;
+}
+
+bool TextureAtlas::contains( const std::string &key ) const {
+    return contains( getHandle( key ) );
+}
+
+int TextureAtlas::getHandle( const std::string &key ) const {
+    const auto it = handles.find( key );
+    return it == handles.end() ? INVALID_HANDLE : it->second;
+}
+
+const AtlasRegion &TextureAtlas::getRegion( int handle ) const {
+    return regions[handle];
+}
+
+const AtlasRegion &TextureAtlas::getRegion( const std::string &key ) const {
+    return regions[handles.at( key )];
+}
+
+Texture2D *TextureAtlas::getPage( int page ) {
+    return &pages[page];
+}
+
+Texture2D *TextureAtlas::getTexture( int handle, Rectangle &source ) {
+
+    if ( !contains( handle ) ) {
+        source = Rectangle( 0, 0, 0, 0 );
+        return nullptr;
+    }
+
+    source = regions[handle].source;
+    return &pages[regions[handle].page];
+
+}
+
+Texture2D *TextureAtlas::getTexture( const std::string &key, Rectangle &source ) {
+    return getTexture( getHandle( key ), source );
+}
+
+int TextureAtlas::getPageCount() const {
+    return static_cast<int>( pages.size() );
+}
@@ -0,0 +1,151 @@
+/**
+ * @file ThreadPool.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief ThreadPool class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool( int threadCount )
+    :
+    nextQueue( 0 ),
+    queued( 0 ),
+    pending( 0 ),
+    stopping( false ) {
+
+    if ( threadCount <= 0 ) {
+        threadCount = std::max( static_cast<int>( std::thread::hardware_concurrency() ), 1 );
+    }
+
+    for ( int i = 0; i < threadCount; i++ ) {
+        queues.push_back( std::make_unique<TaskQueue>() );
+    }
+
+    for ( int i = 0; i < threadCount; i++ ) {
+        workers.emplace_back( &ThreadPool::workerLoop, this, static_cast<size_t>( i ) );
+    }
+
+}
+
+ThreadPool::~ThreadPool() {
+
+    {
+        std::lock_guard<std::mutex> lock( stateMutex );
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for ( auto &worker : workers ) {
+        worker.join();
+    }
+
+}
+
+int ThreadPool::getThreadCount() const {
+    return static_cast<int>( workers.size() );
+}
+
+void ThreadPool::submit( std::function<void()> task ) {
+
+    TaskQueue &queue = *queues[nextQueue++ % queues.size()];
+
+    // pending before the task is visible, so it cannot finish uncounted
+    {
+        std::lock_guard<std::mutex> lock( stateMutex );
+        pending++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( queue.mutex );
+        queue.tasks.push_back( std::move( task ) );
+    }
+
+    // counted under the state lock so a worker going to sleep cannot miss it
+    {
+        std::lock_guard<std::mutex> lock( stateMutex );
+        queued++;
+    }
+    taskAvailable.notify_one();
+
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock( stateMutex );
+    allDone.wait( lock, [this] { return pending == 0; } );
+}
+
+void ThreadPool::parallelFor( int count, const std::function<void( int )> &body ) {
+    for ( int i = 0; i < count; i++ ) {
+        submit( [&body, i] { body( i ); } );
+    }
+    wait();
+}
+
+/**
+ * Own queue first, newest task (still warm in cache), then the oldest task
+ * of each other queue in turn.
+ */
+bool ThreadPool::takeTask( size_t self, std::function<void()> &task ) {
+
+    for ( size_t k = 0; k < queues.size(); k++ ) {
+
+        TaskQueue &queue = *queues[( self + k ) % queues.size()];
+        std::lock_guard<std::mutex> lock( queue.mutex );
+
+        if ( queue.tasks.empty() ) {
+            continue;
+        }
+
+        if ( k == 0 ) {
+            task = std::move( queue.tasks.back() );
+            queue.tasks.pop_back();
+        } else {
+            task = std::move( queue.tasks.front() );
+            queue.tasks.pop_front();
+        }
+
+        queued--;
+        return true;
+
+    }
+
+    return false;
+
+}
+
+void ThreadPool::workerLoop( size_t self ) {
+
+    std::function<void()> task;
+
+    while ( true ) {
+
+        if ( takeTask( self, task ) ) {
+
+            task();
+            task = nullptr;
+
+            std::lock_guard<std::mutex> lock( stateMutex );
+            if ( --pending == 0 ) {
+                allDone.notify_all();
+            }
+            continue;
+
+        }
+
+        std::unique_lock<std::mutex> lock( stateMutex );
+        taskAvailable.wait( lock, [this] { return stopping || queued > 0; } );
+
+        if ( stopping && queued == 0 ) {
+            return;
+        }
+
+    }
+
+}
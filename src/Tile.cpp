@@ -5,6 +5,9 @@
  * 
  * @copyright Copyright (c) 2024
  */
+#include <cmath>
+#include <cstddef>
+#include <functional>
 #include <iostream>
 #include "Tile.h"
 #include "raylib.h"
@@ -17,6 +20,7 @@ Tile::Tile( Vector2 pos, Color color, float alpha, bool drawSelection, Vector2 m
     alpha( alpha ),
     drawSelection( drawSelection ),
     texture( nullptr ),
+    source( Rectangle( 0, 0, 0, 0 ) ),
     collisionType( TileCollisionType::non_solid ),
     visible( true ),
     selected( false ),
@@ -25,6 +29,13 @@ Tile::Tile( Vector2 pos, Color color, float alpha, bool drawSelection, Vector2 m
 }
 
 Tile::Tile( Vector2 pos, Texture2D* texture, float alpha, bool drawSelection, Vector2 mapEditorOffset, Vector2 drawOffset )
+    :
+    Tile( pos, texture,
+          texture != nullptr ? Rectangle( 0, 0, texture->width, texture->height ) : Rectangle( 0, 0, 0, 0 ),
+          alpha, drawSelection, mapEditorOffset, drawOffset ) {
+}
+
+Tile::Tile( Vector2 pos, Texture2D* texture, Rectangle source, float alpha, bool drawSelection, Vector2 mapEditorOffset, Vector2 drawOffset )
     :
     pos( pos ),
     dim( Vector2( TILE_WIDTH, TILE_WIDTH ) ),
@@ -32,6 +43,7 @@ Tile::Tile( Vector2 pos, Texture2D* texture, float alpha, bool drawSelection, Ve
     alpha( alpha ),
     drawSelection( drawSelection ),
     texture( texture ),
+    source( source ),
     collisionType( TileCollisionType::non_solid ),
     visible( true ),
     selected( false ),
@@ -48,7 +60,7 @@ void Tile::inputAndUpdate() {
 void Tile::draw() {
     if ( visible ) {
         if ( texture != nullptr ) {
-            DrawTexture( *texture, pos.x + drawOffset.x, pos.y + drawOffset.y, WHITE );
+            DrawTextureRec( *texture, source, Vector2( pos.x + drawOffset.x, pos.y + drawOffset.y ), WHITE );
         } else {
             DrawRectangle( pos.x + drawOffset.x, pos.y + drawOffset.y, dim.x, dim.y, Fade( color, alpha ) );
         }
@@ -61,7 +73,7 @@ void Tile::draw() {
 void Tile::draw( float customFade ) {
     if ( visible ) {
         if ( texture != nullptr ) {
-            DrawTexture( *texture, pos.x + drawOffset.x, pos.y + drawOffset.y, WHITE );
+            DrawTextureRec( *texture, source, Vector2( pos.x + drawOffset.x, pos.y + drawOffset.y ), WHITE );
         } else {
             DrawRectangle( pos.x + drawOffset.x, pos.y + drawOffset.y, dim.x, dim.y, Fade( color, customFade ) );
         }
@@ -75,9 +87,9 @@ void Tile::draw( Vector2 drawPos, bool alignCenter ) {
     if ( visible ) {
         if ( texture != nullptr ) {
             if ( alignCenter ) {
-                DrawTexture( *texture, drawPos.x - texture->width / 2 + drawOffset.x, drawPos.y - texture->height / 2 + drawOffset.y, WHITE );
+                DrawTextureRec( *texture, source, Vector2( drawPos.x - static_cast<int>( std::fabs( source.width ) ) / 2 + drawOffset.x, drawPos.y - static_cast<int>( source.height ) / 2 + drawOffset.y ), WHITE );
             } else {
-                DrawTexture( *texture, drawPos.x + drawOffset.x, drawPos.y + drawOffset.y, WHITE );
+                DrawTextureRec( *texture, source, Vector2( drawPos.x + drawOffset.x, drawPos.y + drawOffset.y ), WHITE );
             }
         } else {
             if ( alignCenter ) {
@@ -95,7 +107,7 @@ void Tile::draw( Vector2 drawPos, bool alignCenter ) {
 void Tile::draw( Vector2 drawPos, float customFade ) {
     if ( visible ) {
         if ( texture != nullptr ) {
-            DrawTexture( *texture, drawPos.x, drawPos.y, WHITE );
+            DrawTextureRec( *texture, source, drawPos, WHITE );
         } else {
             DrawRectangle( drawPos.x, drawPos.y, dim.x, dim.y, Fade( color, customFade ) );
         }
@@ -112,9 +124,13 @@ Vector2& Tile::getDim() {
     return dim;
 }
 
+Vector2& Tile::getDrawOffset() {
+    return drawOffset;
+}
+
 Rectangle Tile::getRectangle() const {
     if ( texture != nullptr ) {
-        return Rectangle( pos.x, pos.y, texture->width, texture->height );
+        return Rectangle( pos.x, pos.y, std::fabs( source.width ), source.height );
     }
     return Rectangle( pos.x, pos.y, dim.x, dim.y );
 }
@@ -156,8 +172,18 @@ Texture2D* Tile::getTexture() {
     return texture;
 }
 
+Rectangle& Tile::getSource() {
+    return source;
+}
+
 void Tile::setTexture( Texture2D* texture ) {
     this->texture = texture;
+    source = texture != nullptr ? Rectangle( 0, 0, texture->width, texture->height ) : Rectangle( 0, 0, 0, 0 );
+}
+
+void Tile::setTexture( Texture2D* texture, Rectangle source ) {
+    this->texture = texture;
+    this->source = source;
 }
 
 bool Tile::isSelected() const {
@@ -189,12 +215,59 @@ void Tile::copyData( Tile& tile, TileCollisionType collisionType, bool visible )
     color = tile.color;
     alpha = tile.alpha;
     texture = tile.texture;
+    source = tile.source;
     this->collisionType = collisionType;
     this->visible = visible;
     drawOffset = tile.drawOffset;
 
 }
 
+bool Tile::hasSameData( const Tile& tile ) const {
+
+    if ( texture != nullptr || tile.texture != nullptr ) {
+        return texture == tile.texture &&
+               source.x == tile.source.x &&
+               source.y == tile.source.y &&
+               source.width == tile.source.width &&
+               source.height == tile.source.height &&
+               drawOffset.x == tile.drawOffset.x &&
+               drawOffset.y == tile.drawOffset.y;
+    }
+
+    return color.r == tile.color.r &&
+           color.g == tile.color.g &&
+           color.b == tile.color.b &&
+           color.a == tile.color.a &&
+           alpha == tile.alpha;
+
+}
+
+/**
+ * Hash of the data compared by hasSameData, so tiles with the same data
+ * hash the same.
+ */
+size_t Tile::getDataHash() const {
+
+    size_t hash = 0;
+    const auto combine = [&hash]( size_t value ) {
+        hash ^= value + 0x9e3779b97f4a7c15ull + ( hash << 6 ) + ( hash >> 2 );
+    };
+    const std::hash<float> hashFloat;
+
+    if ( texture != nullptr ) {
+        combine( std::hash<const Texture2D*>()( texture ) );
+        for ( const float value : { source.x, source.y, source.width, source.height, drawOffset.x, drawOffset.y } ) {
+            combine( hashFloat( value ) );
+        }
+    } else {
+        combine( static_cast<size_t>( color.r ) << 24 | color.g << 16 | color.b << 8 | color.a );
+        combine( hashFloat( alpha ) );
+    }
+
+    return hash;
+
+}
+
 TileCollisionType Tile::getCollisionTypeFromInt( int collisionTypeInt ) {
     switch ( collisionTypeInt ) {
         case 0:
@@ -215,6 +288,7 @@ void Tile::resetTile( Tile& tile, bool deselect ) {
     tile.color = WHITE;
     tile.alpha = 0;
     tile.texture = nullptr;
+    tile.source = Rectangle( 0, 0, 0, 0 );
     tile.collisionType = TileCollisionType::non_solid;
     tile.visible = true;
     if ( deselect ) {
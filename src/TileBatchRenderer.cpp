@@ -0,0 +1,118 @@
+/**
+ * @file TileBatchRenderer.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief TileBatchRenderer class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <cmath>
+#include <vector>
+
+#include "ResourceManager.h"
+#include "TextureAtlas.h"
+#include "TileBatchRenderer.h"
+#include "Tile.h"
+#include "TileLayer.h"
+#include "raylib.h"
+#include "rlgl.h"
+
+TileBatchRenderer::TileBatchRenderer()
+    :
+    whiteHandle( TextureAtlas::INVALID_HANDLE ) {
+}
+
+TileBatchRenderer::~TileBatchRenderer() = default;
+
+/**
+ * The quads are emitted in the order of the cells and the bound texture is
+ * only switched when a tile comes from a different atlas page. Colored tiles
+ * sample the center of the white block packed in the atlas.
+ */
+void TileBatchRenderer::drawLayer( const TileLayer &layer, std::vector<Tile> &palette,
+                                   int startLine, int startColumn, int viewLines, int viewColumns,
+                                   int x, int y, int tileWidth, bool applyDrawOffset ) {
+
+    TextureAtlas &atlas = ResourceManager::getAtlas();
+
+    if ( whiteHandle == TextureAtlas::INVALID_HANDLE ) {
+        whiteHandle = atlas.getHandle( "white" );
+    }
+
+    if ( !atlas.contains( whiteHandle ) ) {
+        return;
+    }
+
+    Rectangle white;
+    const Texture2D *whiteTexture = atlas.getTexture( whiteHandle, white );
+    white = Rectangle( white.x + 1, white.y + 1, 1, 1 );
+
+    const float scale = static_cast<float>( tileWidth ) / Tile::TILE_WIDTH;
+    unsigned int currentTexture = 0;
+
+    rlCheckRenderBatchLimit( viewLines * viewColumns * 4 );
+
+    for ( int i = startLine; i < startLine + viewLines; i++ ) {
+        for ( int j = startColumn; j < startColumn + viewColumns; j++ ) {
+
+            const int p = layer.getIndex( i, j );
+            const uint16_t tileId = layer.getTileId( p );
+
+            if ( tileId == TileLayer::EMPTY_TILE || !layer.isVisible( p ) ) {
+                continue;
+            }
+
+            Tile &tile = palette[tileId];
+            const Texture2D *texture = tile.getTexture();
+            Rectangle source = tile.getSource();
+            float px = x + ( j - startColumn ) * tileWidth;
+            float py = y + ( i - startLine ) * tileWidth;
+            float width = tileWidth;
+            float height = tileWidth;
+            Color tint = WHITE;
+
+            if ( texture != nullptr ) {
+                if ( applyDrawOffset ) {
+                    px += tile.getDrawOffset().x * scale;
+                    py += tile.getDrawOffset().y * scale;
+                }
+                width = std::fabs( source.width ) * scale;      // negative when mirrored
+                height = source.height * scale;
+            } else {
+                texture = whiteTexture;
+                source = white;
+                tint = Fade( *( tile.getColor() ), *( tile.getAlpha() ) );
+            }
+
+            if ( texture->id != currentTexture ) {
+                if ( currentTexture != 0 ) {
+                    rlEnd();
+                }
+                currentTexture = texture->id;
+                rlSetTexture( currentTexture );
+                rlBegin( RL_QUADS );
+            }
+
+            const float u1 = source.x / texture->width;
+            const float v1 = source.y / texture->height;
+            const float u2 = ( source.x + source.width ) / texture->width;
+            const float v2 = ( source.y + source.height ) / texture->height;
+
+            rlColor4ub( tint.r, tint.g, tint.b, tint.a );
+            rlTexCoord2f( u1, v1 );
+            rlVertex2f( px, py );
+            rlTexCoord2f( u1, v2 );
+            rlVertex2f( px, py + height );
+            rlTexCoord2f( u2, v2 );
+            rlVertex2f( px + width, py + height );
+            rlTexCoord2f( u2, v1 );
+            rlVertex2f( px + width, py );
+
+        }
+    }
+
+    if ( currentTexture != 0 ) {
+        rlEnd();
+        rlSetTexture( 0 );
+    }
+
+}
@@ -0,0 +1,413 @@
+/**
+ * @file TileLayer.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief TileLayer class implementation.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "DirtyRegion.h"
+#include "SelectionSet.h"
+#include "TileLayer.h"
+#include "TileCollisionType.h"
+
+TileLayer::TileLayer( int maxLines, int maxColumns, int lines, int columns )
+    :
+    maxLines( maxLines ),
+    maxColumns( maxColumns ),
+    lines( lines ),
+    columns( columns ),
+    revision( 0 ),
+    tileIds( maxLines * maxColumns, EMPTY_TILE ),
+    flags( maxLines * maxColumns, DEFAULT_FLAGS ),
+    selection( maxLines, maxColumns ),
+    nextListenerId( 0 ) {
+}
+
+TileLayer::~TileLayer() = default;
+
+int TileLayer::getMaxLines() const {
+    return maxLines;
+}
+
+int TileLayer::getMaxColumns() const {
+    return maxColumns;
+}
+
+int TileLayer::getLines() const {
+    return lines;
+}
+
+int TileLayer::getColumns() const {
+    return columns;
+}
+
+int TileLayer::getIndex( int line, int column ) const {
+    return line * maxColumns + column;
+}
+
+unsigned int TileLayer::getRevision() const {
+    return revision;
+}
+
+uint16_t TileLayer::getTileId( int index ) const {
+    return tileIds[index];
+}
+
+TileCollisionType TileLayer::getCollisionType( int index ) const {
+    return static_cast<TileCollisionType>( flags[index] & COLLISION_MASK );
+}
+
+bool TileLayer::isVisible( int index ) const {
+    return flags[index] & VISIBLE_FLAG;
+}
+
+bool TileLayer::isSelected( int index ) const {
+    return selection.test( index );
+}
+
+/**
+ * A whole cell packed in 32 bits: tile id in the upper bits, flags in the
+ * lowest byte.
+ */
+uint32_t TileLayer::getCell( int index ) const {
+    return static_cast<uint32_t>( tileIds[index] ) << 8 | flags[index];
+}
+
+void TileLayer::setCell( int index, uint32_t cell ) {
+    tileIds[index] = static_cast<uint16_t>( cell >> 8 );
+    flags[index] = static_cast<uint8_t>( cell & 0xff );
+    revision++;
+    notify( DirtyRect( index / maxColumns, index % maxColumns, 1, 1 ), TILES_CHANGED );
+}
+
+void TileLayer::setTile( int index, uint16_t tileId, TileCollisionType collisionType, bool visible ) {
+    tileIds[index] = tileId;
+    flags[index] = static_cast<uint8_t>( collisionType ) |
+                   ( visible ? VISIBLE_FLAG : 0 );
+    revision++;
+    notify( DirtyRect( index / maxColumns, index % maxColumns, 1, 1 ), TILES_CHANGED );
+}
+
+void TileLayer::resetTile( int index, bool deselect ) {
+    const bool deselected = deselect && selection.set( index, false );
+    tileIds[index] = EMPTY_TILE;
+    flags[index] = DEFAULT_FLAGS;
+    revision++;
+    notify( DirtyRect( index / maxColumns, index % maxColumns, 1, 1 ),
+            TILES_CHANGED | ( deselected ? SELECTION_CHANGED : 0 ) );
+}
+
+void TileLayer::setSelected( int index, bool selected ) {
+    if ( selection.set( index, selected ) ) {
+        notify( DirtyRect( index / maxColumns, index % maxColumns, 1, 1 ), SELECTION_CHANGED );
+    }
+}
+
+/**
+ * Adds (or removes) a rectangle of cells to the selection, clipped to the
+ * used part of the layer.
+ */
+void TileLayer::selectRect( const DirtyRect &rect, bool selected ) {
+
+    const int line = std::max( rect.line, 0 );
+    const int column = std::max( rect.column, 0 );
+    const int endLine = std::min( rect.line + rect.lines, lines );
+    const int endColumn = std::min( rect.column + rect.columns, columns );
+
+    if ( line < endLine && column < endColumn ) {
+        const DirtyRect clipped( line, column, endLine - line, endColumn - column );
+        selection.setRect( clipped, selected );
+        notify( clipped, SELECTION_CHANGED );
+    }
+
+}
+
+void TileLayer::invertSelection() {
+    const DirtyRect used( 0, 0, lines, columns );
+    selection.invertRect( used );
+    notify( used, SELECTION_CHANGED );
+}
+
+void TileLayer::deselectAll() {
+    if ( !selection.empty() ) {
+        const DirtyRect bounds = selection.getBounds();
+        selection.clear();
+        notify( bounds, SELECTION_CHANGED );
+    }
+}
+
+const SelectionSet &TileLayer::getSelection() const {
+    return selection;
+}
+
+/**
+ * Lines are added/removed at the top of the layer (the map grows upwards)
+ * and columns are added/removed at the right. Rows are stored with a fixed
+ * stride of maxColumns, so changing the number of columns only clears the
+ * removed cells and changing the number of lines is a single memmove of the
+ * used rows. Cells outside the current dimensions are always kept empty.
+ * The selection is cleared.
+ */
+void TileLayer::resize( int newLines, int newColumns ) {
+
+    newLines = std::clamp( newLines, 0, maxLines );
+    newColumns = std::clamp( newColumns, 0, maxColumns );
+
+    if ( newColumns < columns ) {
+        for ( int i = 0; i < lines; i++ ) {
+            const int start = i * maxColumns + newColumns;
+            std::fill_n( tileIds.begin() + start, columns - newColumns, EMPTY_TILE );
+            std::fill_n( flags.begin() + start, columns - newColumns, DEFAULT_FLAGS );
+        }
+    }
+
+    if ( newLines > lines ) {
+
+        const int lineDiff = newLines - lines;
+        std::memmove( tileIds.data() + lineDiff * maxColumns, tileIds.data(), lines * maxColumns * sizeof( uint16_t ) );
+        std::memmove( flags.data() + lineDiff * maxColumns, flags.data(), lines * maxColumns * sizeof( uint8_t ) );
+        std::fill_n( tileIds.begin(), lineDiff * maxColumns, EMPTY_TILE );
+        std::fill_n( flags.begin(), lineDiff * maxColumns, DEFAULT_FLAGS );
+
+    } else if ( newLines < lines ) {
+
+        const int lineDiff = lines - newLines;
+        std::memmove( tileIds.data(), tileIds.data() + lineDiff * maxColumns, newLines * maxColumns * sizeof( uint16_t ) );
+        std::memmove( flags.data(), flags.data() + lineDiff * maxColumns, newLines * maxColumns * sizeof( uint8_t ) );
+        std::fill_n( tileIds.begin() + newLines * maxColumns, lineDiff * maxColumns, EMPTY_TILE );
+        std::fill_n( flags.begin() + newLines * maxColumns, lineDiff * maxColumns, DEFAULT_FLAGS );
+
+    }
+
+    const DirtyRect changed( 0, 0, std::max( lines, newLines ), std::max( columns, newColumns ) );
+
+    lines = newLines;
+    columns = newColumns;
+    revision++;
+    selection.clear();
+
+    // lines are shifted, so every used cell may have changed
+    notify( changed, TILES_CHANGED | SELECTION_CHANGED );
+
+}
+
+/**
+ * Fills the target rectangle repeating the cells of the source rectangle,
+ * as if the source were tiled over the whole layer from its own position.
+ * Each row is filled with one copy per repetition (a plain fill when the
+ * source is one column wide), and the change is reported once.
+ */
+void TileLayer::replicate( const DirtyRect &source, const DirtyRect &target ) {
+
+    const int line = std::max( target.line, 0 );
+    const int column = std::max( target.column, 0 );
+    const int endLine = std::min( target.line + target.lines, lines );
+    const int endColumn = std::min( target.column + target.columns, columns );
+
+    if ( source.lines <= 0 || source.columns <= 0 || line >= endLine || column >= endColumn ) {
+        return;
+    }
+
+    // position inside the source pattern, also for cells before it
+    auto wrap = []( int value, int period ) {
+        return ( value % period + period ) % period;
+    };
+
+    for ( int i = line; i < endLine; i++ ) {
+
+        const int sourceRow = ( source.line + wrap( i - source.line, source.lines ) ) * maxColumns;
+        const int row = i * maxColumns;
+
+        if ( source.columns == 1 ) {
+            std::fill_n( tileIds.begin() + row + column, endColumn - column, tileIds[sourceRow + source.column] );
+            std::fill_n( flags.begin() + row + column, endColumn - column, flags[sourceRow + source.column] );
+            continue;
+        }
+
+        for ( int j = column; j < endColumn; ) {
+            const int offset = wrap( j - source.column, source.columns );
+            const int count = std::min( source.columns - offset, endColumn - j );
+            std::memcpy( tileIds.data() + row + j, tileIds.data() + sourceRow + source.column + offset, count * sizeof( uint16_t ) );
+            std::memcpy( flags.data() + row + j, flags.data() + sourceRow + source.column + offset, count * sizeof( uint8_t ) );
+            j += count;
+        }
+
+    }
+
+    revision++;
+    notify( DirtyRect( line, column, endLine - line, endColumn - column ), TILES_CHANGED );
+
+}
+
+/**
+ * Repeats the cells inside the bounding box of the selection towards the
+ * chosen edges of the layer. Lines grow upwards, so "up" goes towards
+ * line 0.
+ */
+void TileLayer::replicateSelection( bool left, bool right, bool up, bool down ) {
+
+    if ( selection.empty() ) {
+        return;
+    }
+
+    const DirtyRect source = selection.getBounds();
+    const int lastLine = source.line + source.lines - 1;
+    const int lastColumn = source.column + source.columns - 1;
+
+    if ( left ) {
+        replicate( source, DirtyRect( source.line, 0, source.lines, source.column ) );
+    }
+    if ( right ) {
+        replicate( source, DirtyRect( source.line, lastColumn + 1, source.lines, columns - lastColumn - 1 ) );
+    }
+    if ( up ) {
+        replicate( source, DirtyRect( 0, source.column, source.line, source.columns ) );
+    }
+    if ( down ) {
+        replicate( source, DirtyRect( lastLine + 1, source.column, lines - lastLine - 1, source.columns ) );
+    }
+
+}
+
+/**
+ * Scanline flood fill from a cell over its 4-connected neighbours with the
+ * same tile and collision type. Each span is grown to the left and right
+ * and filled at once, and the lines above and below it are scanned for new
+ * spans, which go to an explicit stack (one seed per run). A visited bitset
+ * keeps the fill from looping when the new tile matches the old one. The
+ * change is reported once. Returns how many cells were filled.
+ */
+int TileLayer::floodFill( int index, uint16_t tileId, TileCollisionType collisionType, bool visible ) {
+
+    const int seedLine = index / maxColumns;
+    const int seedColumn = index % maxColumns;
+
+    if ( seedLine >= lines || seedColumn >= columns ) {
+        return 0;
+    }
+
+    const uint16_t targetId = tileIds[index];
+    const uint8_t targetCollision = flags[index] & COLLISION_MASK;
+    const uint8_t newFlags = static_cast<uint8_t>( collisionType ) | ( visible ? VISIBLE_FLAG : 0 );
+
+    std::vector<uint64_t> visited( ( maxLines * maxColumns + 63 ) / 64, 0 );
+    auto matches = [&]( int p ) {
+        return tileIds[p] == targetId &&
+               ( flags[p] & COLLISION_MASK ) == targetCollision &&
+               !( visited[p / 64] & ( uint64_t( 1 ) << ( p % 64 ) ) );
+    };
+
+    std::vector<std::pair<int, int>> stack;
+    stack.emplace_back( seedLine, seedColumn );
+
+    int filled = 0;
+    int firstLine = seedLine;
+    int lastLine = seedLine;
+    int firstColumn = seedColumn;
+    int lastColumn = seedColumn;
+
+    while ( !stack.empty() ) {
+
+        const auto [line, column] = stack.back();
+        stack.pop_back();
+
+        const int row = line * maxColumns;
+
+        if ( !matches( row + column ) ) {
+            continue;
+        }
+
+        int left = column;
+        int right = column;
+        while ( left > 0 && matches( row + left - 1 ) ) {
+            left--;
+        }
+        while ( right < columns - 1 && matches( row + right + 1 ) ) {
+            right++;
+        }
+
+        std::fill_n( tileIds.begin() + row + left, right - left + 1, tileId );
+        std::fill_n( flags.begin() + row + left, right - left + 1, newFlags );
+        for ( int j = left; j <= right; j++ ) {
+            visited[( row + j ) / 64] |= uint64_t( 1 ) << ( ( row + j ) % 64 );
+        }
+
+        filled += right - left + 1;
+        firstLine = std::min( firstLine, line );
+        lastLine = std::max( lastLine, line );
+        firstColumn = std::min( firstColumn, left );
+        lastColumn = std::max( lastColumn, right );
+
+        for ( const int next : { line - 1, line + 1 } ) {
+            if ( next < 0 || next >= lines ) {
+                continue;
+            }
+            bool inRun = false;
+            for ( int j = left; j <= right; j++ ) {
+                const bool match = matches( next * maxColumns + j );
+                if ( match && !inRun ) {
+                    stack.emplace_back( next, j );
+                }
+                inRun = match;
+            }
+        }
+
+    }
+
+    revision++;
+    notify( DirtyRect( firstLine, firstColumn, lastLine - firstLine + 1, lastColumn - firstColumn + 1 ), TILES_CHANGED );
+
+    return filled;
+
+}
+
+int TileLayer::subscribe( ChangeListener listener ) {
+    listeners.emplace_back( nextListenerId, std::move( listener ) );
+    return nextListenerId++;
+}
+
+void TileLayer::unsubscribe( int listenerId ) {
+    std::erase_if( listeners, [listenerId]( const auto &entry ) {
+        return entry.first == listenerId;
+    });
+}
+
+/**
+ * Sets every selected cell to the tile, a run of selected cells at a time.
+ * Cells already holding it are left as they are, and the change is
+ * reported once, only when some cell changed. Returns how many did.
+ */
+int TileLayer::fillSelection( uint16_t tileId, TileCollisionType collisionType, bool visible ) {
+
+    const uint8_t cellFlags = static_cast<uint8_t>( collisionType ) | ( visible ? VISIBLE_FLAG : 0 );
+    int changed = 0;
+
+    selection.forEachRun( [&]( int begin, int end ) {
+        for ( int i = begin; i < end; i++ ) {
+            changed += tileIds[i] != tileId || flags[i] != cellFlags;
+        }
+        std::fill( tileIds.begin() + begin, tileIds.begin() + end, tileId );
+        std::fill( flags.begin() + begin, flags.begin() + end, cellFlags );
+    });
+
+    if ( changed > 0 ) {
+        revision++;
+        notify( selection.getBounds(), TILES_CHANGED );
+    }
+
+    return changed;
+
+}
+
+void TileLayer::notify( const DirtyRect &rect, uint8_t changes ) {
+    for ( const auto &[id, listener] : listeners ) {
+        listener( rect, changes );
+    }
+}
@@ -0,0 +1,358 @@
+/**
+ * @file AssetManifest.h
+ * @author Prof. Dr. David Buzatto
+ * @brief Assets packed into resources/resources.rres, sorted by path.
+ * Generated by raymario-rrespack (make pack), do not edit.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+struct AssetManifestEntry {
+    const char *path;
+    unsigned int id;            // rres resource id, shared by files with the same content
+    unsigned int size;
+};
+
+inline constexpr AssetManifestEntry ASSET_MANIFEST[] = {
+    { "resources/images/backgrounds/background1.png", 0x6028cd70, 14797 },
+    { "resources/images/backgrounds/background10.png", 0x62c926c6, 37924 },
+    { "resources/images/backgrounds/background2.png", 0x2788b7a0, 23338 },
+    { "resources/images/backgrounds/background3.png", 0x1ae89e10, 14243 },
+    { "resources/images/backgrounds/background4.png", 0xa8c84200, 11187 },
+    { "resources/images/backgrounds/background5.png", 0x95a86bb0, 10716 },
+    { "resources/images/backgrounds/background6.png", 0xd2081160, 10738 },
+    { "resources/images/backgrounds/background7.png", 0xef6838d0, 14988 },
+    { "resources/images/backgrounds/background8.png", 0x6d38af01, 5258 },
+    { "resources/images/backgrounds/background9.png", 0x505886b1, 24812 },
+    { "resources/images/gui/gui1Up.png", 0x8e06eec6, 179 },
+    { "resources/images/gui/gui2Up.png", 0xbfeef45b, 201 },
+    { "resources/images/gui/gui3Up.png", 0x1999ffef, 201 },
+    { "resources/images/gui/guiAlfa.png", 0x017268b0, 1865 },
+    { "resources/images/gui/guiAlfaLowerUpper.png", 0x98023483, 1243 },
+    { "resources/images/gui/guiClock.png", 0x40a98c57, 154 },
+    { "resources/images/gui/guiCoin.png", 0x01b95054, 147 },
+    { "resources/images/gui/guiCredits.png", 0x215e7b60, 245356 },
+    { "resources/images/gui/guiGameOver.png", 0x10bb1d41, 558 },
+    { "resources/images/gui/guiHundredsPoints_100.png", 0x9dc2fdcd, 169 },
+    { "resources/images/gui/guiHundredsPoints_200.png", 0xac2ae750, 168 },
+    { "resources/images/gui/guiHundredsPoints_400.png", 0xcffad26a, 173 },
+    { "resources/images/gui/guiHundredsPoints_800.png", 0x085ab81e, 163 },
+    { "resources/images/gui/guiLetters.png", 0xa12dfb47, 758 },
+    { "resources/images/gui/guiMario.png", 0x417c3abc, 288 },
+    { "resources/images/gui/guiMarioStart.png", 0x28196884, 680 },
+    { "resources/images/gui/guiNextItem.png", 0xf4b75031, 272 },
+    { "resources/images/gui/guiNumbersBig.png", 0x450247e1, 481 },
+    { "resources/images/gui/guiNumbersWhite.png", 0x3b0651e7, 395 },
+    { "resources/images/gui/guiNumbersYellow.png", 0xb4e6a2ab, 402 },
+    { "resources/images/gui/guiPunctuation.png", 0x4ddacbbd, 371 },
+    { "resources/images/gui/guiRayMarioLogo.png", 0x287012bc, 12559 },
+    { "resources/images/gui/guiTensPoints_10.png", 0x8817fdf6, 161 },
+    { "resources/images/gui/guiTensPoints_20.png", 0x0e838f58, 163 },
+    { "resources/images/gui/guiTensPoints_40.png", 0xd8da6c45, 164 },
+    { "resources/images/gui/guiTensPoints_80.png", 0xaf18ac3e, 158 },
+    { "resources/images/gui/guiThousandsPoints_1000.png", 0xe2b735bc, 172 },
+    { "resources/images/gui/guiThousandsPoints_2000.png", 0x6c38325f, 170 },
+    { "resources/images/gui/guiThousandsPoints_4000.png", 0xaa573bd8, 176 },
+    { "resources/images/gui/guiThousandsPoints_8000.png", 0xfdf82e97, 164 },
+    { "resources/images/gui/guiTime.png", 0xf8562e5b, 204 },
+    { "resources/images/gui/guiTimeUp.png", 0x0f70c1e1, 465 },
+    { "resources/images/gui/guiX.png", 0x82cf6f55, 146 },
+    { "resources/images/mario.png", 0x61d435f9, 24095 },
+    { "resources/images/sprites/baddies/BanzaiBill_0.png", 0xb939d0b6, 1213 },
+    { "resources/images/sprites/baddies/BlueKoopaTroopa_0.png", 0x5f464a29, 506 },
+    { "resources/images/sprites/baddies/BlueKoopaTroopa_1.png", 0x62266399, 537 },
+    { "resources/images/sprites/baddies/BobOmb_0.png", 0x8206a76a, 190 },
+    { "resources/images/sprites/baddies/BobOmb_1.png", 0xbf668eda, 200 },
+    { "resources/images/sprites/baddies/BulletBill_0.png", 0xe4cf2583, 281 },
+    { "resources/images/sprites/baddies/BuzzyBeetle_0.png", 0x3c8a0f0a, 322 },
+    { "resources/images/sprites/baddies/BuzzyBeetle_1.png", 0x01ea26ba, 321 },
+    { "resources/images/sprites/baddies/FlyingGoomba_0.png", 0xab58e028, 679 },
+    { "resources/images/sprites/baddies/FlyingGoomba_1.png", 0x9638c998, 555 },
+    { "resources/images/sprites/baddies/FlyingGoomba_2.png", 0xd198b348, 642 },
+    { "resources/images/sprites/baddies/FlyingGoomba_3.png", 0xecf89af8, 481 },
+    { "resources/images/sprites/baddies/Goomba_0.png", 0xab94f9de, 382 },
+    { "resources/images/sprites/baddies/Goomba_1.png", 0x96f4d06e, 360 },
+    { "resources/images/sprites/baddies/GreenKoopaTroopa_0.png", 0x06cbd8ff, 484 },
+    { "resources/images/sprites/baddies/GreenKoopaTroopa_1.png", 0x3babf14f, 511 },
+    { "resources/images/sprites/baddies/JumpingPiranhaPlant_0.png", 0x56efd10a, 396 },
+    { "resources/images/sprites/baddies/JumpingPiranhaPlant_1.png", 0x6b8ff8ba, 394 },
+    { "resources/images/sprites/baddies/JumpingPiranhaPlant_2.png", 0x2c2f826a, 390 },
+    { "resources/images/sprites/baddies/JumpingPiranhaPlant_3.png", 0x114fabda, 385 },
+    { "resources/images/sprites/baddies/MontyMole_0.png", 0x38fc13a1, 364 },
+    { "resources/images/sprites/baddies/MontyMole_1.png", 0x059c3a11, 348 },
+    { "resources/images/sprites/baddies/MummyBeetle_0.png", 0x26143a26, 400 },
+    { "resources/images/sprites/baddies/MummyBeetle_1.png", 0x1b741396, 401 },
+    { "resources/images/sprites/baddies/Muncher_0.png", 0x16f7f962, 335 },
+    { "resources/images/sprites/baddies/Muncher_1.png", 0x2b97d0d2, 296 },
+    { "resources/images/sprites/baddies/PiranhaPlant_0.png", 0xeedff1c5, 491 },
+    { "resources/images/sprites/baddies/PiranhaPlant_1.png", 0xd3bfd875, 487 },
+    { "resources/images/sprites/baddies/RedKoopaTroopa_0.png", 0x4c481f23, 481 },
+    { "resources/images/sprites/baddies/RedKoopaTroopa_1.png", 0x71283693, 503 },
+    { "resources/images/sprites/baddies/Rex_1_0.png", 0xc132a590, 359 },
+    { "resources/images/sprites/baddies/Rex_1_1.png", 0xfc528c20, 348 },
+    { "resources/images/sprites/baddies/Rex_2_0.png", 0xf0dabf0d, 615 },
+    { "resources/images/sprites/baddies/Rex_2_1.png", 0xcdba96bd, 635 },
+    { "resources/images/sprites/baddies/Swooper_0.png", 0x788712b0, 294 },
+    { "resources/images/sprites/baddies/Swooper_1.png", 0x45e73b00, 359 },
+    { "resources/images/sprites/baddies/Swooper_2.png", 0x024741d0, 374 },
+    { "resources/images/sprites/baddies/YellowKoopaTroopa_0.png", 0x39bf0095, 494 },
+    { "resources/images/sprites/baddies/YellowKoopaTroopa_1.png", 0x04df2925, 516 },
+    { "resources/images/sprites/blocks/Cloud_0.png", 0x991594a5, 232 },
+    { "resources/images/sprites/blocks/Exclamation_0.png", 0x9a849584, 248 },
+    { "resources/images/sprites/blocks/EyesClosed_0.png", 0x53bbb7e0, 243 },
+    { "resources/images/sprites/blocks/EyesOpened_0.png", 0xb8f09982, 252 },
+    { "resources/images/sprites/blocks/EyesOpened_1.png", 0x8590b032, 230 },
+    { "resources/images/sprites/blocks/EyesOpened_2.png", 0xc230cae2, 142 },
+    { "resources/images/sprites/blocks/EyesOpened_3.png", 0xff50e352, 269 },
+    { "resources/images/sprites/blocks/Glass_0.png", 0x85189772, 285 },
+    { "resources/images/sprites/blocks/Message_0.png", 0xf47c96d1, 340 },
+    { "resources/images/sprites/blocks/Question_0.png", 0xb7da3cfb, 333 },
+    { "resources/images/sprites/blocks/Question_1.png", 0x8aba154b, 298 },
+    { "resources/images/sprites/blocks/Question_2.png", 0xcd1a6f9b, 322 },
+    { "resources/images/sprites/blocks/Question_3.png", 0xf07a462b, 309 },
+    { "resources/images/sprites/blocks/Stone_0.png", 0x843cb7bb, 268 },
+    { "resources/images/sprites/blocks/Wood_0.png", 0xcb6856f0, 269 },
+    { "resources/images/sprites/blocks/block0.png", 0x53bbb7e0, 243 },
+    { "resources/images/sprites/blocks/block1.png", 0x991594a5, 232 },
+    { "resources/images/sprites/blocks/block10.png", 0xa065e2dd, 546 },
+    { "resources/images/sprites/blocks/block11.png", 0x9d05cb6d, 566 },
+    { "resources/images/sprites/blocks/block12.png", 0xdaa5b1bd, 551 },
+    { "resources/images/sprites/blocks/block13.png", 0xe7c5980d, 494 },
+    { "resources/images/sprites/blocks/block14.png", 0x55e5441d, 510 },
+    { "resources/images/sprites/blocks/block2.png", 0x85189772, 285 },
+    { "resources/images/sprites/blocks/block3.png", 0x843cb7bb, 268 },
+    { "resources/images/sprites/blocks/block4.png", 0xcb6856f0, 269 },
+    { "resources/images/sprites/blocks/block5.png", 0xee93d70c, 248 },
+    { "resources/images/sprites/blocks/block6.png", 0xb8f09982, 252 },
+    { "resources/images/sprites/blocks/block7.png", 0x9a849584, 248 },
+    { "resources/images/sprites/blocks/block8.png", 0xf47c96d1, 340 },
+    { "resources/images/sprites/blocks/block9.png", 0xb7da3cfb, 333 },
+    { "resources/images/sprites/blocks/selectTool.png", 0xeb894c02, 157 },
+    { "resources/images/sprites/effects/Puft_0.png", 0x46c890f7, 189 },
+    { "resources/images/sprites/effects/Puft_1.png", 0x7ba8b947, 212 },
+    { "resources/images/sprites/effects/Puft_2.png", 0x3c08c397, 192 },
+    { "resources/images/sprites/effects/Puft_3.png", 0x0168ea27, 134 },
+    { "resources/images/sprites/effects/Stardust_0.png", 0x217b175c, 281 },
+    { "resources/images/sprites/effects/Stardust_1.png", 0x1c1b3eec, 270 },
+    { "resources/images/sprites/effects/Stardust_2.png", 0x5bbb443c, 260 },
+    { "resources/images/sprites/effects/Stardust_3.png", 0x66db6d8c, 231 },
+    { "resources/images/sprites/items/1UpMushroom.png", 0x45a4fe9f, 343 },
+    { "resources/images/sprites/items/3UpMoon.png", 0x795ae5d0, 232 },
+    { "resources/images/sprites/items/BeanstalkHeadLoop.png", 0x798744f1, 310 },
+    { "resources/images/sprites/items/BeanstalkHead_0.png", 0x281bcc0b, 331 },
+    { "resources/images/sprites/items/BeanstalkHead_1.png", 0x157be5bb, 341 },
+    { "resources/images/sprites/items/Coin_0.png", 0xb75241d6, 216 },
+    { "resources/images/sprites/items/Coin_1.png", 0x8a326866, 220 },
+    { "resources/images/sprites/items/Coin_2.png", 0xcd9212b6, 257 },
+    { "resources/images/sprites/items/Coin_3.png", 0xf0f23b06, 222 },
+    { "resources/images/sprites/items/CourseClearToken.png", 0xa4e71718, 169 },
+    { "resources/images/sprites/items/FireFlower_0.png", 0xd90e87df, 321 },
+    { "resources/images/sprites/items/FireFlower_1.png", 0xe46eae6f, 326 },
+    { "resources/images/sprites/items/Mushroom.png", 0x30d1aaf1, 318 },
+    { "resources/images/sprites/items/Star.png", 0x2d8cd048, 236 },
+    { "resources/images/sprites/items/YoshiCoin_0.png", 0x678bba11, 473 },
+    { "resources/images/sprites/items/YoshiCoin_1.png", 0x5aeb93a1, 484 },
+    { "resources/images/sprites/items/YoshiCoin_2.png", 0x1d4be971, 476 },
+    { "resources/images/sprites/items/YoshiCoin_3.png", 0x202bc0c1, 481 },
+    { "resources/images/sprites/items/coin.png", 0x84dbb3ef, 263 },
+    { "resources/images/sprites/items/yoshiCoin.png", 0x678bba11, 473 },
+    { "resources/images/sprites/mario/FlowerMarioFireball_0.png", 0xd6817d60, 168 },
+    { "resources/images/sprites/mario/FlowerMarioFireball_1.png", 0xebe154d0, 173 },
+    { "resources/images/sprites/mario/FlowerMarioFireball_2.png", 0xac412e00, 165 },
+    { "resources/images/sprites/mario/FlowerMarioFireball_3.png", 0x912107b0, 176 },
+    { "resources/images/sprites/mario/SmallMarioDucking_0.png", 0x61e88c59, 427 },
+    { "resources/images/sprites/mario/SmallMarioDying_0.png", 0xc7874417, 571 },
+    { "resources/images/sprites/mario/SmallMarioFalling_0.png", 0x7f8e002e, 518 },
+    { "resources/images/sprites/mario/SmallMarioJumpingAndRunning_0.png", 0x80e111bf, 520 },
+    { "resources/images/sprites/mario/SmallMarioJumping_0.png", 0x1636d1f0, 544 },
+    { "resources/images/sprites/mario/SmallMarioLookingUp_0.png", 0xc88b790c, 499 },
+    { "resources/images/sprites/mario/SmallMarioRunning_0.png", 0x58b7731d, 509 },
+    { "resources/images/sprites/mario/SmallMarioRunning_1.png", 0x65d75aad, 512 },
+    { "resources/images/sprites/mario/SmallMarioVictory_0.png", 0x05eb5fad, 543 },
+    { "resources/images/sprites/mario/SmallMario_0.png", 0xa270cfd7, 496 },
+    { "resources/images/sprites/mario/SmallMario_1.png", 0x9f10e667, 514 },
+    { "resources/images/sprites/mario/SuperMarioDucking_0.png", 0xdae1b102, 462 },
+    { "resources/images/sprites/mario/SuperMarioFalling_0.png", 0xc4873d75, 679 },
+    { "resources/images/sprites/mario/SuperMarioJumpingAndRunning_0.png", 0x23564bf4, 635 },
+    { "resources/images/sprites/mario/SuperMarioJumping_0.png", 0xad3fecab, 712 },
+    { "resources/images/sprites/mario/SuperMarioLookingUp_0.png", 0xc9ac0a8b, 599 },
+    { "resources/images/sprites/mario/SuperMarioRunning_0.png", 0xe3be4e46, 618 },
+    { "resources/images/sprites/mario/SuperMarioRunning_1.png", 0xdede67f6, 669 },
+    { "resources/images/sprites/mario/SuperMarioRunning_2.png", 0x997e1d26, 642 },
+    { "resources/images/sprites/mario/SuperMarioThrowingFireball_0.png", 0x30f4d9e0, 602 },
+    { "resources/images/sprites/mario/SuperMarioVictory_0.png", 0xbee262f6, 635 },
+    { "resources/images/sprites/mario/SuperMario_0.png", 0xb09a750f, 607 },
+    { "resources/images/sprites/mario/SuperMario_1.png", 0x8dfa5cbf, 655 },
+    { "resources/images/sprites/mario/SuperMario_2.png", 0xca5a266f, 639 },
+    { "resources/images/sprites/mario/TransitioningMario_0.png", 0x0a9e232c, 508 },
+    { "resources/images/sprites/mario/TransitioningMario_1.png", 0x37fe0a9c, 551 },
+    { "resources/images/sprites/mario/TransitioningMario_2.png", 0xb09a750f, 607 },
+    { "resources/images/tiles/1/tile_A.png", 0xd508f6e7, 197 },
+    { "resources/images/tiles/1/tile_B.png", 0x92a88c37, 266 },
+    { "resources/images/tiles/1/tile_C.png", 0xafc8a587, 237 },
+    { "resources/images/tiles/1/tile_D.png", 0x1de87997, 224 },
+    { "resources/images/tiles/1/tile_E.png", 0x20885027, 255 },
+    { "resources/images/tiles/1/tile_F.png", 0x67282af7, 303 },
+    { "resources/images/tiles/1/tile_G.png", 0x5a480347, 243 },
+    { "resources/images/tiles/1/tile_H.png", 0xd8189496, 264 },
+    { "resources/images/tiles/1/tile_I.png", 0xe578bd26, 256 },
+    { "resources/images/tiles/1/tile_J.png", 0xa2d8c7f6, 291 },
+    { "resources/images/tiles/1/tile_K.png", 0x9fb8ee46, 212 },
+    { "resources/images/tiles/1/tile_L.png", 0x2d983256, 193 },
+    { "resources/images/tiles/1/tile_M.png", 0x10f81be6, 293 },
+    { "resources/images/tiles/1/tile_N.png", 0x57586136, 297 },
+    { "resources/images/tiles/1/tile_O.png", 0x6a384886, 236 },
+    { "resources/images/tiles/1/tile_P.png", 0x888848d5, 265 },
+    { "resources/images/tiles/1/tile_Q.png", 0xb5e86165, 342 },
+    { "resources/images/tiles/1/tile_R.png", 0xf2481bb5, 304 },
+    { "resources/images/tiles/2/tile_A.png", 0xa2962417, 340 },
+    { "resources/images/tiles/2/tile_B.png", 0xe5365ec7, 425 },
+    { "resources/images/tiles/2/tile_C.png", 0xd8567777, 393 },
+    { "resources/images/tiles/2/tile_D.png", 0x6a76ab67, 449 },
+    { "resources/images/tiles/2/tile_E.png", 0x571682d7, 419 },
+    { "resources/images/tiles/2/tile_F.png", 0x10b6f807, 473 },
+    { "resources/images/tiles/2/tile_G.png", 0x2dd6d1b7, 391 },
+    { "resources/images/tiles/2/tile_H.png", 0xaf864666, 398 },
+    { "resources/images/tiles/2/tile_I.png", 0x92e66fd6, 413 },
+    { "resources/images/tiles/2/tile_J.png", 0xd5461506, 459 },
+    { "resources/images/tiles/2/tile_K.png", 0xe8263cb6, 312 },
+    { "resources/images/tiles/2/tile_L.png", 0x5a06e0a6, 341 },
+    { "resources/images/tiles/2/tile_M.png", 0x6766c916, 298 },
+    { "resources/images/tiles/2/tile_N.png", 0x20c6b3c6, 311 },
+    { "resources/images/tiles/2/tile_O.png", 0x1da69a76, 239 },
+    { "resources/images/tiles/2/tile_P.png", 0xff169a25, 299 },
+    { "resources/images/tiles/2/tile_Q.png", 0xc276b395, 343 },
+    { "resources/images/tiles/2/tile_R.png", 0x85d6c945, 314 },
+    { "resources/images/tiles/3/tile_A.png", 0x39336878, 226 },
+    { "resources/images/tiles/3/tile_B.png", 0x7e9312a8, 335 },
+    { "resources/images/tiles/3/tile_C.png", 0x43f33b18, 350 },
+    { "resources/images/tiles/3/tile_D.png", 0xf1d3e708, 341 },
+    { "resources/images/tiles/3/tile_E.png", 0xccb3ceb8, 349 },
+    { "resources/images/tiles/3/tile_F.png", 0x8b13b468, 375 },
+    { "resources/images/tiles/3/tile_G.png", 0xb6739dd8, 278 },
+    { "resources/images/tiles/3/tile_H.png", 0x34230a09, 266 },
+    { "resources/images/tiles/3/tile_I.png", 0xccb3ceb8, 349 },
+    { "resources/images/tiles/3/tile_J.png", 0x8b13b468, 375 },
+    { "resources/images/tiles/3/tile_K.png", 0x43f33b18, 350 },
+    { "resources/images/tiles/3/tile_L.png", 0xf1d3e708, 341 },
+    { "resources/images/tiles/3/tile_M.png", 0xfcc38579, 303 },
+    { "resources/images/tiles/3/tile_N.png", 0x57586136, 297 },
+    { "resources/images/tiles/3/tile_O.png", 0x8603d619, 240 },
+    { "resources/images/tiles/3/tile_P.png", 0x888848d5, 265 },
+    { "resources/images/tiles/3/tile_Q.png", 0x59d3fffa, 341 },
+    { "resources/images/tiles/3/tile_R.png", 0xf2481bb5, 304 },
+    { "resources/images/tiles/4/tile_A.png", 0x4dab81f7, 211 },
+    { "resources/images/tiles/4/tile_B.png", 0x0a0bfb27, 238 },
+    { "resources/images/tiles/4/tile_C.png", 0x376bd297, 248 },
+    { "resources/images/tiles/4/tile_D.png", 0x854b0e87, 255 },
+    { "resources/images/tiles/4/tile_E.png", 0xb82b2737, 286 },
+    { "resources/images/tiles/4/tile_F.png", 0xff8b5de7, 300 },
+    { "resources/images/tiles/4/tile_G.png", 0xc2eb7457, 265 },
+    { "resources/images/tiles/4/tile_H.png", 0x40bbe386, 259 },
+    { "resources/images/tiles/4/tile_I.png", 0xb82b2737, 286 },
+    { "resources/images/tiles/4/tile_J.png", 0xff8b5de7, 300 },
+    { "resources/images/tiles/4/tile_K.png", 0x376bd297, 248 },
+    { "resources/images/tiles/4/tile_L.png", 0x854b0e87, 255 },
+    { "resources/images/tiles/4/tile_M.png", 0x885b6cf6, 291 },
+    { "resources/images/tiles/4/tile_N.png", 0x57586136, 297 },
+    { "resources/images/tiles/4/tile_O.png", 0xf29b3f96, 234 },
+    { "resources/images/tiles/4/tile_P.png", 0x888848d5, 265 },
+    { "resources/images/tiles/4/tile_Q.png", 0x2d4b1675, 315 },
+    { "resources/images/tiles/4/tile_R.png", 0xf2481bb5, 304 },
+    { "resources/images/tiles/pipes/blue/tile_0.png", 0xf1fe9346, 189 },
+    { "resources/images/tiles/pipes/blue/tile_1.png", 0xcc9ebaf6, 209 },
+    { "resources/images/tiles/pipes/blue/tile_2.png", 0x8b3ec026, 160 },
+    { "resources/images/tiles/pipes/blue/tile_3.png", 0xb65ee996, 156 },
+    { "resources/images/tiles/pipes/darkgray/tile_0.png", 0x07d0d6fc, 178 },
+    { "resources/images/tiles/pipes/darkgray/tile_1.png", 0x3ab0ff4c, 214 },
+    { "resources/images/tiles/pipes/darkgray/tile_2.png", 0x7d10859c, 160 },
+    { "resources/images/tiles/pipes/darkgray/tile_3.png", 0x4070ac2c, 156 },
+    { "resources/images/tiles/pipes/gray/tile_0.png", 0x12fc2810, 190 },
+    { "resources/images/tiles/pipes/gray/tile_1.png", 0x2f9c01a0, 203 },
+    { "resources/images/tiles/pipes/gray/tile_2.png", 0x683c7b70, 155 },
+    { "resources/images/tiles/pipes/gray/tile_3.png", 0x555c52c0, 150 },
+    { "resources/images/tiles/pipes/green/tile_0.png", 0x9a78b111, 176 },
+    { "resources/images/tiles/pipes/green/tile_1.png", 0xa71898a1, 195 },
+    { "resources/images/tiles/pipes/green/tile_2.png", 0xe0b8e271, 152 },
+    { "resources/images/tiles/pipes/green/tile_3.png", 0xddd8cbc1, 147 },
+    { "resources/images/tiles/pipes/orange/tile_0.png", 0x0fb52ad2, 181 },
+    { "resources/images/tiles/pipes/orange/tile_1.png", 0x32d50362, 199 },
+    { "resources/images/tiles/pipes/orange/tile_2.png", 0x757579b2, 151 },
+    { "resources/images/tiles/pipes/orange/tile_3.png", 0x48155002, 149 },
+    { "resources/images/tiles/pipes/pink/tile_0.png", 0x23461992, 186 },
+    { "resources/images/tiles/pipes/pink/tile_1.png", 0x1e263022, 210 },
+    { "resources/images/tiles/pipes/pink/tile_2.png", 0x59864af2, 159 },
+    { "resources/images/tiles/pipes/pink/tile_3.png", 0x64e66342, 156 },
+    { "resources/images/tiles/pipes/purple/tile_0.png", 0x3c605b76, 185 },
+    { "resources/images/tiles/pipes/purple/tile_1.png", 0x010072c6, 212 },
+    { "resources/images/tiles/pipes/purple/tile_2.png", 0x46a00816, 155 },
+    { "resources/images/tiles/pipes/purple/tile_3.png", 0x7bc021a6, 162 },
+    { "resources/images/tiles/pipes/red/tile_0.png", 0x639f51f8, 186 },
+    { "resources/images/tiles/pipes/red/tile_1.png", 0x5eff7848, 209 },
+    { "resources/images/tiles/pipes/red/tile_2.png", 0x195f0298, 159 },
+    { "resources/images/tiles/pipes/red/tile_3.png", 0x243f2b28, 161 },
+    { "resources/images/tiles/pipes/yellow/tile_0.png", 0x034ed4e3, 190 },
+    { "resources/images/tiles/pipes/yellow/tile_1.png", 0x3e2efd53, 213 },
+    { "resources/images/tiles/pipes/yellow/tile_2.png", 0x798e8783, 160 },
+    { "resources/images/tiles/pipes/yellow/tile_3.png", 0x44eeae33, 158 },
+    { "resources/images/tiles/scenario/tile_CourseClearPoleBackBody.png", 0xcf299f18, 229 },
+    { "resources/images/tiles/scenario/tile_CourseClearPoleBackTop.png", 0x906bda1b, 307 },
+    { "resources/images/tiles/scenario/tile_CourseClearPoleFrontBody.png", 0xa1f773bf, 242 },
+    { "resources/images/tiles/scenario/tile_CourseClearPoleFrontTop.png", 0x25819a8c, 317 },
+    { "resources/images/tiles/smallPipes/blue/tile_0.png", 0x70fbb6b3, 264 },
+    { "resources/images/tiles/smallPipes/blue/tile_1.png", 0x4d9b9f03, 179 },
+    { "resources/images/tiles/smallPipes/darkgray/tile_0.png", 0x6f26f391, 265 },
+    { "resources/images/tiles/smallPipes/darkgray/tile_1.png", 0x5246da21, 180 },
+    { "resources/images/tiles/smallPipes/gray/tile_0.png", 0x93f90de5, 258 },
+    { "resources/images/tiles/smallPipes/gray/tile_1.png", 0xae992455, 174 },
+    { "resources/images/tiles/smallPipes/green/tile_0.png", 0x572eb2a7, 241 },
+    { "resources/images/tiles/smallPipes/green/tile_1.png", 0x6a4e9b17, 171 },
+    { "resources/images/tiles/smallPipes/orange/tile_0.png", 0x2d7a6a68, 252 },
+    { "resources/images/tiles/smallPipes/orange/tile_1.png", 0x101a43d8, 172 },
+    { "resources/images/tiles/smallPipes/pink/tile_0.png", 0xa2433c67, 271 },
+    { "resources/images/tiles/smallPipes/pink/tile_1.png", 0x9f2315d7, 182 },
+    { "resources/images/tiles/smallPipes/purple/tile_0.png", 0x1eaf1bcc, 269 },
+    { "resources/images/tiles/smallPipes/purple/tile_1.png", 0x23cf327c, 183 },
+    { "resources/images/tiles/smallPipes/red/tile_0.png", 0xd8ac692c, 269 },
+    { "resources/images/tiles/smallPipes/red/tile_1.png", 0xe5cc409c, 186 },
+    { "resources/images/tiles/smallPipes/yellow/tile_0.png", 0x21819459, 262 },
+    { "resources/images/tiles/smallPipes/yellow/tile_1.png", 0x1ce1bde9, 179 },
+    { "resources/musics/courseClear.mp3", 0x7e151bf4, 245400 },
+    { "resources/musics/ending.mp3", 0x0c662ec1, 4126563 },
+    { "resources/musics/gameOver.mp3", 0x84492b5b, 212488 },
+    { "resources/musics/invincible.mp3", 0xf617d5d5, 549535 },
+    { "resources/musics/music1.mp3", 0x4c97a31e, 1821079 },
+    { "resources/musics/music2.mp3", 0x0b37d9ce, 1761544 },
+    { "resources/musics/music3.mp3", 0x3657f07e, 1110831 },
+    { "resources/musics/music4.mp3", 0x84772c6e, 1822508 },
+    { "resources/musics/music5.mp3", 0xb91705de, 1917807 },
+    { "resources/musics/music6.mp3", 0xfeb77f0e, 1932488 },
+    { "resources/musics/music7.mp3", 0xc3d756be, 2364335 },
+    { "resources/musics/music8.mp3", 0x4187c16f, 1366378 },
+    { "resources/musics/music9.mp3", 0x7ce7e8df, 1781712 },
+    { "resources/musics/overworld1.ogg", 0x1120b632, 2106558 },
+    { "resources/musics/playerDown.mp3", 0xd6e71bc1, 174163 },
+    { "resources/musics/title.mp3", 0xaa9bb281, 1155229 },
+    { "resources/sfx/powerUp.wav", 0x004bc82c, 37402 },
+    { "resources/sfx/smw_1-up.wav", 0xc9079df5, 21972 },
+    { "resources/sfx/smw_break_block.wav", 0x98ba8c54, 26862 },
+    { "resources/sfx/smw_chuck_whistle.wav", 0x5cc6664e, 16632 },
+    { "resources/sfx/smw_coin.wav", 0xa654e61d, 18570 },
+    { "resources/sfx/smw_dragon_coin.wav", 0xcd09946b, 15804 },
+    { "resources/sfx/smw_fireball.wav", 0xda16f1cc, 4986 },
+    { "resources/sfx/smw_goal_iris-out.wav", 0x8d3e2841, 35266 },
+    { "resources/sfx/smw_jump.wav", 0x3ef45543, 14738 },
+    { "resources/sfx/smw_kick.wav", 0x7f1a6484, 5906 },
+    { "resources/sfx/smw_message_block.wav", 0x085e8f52, 35192 },
+    { "resources/sfx/smw_pause.wav", 0x133bfae6, 26328 },
+    { "resources/sfx/smw_pipe.wav", 0x64b987ad, 30258 },
+    { "resources/sfx/smw_power-up.wav", 0x004bc82c, 37402 },
+    { "resources/sfx/smw_power-up_appears.wav", 0xd500f12f, 20692 },
+    { "resources/sfx/smw_reserve_item_release.wav", 0xb7036273, 37002 },
+    { "resources/sfx/smw_reserve_item_store.wav", 0x0b4912c9, 22832 },
+    { "resources/sfx/smw_riding_yoshi.wav", 0x6da3836b, 24006 },
+    { "resources/sfx/smw_shell_ricochet.wav", 0x5cd9c3e5, 3666 },
+    { "resources/sfx/smw_stomp.wav", 0x4c9f41f5, 5870 },
+    { "resources/sfx/smw_stomp_no_damage.wav", 0x9cd431cc, 11732 },
+};
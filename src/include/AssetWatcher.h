@@ -0,0 +1,52 @@
+/**
+ * @file AssetWatcher.h
+ * @author Prof. Dr. David Buzatto
+ * @brief AssetWatcher class declaration. Watches a directory tree on its own
+ * thread (inotify on Linux, ReadDirectoryChangesW on Windows) and calls back,
+ * still on that thread, with the path of each file that was written. Events
+ * of the same file are merged until it has been quiet for SETTLE_TIME, so a
+ * file is only reported once its editor has finished saving it. Kept apart
+ * from raylib because windows.h clashes with its names.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+class AssetWatcher {
+
+public:
+
+    // path as root + '/' + the path inside it, always with '/'
+    using ChangeCallback = std::function<void( const std::string &path )>;
+
+    static constexpr std::chrono::milliseconds SETTLE_TIME{ 150 };
+
+private:
+
+    std::string root;
+    std::string extension;
+    ChangeCallback callback;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    void run();
+
+public:
+
+    AssetWatcher();
+    ~AssetWatcher();
+
+    AssetWatcher( const AssetWatcher& ) = delete;
+    AssetWatcher &operator=( const AssetWatcher& ) = delete;
+
+    bool start( const std::string &root, const std::string &extension, ChangeCallback callback );
+    void stop();
+    bool isRunning() const;
+
+};
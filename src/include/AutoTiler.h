@@ -0,0 +1,56 @@
+/**
+ * @file AutoTiler.h
+ * @author Prof. Dr. David Buzatto
+ * @brief AutoTiler class declaration. Picks the piece of a terrain set (the
+ * 18 tiles A..R of sets 1 to 4) for each terrain cell from its 8-neighbour
+ * mask, through a lookup table built once. Pieces A..L count as terrain;
+ * the chosen piece is always one of A..H (fill, top, sides, outer and inner
+ * corners). The sets have no bottom pieces, so the cells below never change
+ * the piece, and the borders of the map other than the top continue the
+ * terrain.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "DirtyRegion.h"
+#include "TileLayer.h"
+
+class AutoTiler {
+
+    // terrain set (1..SETS) of each palette index, 0 when it is not terrain
+    std::vector<uint8_t> terrainSets;
+    std::array<std::array<uint16_t, 18>, 5> pieces;
+
+    int getTerrainSet( uint16_t tileId ) const;
+
+public:
+
+    static constexpr int SETS = 4;
+    static constexpr int PIECES = 18;
+    static constexpr int TERRAIN_PIECES = 12;
+
+    // neighbour bits of the mask
+    static constexpr uint8_t NORTH = 0x01;
+    static constexpr uint8_t NORTH_EAST = 0x02;
+    static constexpr uint8_t EAST = 0x04;
+    static constexpr uint8_t SOUTH_EAST = 0x08;
+    static constexpr uint8_t SOUTH = 0x10;
+    static constexpr uint8_t SOUTH_WEST = 0x20;
+    static constexpr uint8_t WEST = 0x40;
+    static constexpr uint8_t NORTH_WEST = 0x80;
+
+    AutoTiler();
+    ~AutoTiler();
+
+    static const std::array<char, 256> &getPieceTable();
+
+    void setPieces( int set, const std::array<uint16_t, 18> &paletteIndexes );
+    bool isTerrain( uint16_t tileId ) const;
+    int retile( TileLayer &layer, const DirtyRect &rect ) const;
+
+};
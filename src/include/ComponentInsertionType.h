@@ -14,6 +14,7 @@ enum class ComponentInsertionType {
     items = 2,
     baddies = 3,
     mario = 4,
-    select = 5
+    select = 5,
+    fill = 6
 
 };
\ No newline at end of file
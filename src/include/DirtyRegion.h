@@ -0,0 +1,40 @@
+/**
+ * @file DirtyRegion.h
+ * @author Prof. Dr. David Buzatto
+ * @brief DirtyRegion class declaration. Accumulates the cells of a tile grid
+ * that changed since it was last cleared as the bounding rectangle of the
+ * changes. Each consumer (renderers, previews, exporters) keeps its own
+ * region and clears it when it catches up.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+struct DirtyRect {
+    int line;
+    int column;
+    int lines;
+    int columns;
+};
+
+class DirtyRegion {
+
+    int maxLines;
+    int maxColumns;
+
+    DirtyRect bounds;
+    bool empty;
+
+public:
+
+    DirtyRegion( int maxLines, int maxColumns );
+    ~DirtyRegion();
+
+    void markRect( const DirtyRect &rect );
+    void markAll();
+    void clear();
+
+    bool isEmpty() const;
+    const DirtyRect &getBounds() const;
+
+};
@@ -0,0 +1,99 @@
+/**
+ * @file EditJournal.h
+ * @author Prof. Dr. David Buzatto
+ * @brief EditJournal class declaration. Undo/redo history of the tile
+ * layers. Every edit made while a command is open is recorded as runs of
+ * consecutive cells of one layer (layer, first index, count), with the old
+ * and new packed cells of each run kept in a side buffer of words. When
+ * the command ends, the cells touched in it are compared against a shadow
+ * copy of each layer, so the editing code needs no bookkeeping and a cell
+ * painted over and over is recorded only once, or not at all when it ends
+ * as it was. A filled row costs one run and two words per cell. Runs and
+ * words live in fixed size ring buffers, dropping the oldest commands when
+ * either fills up, and undo/redo cost is proportional to the cells a
+ * command changed.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "DirtyRegion.h"
+#include "TileLayer.h"
+
+class EditJournal {
+
+    struct CellRun {
+        int layer;
+        int first;              // RESIZE for a resize of the layer
+        int count;              // the run takes 2 * count words, before and after of each cell
+    };
+
+    struct Command {
+        uint64_t firstRun;      // positions of the first run and word in the rings
+        uint64_t firstWord;
+        size_t runCount;
+        size_t wordCount;
+        int mergeKey;
+    };
+
+    struct Shadow {
+        int lines;
+        int columns;
+        std::vector<uint32_t> cells;
+    };
+
+    static constexpr int RESIZE = -1;
+
+    std::vector<TileLayer> *layers;
+    std::vector<int> listenerIds;
+    std::vector<Shadow> shadows;
+    std::vector<std::pair<int, int>> touched;
+
+    std::vector<CellRun> runs;
+    std::vector<uint32_t> words;
+    uint64_t runHead;
+    uint64_t wordHead;
+    std::deque<Command> commands;
+    size_t applied;
+
+    bool open;
+    bool recording;
+    bool overflowed;
+    int mergeKey;
+
+    void onChange( int layer, const DirtyRect &rect );
+    void syncShadow( int layer );
+    void flushTouched( int layer = -1, int lineShift = 0 );
+    void append( int layer, int index, uint32_t before, uint32_t after );
+    void apply( const CellRun &run, uint64_t word, bool undo );
+
+public:
+
+    // capacity is the number of cell changes kept
+    explicit EditJournal( size_t capacity );
+    ~EditJournal();
+
+    EditJournal( const EditJournal& ) = delete;
+    EditJournal &operator=( const EditJournal& ) = delete;
+
+    void attach( std::vector<TileLayer> &layers );
+
+    void beginCommand( int mergeKey = 0 );
+    void endCommand();
+
+    bool undo();
+    bool redo();
+    bool canUndo() const;
+    bool canRedo() const;
+    void clear();
+
+    // marks the tile ids the recorded changes can bring back
+    void markTileIds( std::vector<bool> &used ) const;
+
+};
@@ -0,0 +1,98 @@
+/**
+ * @file FrameProfiler.h
+ * @author Prof. Dr. David Buzatto
+ * @brief FrameProfiler class declaration. Times the phases of each frame
+ * (input, palette setup, tiles, previews, GUI, music and present) and
+ * keeps the last HISTORY frames to show rolling min/avg/p99 in an overlay
+ * (F3) and to export them as a Chrome trace (F4, open it in
+ * chrome://tracing or ui.perfetto.dev). Main thread only.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class FrameProfiler {
+
+public:
+
+    enum class Phase {
+        frame,
+        input,
+        paletteSetup,
+        music,
+        tiles,
+        previews,
+        gui,
+        present,
+        count
+    };
+
+    static constexpr int PHASES = static_cast<int>( Phase::count );
+    static constexpr int HISTORY = 240;
+
+    /**
+     * Times the phase from construction to the end of the scope.
+     */
+    class Scope {
+        Phase phase;
+    public:
+        explicit Scope( Phase phase );
+        ~Scope();
+        Scope( const Scope& ) = delete;
+        Scope &operator=( const Scope& ) = delete;
+    };
+
+    struct Stats {
+        float min;
+        float avg;
+        float p99;
+    };
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t TRACE_CAPACITY = HISTORY * 16;
+
+    struct TraceEvent {
+        Phase phase;
+        long long start;      // microseconds since the profiler started
+        long long duration;
+    };
+
+    static Clock::time_point origin;
+    static std::array<Clock::time_point, PHASES> starts;
+    static std::array<double, PHASES> frameTotals;                      // ms, this frame
+    static std::array<std::array<float, HISTORY>, PHASES> samples;      // ms, ring per phase
+    static int frameCount;
+    static std::vector<TraceEvent> trace;                                // ring, last TRACE_CAPACITY events
+    static size_t traceNext;
+    static bool overlayVisible;
+
+    static long long toMicroseconds( Clock::time_point time );
+
+public:
+
+    static const char *getPhaseName( Phase phase );
+
+    static void beginFrame();
+    static void endFrame();
+
+    static void begin( Phase phase );
+    static void end( Phase phase );
+
+    static Stats getStats( Phase phase );
+
+    static void toggleOverlay();
+    static bool isOverlayVisible();
+    static void drawOverlay( int x, int y );
+
+    static bool exportChromeTrace( const std::string &path );
+
+};
@@ -0,0 +1,76 @@
+/**
+ * @file MapBinaryFile.h
+ * @author Prof. Dr. David Buzatto
+ * @brief MapBinaryFile class declaration. A compact, versioned binary
+ * version of the text map format (.rmap). Unlike the text format each layer
+ * is kept on its own, and every tile is kept as it is: colored tiles with
+ * their color and all tiles with their own collision and visibility. Files
+ * are read through a read-only memory mapping and decoded straight into
+ * the layers; each palette entry is resolved once, not each cell.
+ *
+ * Layout (little endian):
+ *   header      "RMAP", version (u16), layer count (u16), lines (i32),
+ *               columns (i32), metadata offset (u32), metadata size (u32)
+ *   layer table offset (u32), size (u32), encoding (u8), 3 padding bytes
+ *               per layer
+ *   palette     entry count (u16), then per entry its type (u8, glyph or
+ *               color), glyph (u8), color (4 bytes) and cell flags (u8);
+ *               entry 0 is the empty cell and is not stored
+ *   layers      lines * columns palette indices (u16), raw or as
+ *               (count u8, index u16) runs
+ *   metadata    background color (4 bytes), background, tile set, music and
+ *               time to finish (i32 each), then messages, comments and
+ *               header comments as length prefixed strings
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "MapFile.h"
+#include "raylib.h"
+#include "TileLayer.h"
+
+class MapBinaryFile {
+
+public:
+
+    static constexpr char MAGIC[4] = { 'R', 'M', 'A', 'P' };
+    static constexpr uint16_t VERSION = 2;
+
+    static constexpr uint8_t RAW_ENCODING = 0;
+    static constexpr uint8_t RUN_LENGTH_ENCODING = 1;
+
+    static constexpr uint8_t GLYPH_ENTRY = 0;
+    static constexpr uint8_t COLOR_ENTRY = 1;
+
+    // larger headers are rejected before anything is allocated
+    static constexpr int MAX_LAYERS = 16;
+    static constexpr int MAX_SIZE = 4096;
+    static constexpr size_t MAX_CELLS = 1 << 20;
+
+    /**
+     * Returns the palette index for a colored tile. Called once per palette
+     * entry of a map.
+     */
+    using ColorResolver = std::function<uint16_t( Color color )>;
+
+    static bool load( const std::string &path, MapMetadata &metadata, std::vector<TileLayer> &layers,
+                      const MapFile::GlyphResolver &glyphResolver, const ColorResolver &colorResolver,
+                      std::vector<MapError> &errors );
+    static bool save( const std::string &path, const MapMetadata &metadata, const std::vector<TileLayer> &layers,
+                      const std::vector<char> &paletteGlyphs, const std::vector<Color> &paletteColors,
+                      std::vector<MapError> &errors );
+
+    // for tools that work on glyphs only: every color is MapFile::COLORED_TILE
+    static uint16_t resolveColorAsIndex( Color color );
+
+    static bool convertTextToBinary( const std::string &textPath, const std::string &binaryPath, std::vector<MapError> &errors );
+    static bool convertBinaryToText( const std::string &binaryPath, const std::string &textPath, std::vector<MapError> &errors );
+
+};
@@ -7,19 +7,36 @@
  */
 
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
+#include "AutoTiler.h"
+#include "DirtyRegion.h"
 #include "Drawable.h"
+#include "EditJournal.h"
+#include "MapFile.h"
 #include "raylib.h"
 #include "Tile.h"
+#include "TileBatchRenderer.h"
+#include "TileLayer.h"
 
 class GameWorld;
 
 class MapEditor : public virtual Drawable {
 
+    // palette indices are 16 bit cell values
+    static constexpr size_t MAX_PALETTE_SIZE = 65536;
+
     struct LayerState {
         bool visible;
+        RenderTexture2D preview;
+        unsigned int previewRevision;
+        int previewStartLine;
+        int previewStartColumn;
     };
 
     Vector2 pos;
@@ -30,12 +47,14 @@ class MapEditor : public virtual Drawable {
     int lines;
     int previousLines;
     int pressedLine;
+    int dragLine;
 
     int minColumns;
     int maxColumns;
     int columns;
     int previousColumns;
     int pressedColumn;
+    int dragColumn;
 
     Vector2 tileComposerDim;
 
@@ -44,8 +63,36 @@ class MapEditor : public virtual Drawable {
     int viewOffsetLine;
     int viewOffsetColumn;
 
-    std::vector<std::vector<Tile*>> layers;
-    Tile *firstSelectedTile;
+    std::vector<TileLayer> layers;
+    std::vector<Tile> palette;
+
+    // palette indices by tile data hash, and entries freed for reuse
+    std::unordered_multimap<size_t, uint16_t> paletteIndices;
+    std::vector<uint16_t> freePaletteIndices;
+
+    // palette entries standing for glyphs with no image, written back as read
+    std::map<uint16_t, char> placeholderGlyphs;
+
+    // undo/redo history; a drag with the mouse button held is one command
+    EditJournal journal;
+    int paintStroke;
+
+    // auto-tiling of the terrain sets, redone around the cells changed in the current layer
+    AutoTiler autoTiler;
+    DirtyRegion autoTileDirtyRegion;
+    bool autoTile;
+    bool retiling;
+    TileBatchRenderer tileRenderer;
+
+    // tiles of all visible layers, kept between frames and redrawn only where they change
+    RenderTexture2D tilesBackbuffer;
+    DirtyRegion tilesDirtyRegion;
+    int backbufferStartLine;
+    int backbufferStartColumn;
+    std::vector<bool> backbufferLayersVisible;
+    unsigned int backbufferAssetRevision;
+    size_t overflowPaletteSize;
+    int tileOverflow;
     int currentLayer;
     int maxLayers;
 
@@ -85,6 +132,7 @@ class MapEditor : public virtual Drawable {
     Rectangle colorPickerTileRect;
     Rectangle sliderAlphaTileRect;
     Rectangle checkVisibleRect;
+    Rectangle checkAutoTileRect;
     int tileCollisionType;
     int tilePaintingType;
     bool tileVisible;
@@ -95,6 +143,11 @@ class MapEditor : public virtual Drawable {
 
     Tile coloredModelTile;
 
+    // copy of the palette entry of the first selected colored tile, edited
+    // by the color picker instead of the model while there is one
+    Tile pickedColorTile;
+    uint16_t pickedColorTileId;
+
     // map properties
     Color backgroundColor;
     int backgroundTextureId;
@@ -103,6 +156,8 @@ class MapEditor : public virtual Drawable {
     bool showGrid;
     bool playMusic;
     int previousSelectedMusicId;
+    int prefetchedBackgroundTextureId;
+    int prefetchedMusicId;
 
     // component rectangles and helper attributes for GUI construction and interaction
     Rectangle terrainRect;
@@ -123,22 +178,44 @@ class MapEditor : public virtual Drawable {
     std::vector<Tile> baddiesToSelect;
 
     Tile mario;
-    Tile* lastMarioTile;
 
     bool resourceDependantComponentsCreated{ false };
 
-    std::vector<Tile*> selectedTiles;
+    // map file
+    std::string mapPath;
+    MapMetadata mapMetadata;
+
+    // resource handles and labels resolved once, so drawing does no string lookups
+    std::vector<int> backgroundTextureHandles;
+    std::vector<int> musicHandles;
+    std::vector<int> insertOptionTextureHandles;
+    std::vector<std::string> rulerLabels;
 
     void computePressedLineAndColumn( Vector2 &mousePos, int &line, int &column ) const;
     void selectTile( Vector2 &mousePos );
-    Tile* getTileFromPosition( Vector2 &mousePos );
+    int getTileIndexFromPosition( Vector2 &mousePos ) const;
     void deselectTile( Vector2 &mousePos );
     void deselectTiles();
     bool isTileSelected( Vector2 &mousePos ) const;
     bool isTilePositionValid( int line, int column ) const;
     bool isMouseInsideEditor( const Vector2 &mousePos ) const;
 
-    void drawLayerPreview( int x, int y, int tileWidth, bool active, const std::vector<Tile*>& tiles ) const;
+    uint16_t getPaletteIndex( const Tile &model );
+    uint16_t getPlaceholderIndex( char glyph );
+    uint16_t addPaletteEntry( const Tile &model );
+    void compactPalette();
+    void updatePickedColorTile();
+    void removeTiles( uint16_t tileId );
+    void undo();
+    void redo();
+    DirtyRect getRubberBand() const;
+
+    Tile createAtlasTile( Vector2 tilePos, const std::string &textureKey, Vector2 mapEditorOffset, Vector2 drawOffset = Vector2( 0, 0 ) ) const;
+    void drawAtlasTexture( int textureHandle, int x, int y ) const;
+
+    int getTileOverflow();
+    void updateTilesBackbuffer();
+    void drawLayerPreview( int x, int y, int tileWidth, bool active, const TileLayer &layer, LayerState &state );
     void highlightSelectedTile( Tile &tile ) const;
 
 public:
@@ -149,7 +226,10 @@ public:
     void inputAndUpdate();
     void draw() override;
 
-    void relocateTiles( std::vector<Tile*> &tiles ) const;
+    void relocateTiles( TileLayer &layer ) const;
+
+    bool loadMap( const std::string &path );
+    bool saveMap( const std::string &path );
 
 };
 
@@ -0,0 +1,115 @@
+/**
+ * @file MapFile.h
+ * @author Prof. Dr. David Buzatto
+ * @brief MapFile class declaration. Reads the RayMario text map format
+ * (the .txt files in resources/maps): comment lines starting with '#', the
+ * c:/b:/t:/m:/f:/h: headers and a grid of glyphs, one per cell. Glyphs are
+ * resolved through a fixed 128 entry table and written straight into a
+ * TileLayer. Writing does the inverse, merging the layers into one grid.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "raylib.h"
+#include "TileCollisionType.h"
+#include "TileLayer.h"
+
+struct MapError {
+    int line;
+    int column;
+    std::string message;
+};
+
+struct MapMetadata {
+
+    Color backgroundColor{ WHITE };
+    int backgroundTextureId{ 1 };
+    int tileSetId{ 1 };
+    int musicId{ 1 };
+    int timeToFinish{ 200 };
+    std::vector<std::string> messages;
+
+    // kept only to write the file back as it was read
+    std::vector<std::string> comments;
+    std::map<char, std::string> headerComments;
+
+    // where the headers and the grid are in the text file, for messages
+    std::map<char, int> headerLines;
+    int firstGridLine{ 1 };
+
+};
+
+enum class MapGlyphType {
+    undefined,
+    empty,
+    textured,
+    invisible
+};
+
+struct MapGlyph {
+    MapGlyphType type;
+    const char *textureKey;         // for tiles A..Z it is completed with the tile set id
+    TileCollisionType collisionType;
+};
+
+class MapFile {
+
+public:
+
+    // palette glyph of colored tiles, written as '/' or '|' when invisible
+    static constexpr char COLORED_TILE = 1;
+
+    /**
+     * Returns the palette index for a glyph. Called once per distinct glyph
+     * of a map, with the atlas key of its texture (empty for invisible tiles).
+     */
+    using GlyphResolver = std::function<uint16_t( char glyph, const MapGlyph &info, const std::string &textureKey )>;
+
+    static const std::array<MapGlyph, 128> &getGlyphTable();
+    static std::string getTextureKey( char glyph, int tileSetId );
+
+    static bool load( const std::string &path, MapMetadata &metadata, TileLayer &layer,
+                      const GlyphResolver &resolver, std::vector<MapError> &errors );
+    static bool parse( std::string_view text, MapMetadata &metadata, TileLayer &layer,
+                       const GlyphResolver &resolver, std::vector<MapError> &errors );
+
+    static bool save( const std::string &path, const MapMetadata &metadata, const std::vector<TileLayer> &layers,
+                      const std::vector<char> &paletteGlyphs, std::vector<MapError> &errors );
+    static std::string write( const MapMetadata &metadata, const std::vector<TileLayer> &layers,
+                              const std::vector<char> &paletteGlyphs, std::vector<MapError> &errors );
+
+    static char getCellGlyph( const TileLayer &layer, int index, const std::vector<char> &paletteGlyphs );
+
+    // for tools that work on glyphs only, without textures
+    static uint16_t resolveGlyphAsIndex( char glyph, const MapGlyph &info, const std::string &textureKey );
+    static const std::vector<char> &getGlyphIndexPalette();
+
+};
+
+/**
+ * Writes glyphs into layer cells, resolving each distinct glyph to a
+ * palette index only once. Shared by the text and the binary formats.
+ */
+class MapGlyphDecoder {
+
+    const MapFile::GlyphResolver &resolver;
+    int tileSetId;
+    std::array<int, 128> resolved;
+
+public:
+
+    MapGlyphDecoder( const MapFile::GlyphResolver &resolver, int tileSetId );
+
+    std::string setCell( TileLayer &layer, int index, unsigned char glyph );
+    std::string resolve( unsigned char glyph, uint16_t &tileId );
+
+};
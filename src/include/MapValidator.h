@@ -0,0 +1,27 @@
+/**
+ * @file MapValidator.h
+ * @author Prof. Dr. David Buzatto
+ * @brief MapValidator class declaration. Checks the rules the game needs
+ * beyond what the parser enforces: the map framed by '/' on the top and
+ * the sides, exactly one Mario start, course clear poles with both tops
+ * and bodies of the same height, and header values in range. Works on
+ * layers loaded with MapFile::resolveGlyphAsIndex, so it needs no
+ * textures. Errors point to the lines and columns of the text file.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MapFile.h"
+#include "TileLayer.h"
+
+class MapValidator {
+
+public:
+
+    static bool validate( const MapMetadata &metadata, const std::vector<TileLayer> &layers, std::vector<MapError> &errors );
+
+};
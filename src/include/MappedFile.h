@@ -0,0 +1,47 @@
+/**
+ * @file MappedFile.h
+ * @author Prof. Dr. David Buzatto
+ * @brief MappedFile class declaration. Maps a whole file read-only into
+ * memory (mmap on POSIX, a file mapping on Windows). Kept apart from raylib
+ * because windows.h clashes with its names.
+ *
+ * A file rewritten while it is mapped changes under the mapping: files
+ * replaced at run time must be written to a temporary file and renamed
+ * over the old one, which leaves the old mapping intact. On Windows the
+ * file is opened with FILE_SHARE_DELETE, so it can be renamed while
+ * mapped, but replacing it may still be refused; writers then move the
+ * old file aside first (see raymario-rrespack).
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+
+    const unsigned char *data;
+    size_t size;
+
+#if defined( _WIN32 )
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+
+public:
+
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile &operator=( const MappedFile& ) = delete;
+
+    bool open( const std::string &path );
+    void close();
+
+    bool isOpen() const;
+    const unsigned char *getData() const;
+    size_t getSize() const;
+
+};
@@ -8,24 +8,115 @@
 #pragma once
 
 #include "raylib.h"
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "rres.h"
+#include "AssetWatcher.h"
+#include "RresArchive.h"
+#include "ResourceRegistry.h"
+#include "TextureAtlas.h"
+#include "ThreadPool.h"
 
 class ResourceManager {
 
-    static std::map<std::string, Texture2D> textures;
-    static std::map<std::string, Sound> sounds;
-    static std::map<std::string, Music> musics;
-    static std::vector<void*> musicDataStreamDataPointers;
+    // where a watched image file goes when it changes on disk
+    struct ReloadTarget {
+        std::string key;
+        bool inAtlas;
+    };
 
-    static std::string centralDirLocation;
-    static rresCentralDir centralDir;
+    // decoded on the watcher thread, uploaded on the main thread
+    struct ReloadedImage {
+        std::string path;
+        Image image;
+    };
 
-    static void loadTextureFromResource( const std::string& fileName, const std::string& textureKey );
+    // an atlas image queued by loadTextures, decoded on a pool worker
+    struct ImageRequest {
+        std::string key;
+        std::string path;
+        std::string flippedKey;
+        Image image;
+        double milliseconds;
+    };
+
+    enum class LazyGroup {
+        textures,
+        musics
+    };
+
+    // a background or a music track, loaded the first time it is used
+    struct LazyResource {
+        std::string key;
+        std::string path;
+        bool loading;                   // queued on the loader
+        bool failed;
+        unsigned long long lastUse;
+        void *data;                     // the music stream may read from it
+    };
+
+    // read on the loader thread, uploaded on the main thread
+    struct LoadedResource {
+        LazyGroup group;
+        int handle;
+        Image image;
+        void *data;                     // owned, or nullptr
+        const unsigned char *bytes;     // in data or in the mapped archive
+        unsigned int dataSize;
+    };
+
+    // loaded resources kept per group, the least recently used goes first
+    static constexpr int LAZY_TEXTURE_BUDGET = 3;
+    static constexpr int LAZY_MUSIC_BUDGET = 3;
+
+    static ResourceRegistry<Texture2D> textures;
+    static ResourceRegistry<Sound> sounds;
+    static ResourceRegistry<Music> musics;
+    static TextureAtlas atlas;
+
+    static std::string archiveLocation;
+    static RresArchive archive;
+    static std::atomic<bool> archiveChanged;
+
+    static AssetWatcher watcher;
+    static std::map<std::string, ReloadTarget> reloadTargets;
+    static std::mutex reloadedImagesMutex;
+    static std::vector<ReloadedImage> reloadedImages;
+    static unsigned int assetRevision;
+    static std::vector<ImageRequest> imageRequests;
+
+    static std::map<int, LazyResource> lazyTextures;    // by registry handle
+    static std::map<int, LazyResource> lazyMusics;
+    static unsigned long long lazyUseCount;
+    static std::unique_ptr<ThreadPool> loader;
+    static std::mutex loadedResourcesMutex;
+    static std::vector<LoadedResource> loadedResources;
+
+    static Image loadImageFromResource( const std::string& fileName );
+    static void addAtlasImage( const std::string& key, const std::string& path, const std::string& flippedKey = "" );
+    static void decodeRequestedImage( ImageRequest& request );
+    static void loadRequestedImages();
+    static void addLazyTexture( const std::string& key, const std::string& path );
+    static void addLazyMusic( const std::string& key, const std::string& path );
+    static std::map<int, LazyResource> &getLazyGroup( LazyGroup group );
+    static bool isLazyResourceLoaded( LazyGroup group, int handle );
+    static LoadedResource readLazyResource( LazyGroup group, int handle, const std::string& path );
+    static void releaseLoadedResource( LoadedResource& resource );
+    static void uploadLazyResource( LoadedResource& resource );
+    static void unloadLazyResource( LazyGroup group, int handle );
+    static void evictLazyResources( LazyGroup group, int keepHandle );
+    static void useLazyResource( LazyGroup group, int handle );
+    static void prefetchLazyResource( LazyGroup group, int handle );
+    static void discardPrefetchedResources();
+    static void onArchiveChanged( const std::string& path );
+    static void reloadArchive();
+    static void decodeChangedImage( const std::string& path );
+    static void discardReloadedImages();
     static void loadSoundFromResource( const std::string& fileName, const std::string& soundKey );
-    static void loadMusicFromResource( const std::string& fileName, const std::string& musicKey );
 
     static void loadTextures();
     static void loadSounds();
@@ -46,10 +137,20 @@ class ResourceManager {
 public:
     static void loadResources();
     static void unloadResources();
+    static void applyReloadedImages();
+    static void applyPrefetchedResources();
+    static unsigned int getAssetRevision();
+
+    static ResourceRegistry<Texture2D> &getTextures();
+    static ResourceRegistry<Sound> &getSounds();
+    static ResourceRegistry<Music> &getMusics();
+    static TextureAtlas &getAtlas();
 
-    static std::map<std::string, Texture2D> &getTextures();
-    static std::map<std::string, Sound> &getSounds();
-    static std::map<std::string, Music> &getMusics();
+    // backgrounds and musics: loaded on first use, evicted when over budget
+    static const Texture2D &useTexture( int handle );
+    static const Music &useMusic( int handle );
+    static void prefetchTexture( int handle );
+    static void prefetchMusic( int handle );
 
     static bool loadFromRRES;
 
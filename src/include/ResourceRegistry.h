@@ -0,0 +1,102 @@
+/**
+ * @file ResourceRegistry.h
+ * @author Prof. Dr. David Buzatto
+ * @brief ResourceRegistry class template. Stores loaded resources in a dense
+ * array indexed by integer handles. Keys are resolved to handles only when
+ * resources are loaded or when a component is created, so per-frame lookups
+ * are plain array accesses.
+ *
+ * A handle is never reused for another key: unloading a resource only clears
+ * its slot, and loading the same key again fills the same slot.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+template<typename T>
+class ResourceRegistry {
+
+    std::map<std::string, int> handles;
+    std::vector<T> values;
+    std::vector<bool> loaded;
+    T emptyValue{};
+
+public:
+
+    static constexpr int INVALID_HANDLE = -1;
+
+    int reserve( const std::string &key ) {
+        const auto it = handles.find( key );
+        if ( it != handles.end() ) {
+            return it->second;
+        }
+        const int handle = static_cast<int>( values.size() );
+        handles.emplace( key, handle );
+        values.push_back( emptyValue );
+        loaded.push_back( false );
+        return handle;
+    }
+
+    int add( const std::string &key, const T &value ) {
+        const int handle = reserve( key );
+        values[handle] = value;
+        loaded[handle] = true;
+        return handle;
+    }
+
+    int getHandle( const std::string &key ) const {
+        const auto it = handles.find( key );
+        return it == handles.end() ? INVALID_HANDLE : it->second;
+    }
+
+    bool isLoaded( int handle ) const {
+        return handle >= 0 && handle < static_cast<int>( values.size() ) && loaded[handle];
+    }
+
+    bool contains( const std::string &key ) const {
+        return isLoaded( getHandle( key ) );
+    }
+
+    /**
+     * Returns an empty value for invalid or unloaded handles, so drawing
+     * with them is a no-op, as with a default constructed raylib resource.
+     */
+    const T &get( int handle ) const {
+        return isLoaded( handle ) ? values[handle] : emptyValue;
+    }
+
+    const T &get( const std::string &key ) const {
+        return get( getHandle( key ) );
+    }
+
+    void remove( int handle ) {
+        if ( isLoaded( handle ) ) {
+            values[handle] = emptyValue;
+            loaded[handle] = false;
+        }
+    }
+
+    void clear() {
+        for ( int i = 0; i < size(); i++ ) {
+            remove( i );
+        }
+    }
+
+    bool empty() const {
+        for ( bool l : loaded ) {
+            if ( l ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int size() const {
+        return static_cast<int>( values.size() );
+    }
+
+};
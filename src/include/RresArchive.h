@@ -0,0 +1,60 @@
+/**
+ * @file RresArchive.h
+ * @author Prof. Dr. David Buzatto
+ * @brief RresArchive class declaration. Reads resources from an rres file
+ * mapped once into memory. The chunks are indexed by id and the central
+ * directory by file name when the archive is opened, so finding a resource
+ * does not touch the file. Raw chunks (files packed as they are, like png
+ * or mp3) are returned as a pointer into the mapping, or decompressed
+ * straight from it when they are compressed with DEFLATE.
+ *
+ * Reading is thread safe while the archive is not opened, reloaded or
+ * closed.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "MappedFile.h"
+#include "rres.h"
+
+class RresArchive {
+
+public:
+
+    // the bytes of a raw resource, valid while the archive stays open
+    struct RawData {
+        const unsigned char *bytes;
+        unsigned int size;
+        std::string extension;      // with the dot, as LoadImageFromMemory wants
+        void *buffer;               // decompressed data to MemFree, or nullptr
+    };
+
+private:
+
+    std::string path;
+    MappedFile file;
+    std::unordered_map<unsigned int, size_t> chunkOffsets;     // id -> offset of its first chunk
+    std::map<std::string, unsigned int> resourceIds;           // central directory
+
+    bool readChunkInfo( unsigned int id, rresResourceChunkInfo &info, const unsigned char *&packed ) const;
+    void readCentralDirectory( const rresResourceChunkInfo &info, const unsigned char *packed );
+
+public:
+
+    bool open( const std::string &path );
+    bool reload();
+    void close();
+
+    bool isOpen() const;
+    int getResourceCount() const;
+    unsigned int getResourceId( const std::string &fileName ) const;
+
+    bool getRawData( unsigned int id, RawData &data ) const;
+    rresResourceChunk loadChunk( unsigned int id ) const;
+
+};
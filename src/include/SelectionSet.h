@@ -0,0 +1,86 @@
+/**
+ * @file SelectionSet.h
+ * @author Prof. Dr. David Buzatto
+ * @brief SelectionSet class declaration. The selected cells of a tile layer
+ * as a bitset with the same fixed stride as the layer (maxColumns), so a
+ * line span is one contiguous run of bits. Rectangles, clearing, counting
+ * and iteration work a 64 bit word at a time.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DirtyRegion.h"
+
+class SelectionSet {
+
+    int maxLines;
+    int maxColumns;
+    std::vector<uint64_t> words;
+
+    enum class RangeOperation {
+        set,
+        reset,
+        flip
+    };
+
+    void applyRange( int begin, int end, RangeOperation operation );
+    void applyRect( const DirtyRect &rect, RangeOperation operation );
+    int findFirst( int begin, int end ) const;
+    int findLast( int begin, int end ) const;
+
+public:
+
+    SelectionSet( int maxLines, int maxColumns );
+    ~SelectionSet();
+
+    bool test( int index ) const;
+    bool set( int index, bool selected );
+    void setRect( const DirtyRect &rect, bool selected );
+    void invertRect( const DirtyRect &rect );
+    void clear();
+
+    bool empty() const;
+    size_t count() const;
+    int getFirst() const;
+    DirtyRect getBounds() const;
+
+    /**
+     * Calls f( index ) for each selected cell, in index order, skipping
+     * empty words. Cells may be deselected by f while iterating.
+     */
+    template<typename F>
+    void forEach( F f ) const {
+        for ( size_t w = 0; w < words.size(); w++ ) {
+            for ( uint64_t bits = words[w]; bits != 0; bits &= bits - 1 ) {
+                f( static_cast<int>( w * 64 + std::countr_zero( bits ) ) );
+            }
+        }
+    }
+
+    /**
+     * Calls f( begin, end ) for each run [begin, end) of selected cells,
+     * in index order. Runs are split at word boundaries.
+     */
+    template<typename F>
+    void forEachRun( F f ) const {
+        for ( size_t w = 0; w < words.size(); w++ ) {
+            uint64_t bits = words[w];
+            while ( bits != 0 ) {
+                const int start = std::countr_zero( bits );
+                const int end = start + std::countr_one( bits >> start );
+                f( static_cast<int>( w * 64 + start ), static_cast<int>( w * 64 + end ) );
+                if ( end == 64 ) {
+                    break;
+                }
+                bits &= ~uint64_t( 0 ) << end;
+            }
+        }
+    }
+
+};
@@ -0,0 +1,75 @@
+/**
+ * @file TextureAtlas.h
+ * @author Prof. Dr. David Buzatto
+ * @brief TextureAtlas class declaration. Packs many small images into one or
+ * a few texture pages at load time and maps each image key to its page and
+ * source rectangle. Keys are resolved to integer handles when the images are
+ * added, so lookups during a frame are array accesses.
+ *
+ * A mirrored key shares the pixels of another one: its region has a
+ * negative source width, which raylib draws flipped horizontally. Sizes
+ * must be taken from fabs( source.width ).
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+
+struct AtlasRegion {
+    int page;
+    Rectangle source;
+};
+
+class TextureAtlas {
+
+    struct PendingImage {
+        int handle;
+        Image image;
+    };
+
+    int pageSize;
+    int padding;
+
+    std::vector<PendingImage> pendingImages;
+    std::deque<Texture2D> pages;
+    std::map<std::string, int> handles;
+    std::vector<std::string> keys;
+    std::vector<AtlasRegion> regions;
+    std::vector<int> mirrorOf;              // handle mirrored, or INVALID_HANDLE
+
+    int reserve( const std::string &key );
+    void resolveMirrors();
+
+    static void copyWithExtrusion( Image &page, const Image &image, int x, int y, int padding );
+
+public:
+
+    static constexpr int INVALID_HANDLE = -1;
+
+    TextureAtlas( int pageSize, int padding );
+    ~TextureAtlas();
+
+    int add( const std::string &key, Image image );
+    int addMirrored( const std::string &key, const std::string &sourceKey );
+    void build();
+    bool update( int handle, const Image &image );
+    void unload();
+
+    bool isBuilt() const;
+    bool contains( int handle ) const;
+    bool contains( const std::string &key ) const;
+    int getHandle( const std::string &key ) const;
+    const AtlasRegion &getRegion( int handle ) const;
+    const AtlasRegion &getRegion( const std::string &key ) const;
+    Texture2D *getPage( int page );
+    Texture2D *getTexture( int handle, Rectangle &source );
+    Texture2D *getTexture( const std::string &key, Rectangle &source );
+    int getPageCount() const;
+
+};
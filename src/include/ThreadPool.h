@@ -0,0 +1,64 @@
+/**
+ * @file ThreadPool.h
+ * @author Prof. Dr. David Buzatto
+ * @brief ThreadPool class declaration. A fixed set of worker threads, each
+ * one with its own task queue. Tasks are spread over the queues round
+ * robin; a worker takes the newest task of its own queue and, when it runs
+ * out, steals the oldest one of another queue, so uneven tasks (a huge map
+ * next to tiny ones) still keep every core busy.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    std::atomic<size_t> nextQueue;
+    std::atomic<int> queued;
+    int pending;
+    bool stopping;
+
+    bool takeTask( size_t self, std::function<void()> &task );
+    void workerLoop( size_t self );
+
+public:
+
+    // 0 uses one thread per core
+    explicit ThreadPool( int threadCount = 0 );
+    ~ThreadPool();
+
+    ThreadPool( const ThreadPool& ) = delete;
+    ThreadPool &operator=( const ThreadPool& ) = delete;
+
+    int getThreadCount() const;
+
+    void submit( std::function<void()> task );
+
+    // blocks until every submitted task has run; not to be called from a task
+    void wait();
+
+    // runs body( 0 ) .. body( count - 1 ) on the pool and waits for them
+    void parallelFor( int count, const std::function<void( int )> &body );
+
+};
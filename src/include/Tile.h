@@ -7,6 +7,8 @@
  */
 #pragma once
 
+#include <cstddef>
+
 #include "Drawable.h"
 #include "raylib.h"
 #include "TileCollisionType.h"
@@ -19,6 +21,7 @@ class Tile : public virtual Drawable {
     float alpha;
     bool drawSelection;
     Texture2D* texture;
+    Rectangle source;
     TileCollisionType collisionType;
     bool visible;
     bool selected;
@@ -31,6 +34,7 @@ public:
 
     Tile( Vector2 pos, Color color, float alpha, bool drawSelection, Vector2 mapEditorOffset, Vector2 drawOffset = Vector2( 0, 0 ) );
     Tile( Vector2 pos, Texture2D* texture, float alpha, bool drawSelection, Vector2 mapEditorOffset, Vector2 drawOffset = Vector2( 0, 0 ) );
+    Tile( Vector2 pos, Texture2D* texture, Rectangle source, float alpha, bool drawSelection, Vector2 mapEditorOffset, Vector2 drawOffset = Vector2( 0, 0 ) );
     virtual ~Tile();
 
     void inputAndUpdate();
@@ -42,6 +46,7 @@ public:
     Vector2& getPos();
     Vector2& getDim();
     Rectangle getRectangle() const;
+    Vector2& getDrawOffset();
 
     void setPos( Vector2 pos );
     void setPos( int x, int y );
@@ -55,7 +60,9 @@ public:
     void setAlpha( float alpha );
 
     Texture2D* getTexture();
+    Rectangle& getSource();
     void setTexture( Texture2D* texture );
+    void setTexture( Texture2D* texture, Rectangle source );
 
     bool isSelected() const;
     void setSelected( bool selected );
@@ -67,6 +74,8 @@ public:
     void setCollisionType( TileCollisionType collisionType );
 
     void copyData( Tile& tile, TileCollisionType collisionType, bool visible );
+    bool hasSameData( const Tile& tile ) const;
+    size_t getDataHash() const;
 
     static TileCollisionType getCollisionTypeFromInt( int collisionTypeInt );
     static void resetTile( Tile& tile, bool deselect = false );
@@ -0,0 +1,31 @@
+/**
+ * @file TileBatchRenderer.h
+ * @author Prof. Dr. David Buzatto
+ * @brief TileBatchRenderer class declaration. Draws each layer as a batch of
+ * textured quads through rlgl. The palette tiles point into the pages of the
+ * resource texture atlas, so a whole viewport usually needs one texture bind.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <vector>
+
+#include "raylib.h"
+#include "Tile.h"
+#include "TileLayer.h"
+
+class TileBatchRenderer {
+
+    int whiteHandle;
+
+public:
+
+    TileBatchRenderer();
+    ~TileBatchRenderer();
+
+    void drawLayer( const TileLayer &layer, std::vector<Tile> &palette,
+                    int startLine, int startColumn, int viewLines, int viewColumns,
+                    int x, int y, int tileWidth, bool applyDrawOffset );
+
+};
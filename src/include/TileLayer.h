@@ -0,0 +1,95 @@
+/**
+ * @file TileLayer.h
+ * @author Prof. Dr. David Buzatto
+ * @brief TileLayer class declaration. A dense grid of compact cells, each
+ * one storing a tile palette index and packed collision/visibility bits in
+ * contiguous arrays, plus a selection bitset. Everything is allocated once
+ * with the maximum capacity of the map (maxLines x maxColumns), so resizing
+ * never allocates.
+ * A revision counter is bumped whenever the tiles change, so cached drawings
+ * of the layer know when they are stale, and subscribed listeners are told
+ * which cells changed.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "DirtyRegion.h"
+#include "SelectionSet.h"
+#include "TileCollisionType.h"
+
+class TileLayer {
+
+    int maxLines;
+    int maxColumns;
+    int lines;
+    int columns;
+    unsigned int revision;
+
+    std::vector<uint16_t> tileIds;
+    std::vector<uint8_t> flags;
+    SelectionSet selection;
+
+public:
+
+    static constexpr uint8_t TILES_CHANGED = 0x01;
+    static constexpr uint8_t SELECTION_CHANGED = 0x02;
+
+    using ChangeListener = std::function<void( const DirtyRect &rect, uint8_t changes )>;
+
+private:
+
+    std::vector<std::pair<int, ChangeListener>> listeners;
+    int nextListenerId;
+
+    void notify( const DirtyRect &rect, uint8_t changes );
+
+public:
+
+    static constexpr uint16_t EMPTY_TILE = 0;
+
+    static constexpr uint8_t COLLISION_MASK = 0x03;
+    static constexpr uint8_t VISIBLE_FLAG = 0x04;
+    static constexpr uint8_t DEFAULT_FLAGS = static_cast<uint8_t>( TileCollisionType::non_solid ) | VISIBLE_FLAG;
+
+    TileLayer( int maxLines, int maxColumns, int lines, int columns );
+    ~TileLayer();
+
+    int getMaxLines() const;
+    int getMaxColumns() const;
+    int getLines() const;
+    int getColumns() const;
+    int getIndex( int line, int column ) const;
+    unsigned int getRevision() const;
+
+    uint16_t getTileId( int index ) const;
+    TileCollisionType getCollisionType( int index ) const;
+    bool isVisible( int index ) const;
+    bool isSelected( int index ) const;
+
+    uint32_t getCell( int index ) const;
+    void setCell( int index, uint32_t cell );
+
+    void setTile( int index, uint16_t tileId, TileCollisionType collisionType, bool visible );
+    void resetTile( int index, bool deselect = false );
+    void setSelected( int index, bool selected );
+    void selectRect( const DirtyRect &rect, bool selected );
+    void invertSelection();
+    void deselectAll();
+    const SelectionSet &getSelection() const;
+
+    void resize( int newLines, int newColumns );
+    void replicate( const DirtyRect &source, const DirtyRect &target );
+    void replicateSelection( bool left, bool right, bool up, bool down );
+    int floodFill( int index, uint16_t tileId, TileCollisionType collisionType, bool visible );
+    int fillSelection( uint16_t tileId, TileCollisionType collisionType, bool visible );
+
+    int subscribe( ChangeListener listener );
+    void unsubscribe( int listenerId );
+
+};
@@ -15,7 +15,6 @@
 double toRadians( double degrees );
 double toDegrees( double radians );
 
-Texture2D texture2DFlipHorizontal( Texture2D texture );
 Texture2D textureColorReplace( Texture2D texture, Color targetColor, Color newColor );
 Texture2D textureColorReplace( Texture2D texture, std::vector<Color> replacePallete );
 
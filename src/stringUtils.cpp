@@ -0,0 +1,46 @@
+/**
+ * @file stringUtils.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief String utility functions implementation (declared in utils.h).
+ * Kept apart from utils.cpp so the headless tools can link them without
+ * raylib.
+ * 
+ * @copyright Copyright (c) 2024
+ */
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+
+std::vector<std::string> split( std::string s, std::string delimiter ) {
+
+    size_t pos_start = 0;
+    size_t pos_end;
+    size_t delimLen = delimiter.length();
+
+    std::vector<std::string> res;
+
+    while ( ( pos_end = s.find( delimiter, pos_start ) ) != std::string::npos ) {
+        std::string token = s.substr( pos_start, pos_end - pos_start );
+        pos_start = pos_end + delimLen;
+        res.push_back( token );
+    }
+
+    res.push_back( s.substr( pos_start ) );
+    return res;
+
+}
+
+std::vector<std::string> split( const std::string& s, char delim ) {
+
+    std::vector<std::string> result;
+    std::stringstream ss( s );
+    std::string item;
+
+    while ( getline( ss, item, delim ) ) {
+        result.push_back( item );
+    }
+
+    return result;
+}
\ No newline at end of file
@@ -10,7 +10,6 @@
 #include "utils.h"
 #include <map>
 #include <string>
-#include <sstream>
 #include <vector>
 
 double toRadians( double degrees ) {
@@ -21,14 +20,6 @@ double toDegrees( double radians ) {
     return radians * 180.0 / PI;
 }
 
-Texture2D texture2DFlipHorizontal( Texture2D texture ) {
-    Image img = LoadImageFromTexture( texture );
-    ImageFlipHorizontal( &img );
-    Texture2D newTexture = LoadTextureFromImage( img );
-    UnloadImage( img );
-    return newTexture;
-}
-
 Texture2D textureColorReplace( Texture2D texture, Color targetColor, Color newColor ) {
     Image img = LoadImageFromTexture( texture );
     ImageColorReplace( &img, targetColor, newColor );
@@ -56,7 +47,7 @@ void drawYellowSmallNumber( int number, int x, int y ) {
 }
 
 void drawSmallNumber( int number, int x, int y, std::string textureId ) {
-    Texture2D texture = ResourceManager::getTextures()[textureId];
+    Texture2D texture = ResourceManager::getTextures().get( textureId );
     int w = 18;
     int h = 14;
     std::string str = std::to_string( number );
@@ -68,7 +59,7 @@ void drawSmallNumber( int number, int x, int y, std::string textureId ) {
 }
 
 void drawBigNumber( int number, int x, int y ) {
-    Texture2D texture = ResourceManager::getTextures()["guiNumbersBig"];
+    Texture2D texture = ResourceManager::getTextures().get( "guiNumbersBig" );
     int w = 18;
     int h = 28;
     std::string str = std::to_string( number );
@@ -81,7 +72,7 @@ void drawBigNumber( int number, int x, int y ) {
 
 void drawString( std::string str, int x, int y ) {
 
-    Texture2D texture = ResourceManager::getTextures()["guiAlfa"];
+    Texture2D texture = ResourceManager::getTextures().get( "guiAlfa" );
     int w = 18;
     int h = 20;
     int px = x;
@@ -133,7 +124,7 @@ void drawString( std::string str, int x, int y ) {
 
 void drawString( std::wstring str, int x, int y ) {
 
-    const Texture2D texture = ResourceManager::getTextures()["guiAlfa"];
+    const Texture2D texture = ResourceManager::getTextures().get( "guiAlfa" );
     int w = 18;
     int h = 20;
     int px = x;
@@ -224,7 +215,7 @@ int getDrawStringHeight() {
 
 void drawMessageString( std::string str, int x, int y ) {
 
-    const Texture2D texture = ResourceManager::getTextures()["guiAlfaLowerUpper"];
+    const Texture2D texture = ResourceManager::getTextures().get( "guiAlfaLowerUpper" );
     int w = 16;
     int h = 16;
     int px = x;
@@ -285,35 +276,3 @@ int getDrawMessageStringWidth( std::string str ) {
 int getDrawMessageStringHeight() {
     return 16;
 }
-
-std::vector<std::string> split( std::string s, std::string delimiter ) {
-
-    size_t pos_start = 0;
-    size_t pos_end;
-    size_t delimLen = delimiter.length();
-
-    std::vector<std::string> res;
-
-    while ( ( pos_end = s.find( delimiter, pos_start ) ) != std::string::npos ) {
-        std::string token = s.substr( pos_start, pos_end - pos_start );
-        pos_start = pos_end + delimLen;
-        res.push_back( token );
-    }
-
-    res.push_back( s.substr( pos_start ) );
-    return res;
-
-}
-
-std::vector<std::string> split( const std::string& s, char delim ) {
-
-    std::vector<std::string> result;
-    std::stringstream ss( s );
-    std::string item;
-
-    while ( getline( ss, item, delim ) ) {
-        result.push_back( item );
-    }
-
-    return result;
-}
\ No newline at end of file
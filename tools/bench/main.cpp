@@ -0,0 +1,344 @@
+/**
+ * @file main.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief raymario-bench: times the editor hot paths on the map model,
+ * without a window, and counts the heap allocations of each one. Every
+ * benchmark is run until it has taken at least MIN_TIME and reported as
+ * ns/op and allocs/op.
+ *
+ * usage:
+ *    raymario-bench [--baseline file.json] [--save file.json] [--filter text]
+ *
+ * With --baseline the results are compared with a stored run: a benchmark
+ * regresses when it is more than 20% slower or allocates more. The exit
+ * code is 1 when anything regressed. tools/bench/baseline.json is the
+ * committed baseline (make bench compares with it); refresh it with
+ * --save when a change is meant to move the numbers.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "MapFile.h"
+#include "TileLayer.h"
+#include "utils.h"
+
+// every allocation of the process goes through here while it runs
+static std::atomic<long long> allocationCount( 0 );
+
+// gcc pairs the replaced operators with malloc/free and warns about it
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void *operator new( size_t size ) {
+    allocationCount++;
+    if ( void *p = std::malloc( size == 0 ? 1 : size ) ) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete( void *p ) noexcept {
+    std::free( p );
+}
+
+void operator delete( void *p, size_t ) noexcept {
+    std::free( p );
+}
+
+#pragma GCC diagnostic pop
+
+// same sizes as the editor
+static constexpr int MAX_LINES = 40;
+static constexpr int MAX_COLUMNS = 400;
+static constexpr int MAX_LAYERS = 7;
+static constexpr int MIN_LINES = 14;
+static constexpr int MIN_COLUMNS = 18;
+
+static constexpr double MIN_TIME = 0.25;    // seconds per benchmark
+static constexpr double SLOWER_THRESHOLD = 1.2;
+
+struct BenchResult {
+    std::string name;
+    double nsPerOp;
+    double allocsPerOp;
+    long long iterations;
+};
+
+// keeps results alive so the optimizer cannot drop the work
+static volatile long long sink = 0;
+
+static BenchResult runBenchmark( const std::string &name, const std::function<void()> &setup, const std::function<void()> &op ) {
+
+    using Clock = std::chrono::steady_clock;
+
+    setup();
+    op();  // warm up
+
+    long long iterations = 0;
+    long long allocations = 0;
+    double elapsed = 0;
+
+    // batches grow until the time is measurable, setup is not timed
+    for ( long long batch = 1; elapsed < MIN_TIME; batch *= 2 ) {
+        setup();
+        const long long allocationsBefore = allocationCount;
+        const auto start = Clock::now();
+        for ( long long i = 0; i < batch; i++ ) {
+            op();
+        }
+        elapsed += std::chrono::duration<double>( Clock::now() - start ).count();
+        allocations += allocationCount - allocationsBefore;
+        iterations += batch;
+    }
+
+    return BenchResult( name, elapsed * 1e9 / iterations, static_cast<double>( allocations ) / iterations, iterations );
+
+}
+
+static std::string readFile( const std::string &path ) {
+    std::ifstream file( path, std::ios::binary );
+    return std::string( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+}
+
+static std::vector<TileLayer> createLayers() {
+    std::vector<TileLayer> layers;
+    for ( int k = 0; k < MAX_LAYERS; k++ ) {
+        layers.emplace_back( MAX_LINES, MAX_COLUMNS, MAX_LINES, MAX_COLUMNS );
+    }
+    return layers;
+}
+
+static std::vector<BenchResult> runAll( const std::string &filter ) {
+
+    std::vector<BenchResult> results;
+    const auto add = [&]( const std::string &name, const std::function<void()> &setup, const std::function<void()> &op ) {
+        if ( name.find( filter ) != std::string::npos ) {
+            results.push_back( runBenchmark( name, setup, op ) );
+            std::printf( "%-28s %12.1f ns/op %10.2f allocs/op\n", name.c_str(), results.back().nsPerOp, results.back().allocsPerOp );
+        }
+    };
+    const auto noSetup = [] {};
+
+    std::vector<TileLayer> layers = createLayers();
+    TileLayer &layer = layers[0];
+
+    add( "construct 7x40x400", noSetup, [] {
+        const std::vector<TileLayer> created = createLayers();
+        sink = sink + created.size();
+    });
+
+    // what the lines/columns spinners do to every layer
+    int step = 0;
+    add( "relocate sweep 7 layers", noSetup, [&] {
+        step++;
+        for ( auto &l : layers ) {
+            l.resize( MIN_LINES + step % ( MAX_LINES - MIN_LINES + 1 ), MIN_COLUMNS + step % ( MAX_COLUMNS - MIN_COLUMNS + 1 ) );
+        }
+    });
+
+    add( "paint full map", [&] { layer.resize( MAX_LINES, MAX_COLUMNS ); }, [&] {
+        step++;
+        for ( int p = 0; p < MAX_LINES * MAX_COLUMNS; p++ ) {
+            layer.setTile( p, static_cast<uint16_t>( 1 + step % 8 ), TileCollisionType::solid, true );
+        }
+    });
+
+    add( "select cells + deselect", [&] { layer.resize( MAX_LINES, MAX_COLUMNS ); }, [&] {
+        for ( int p = 0; p < MAX_LINES * MAX_COLUMNS; p++ ) {
+            layer.setSelected( p, true );
+        }
+        layer.deselectAll();
+    });
+
+    add( "select rect + deselect", [&] { layer.resize( MAX_LINES, MAX_COLUMNS ); }, [&] {
+        layer.selectRect( DirtyRect( 0, 0, MAX_LINES, MAX_COLUMNS ), true );
+        layer.deselectAll();
+    });
+
+    // the cells drawLayerPreview reads, for all layers
+    add( "preview traversal 7 layers", [&] {
+        for ( auto &l : layers ) {
+            l.resize( MAX_LINES, MAX_COLUMNS );
+            for ( int p = 0; p < MAX_LINES * MAX_COLUMNS; p += 3 ) {
+                l.setTile( p, 2, TileCollisionType::solid, p % 2 == 0 );
+            }
+        }
+    }, [&] {
+        long long visible = 0;
+        for ( const auto &l : layers ) {
+            for ( int i = MAX_LINES - MIN_LINES; i < MAX_LINES; i++ ) {
+                for ( int j = 0; j < MIN_COLUMNS; j++ ) {
+                    const int p = l.getIndex( i, j );
+                    if ( l.getTileId( p ) != TileLayer::EMPTY_TILE && l.isVisible( p ) ) {
+                        visible++;
+                    }
+                }
+            }
+        }
+        sink = sink + visible;
+    });
+
+    add( "flood fill 40x400", [&] { layer.resize( MAX_LINES, MAX_COLUMNS ); }, [&] {
+        step++;
+        sink = sink + layer.floodFill( 0, static_cast<uint16_t>( 1 + step % 2 ), TileCollisionType::solid, true );
+    });
+
+    const std::string text = readFile( "resources/maps/map1.txt" );
+
+    if ( text.empty() ) {
+        std::fprintf( stderr, "resources/maps/map1.txt not found, run from the project folder\n" );
+        return results;
+    }
+
+    MapMetadata metadata;
+    std::vector<MapError> errors;
+
+    add( "parse map1.txt", noSetup, [&] {
+        errors.clear();
+        MapFile::parse( text, metadata, layer, MapFile::resolveGlyphAsIndex, errors );
+    });
+
+    const std::vector<TileLayer> parsed( 1, layer );
+    add( "write map1.txt", noSetup, [&] {
+        errors.clear();
+        sink = sink + MapFile::write( metadata, parsed, MapFile::getGlyphIndexPalette(), errors ).size();
+    });
+
+    add( "split map1.txt by string", noSetup, [&] {
+        sink = sink + split( text, "\n" ).size();
+    });
+
+    add( "split map1.txt by char", noSetup, [&] {
+        sink = sink + split( text, '\n' ).size();
+    });
+
+    return results;
+
+}
+
+static bool saveResults( const std::string &path, const std::vector<BenchResult> &results ) {
+
+    std::ofstream file( path, std::ios::binary );
+
+    file << "{\n  \"benchmarks\": [";
+    for ( size_t i = 0; i < results.size(); i++ ) {
+        char line[256];
+        std::snprintf( line, sizeof( line ), "%s\n    { \"name\": \"%s\", \"nsPerOp\": %.1f, \"allocsPerOp\": %.2f }",
+                       i == 0 ? "" : ",", results[i].name.c_str(), results[i].nsPerOp, results[i].allocsPerOp );
+        file << line;
+    }
+    file << "\n  ]\n}\n";
+
+    return static_cast<bool>( file );
+
+}
+
+/**
+ * Reads back what saveResults writes: one benchmark object per line.
+ */
+static std::map<std::string, BenchResult> loadResults( const std::string &path ) {
+
+    std::map<std::string, BenchResult> results;
+    std::ifstream file( path );
+    std::string line;
+
+    while ( std::getline( file, line ) ) {
+
+        const size_t nameStart = line.find( "\"name\": \"" );
+        const size_t nsStart = line.find( "\"nsPerOp\": " );
+        const size_t allocsStart = line.find( "\"allocsPerOp\": " );
+
+        if ( nameStart == std::string::npos || nsStart == std::string::npos || allocsStart == std::string::npos ) {
+            continue;
+        }
+
+        const size_t nameEnd = line.find( '"', nameStart + 9 );
+        const std::string name = line.substr( nameStart + 9, nameEnd - nameStart - 9 );
+        results[name] = BenchResult( name, std::atof( line.c_str() + nsStart + 11 ), std::atof( line.c_str() + allocsStart + 15 ), 0 );
+
+    }
+
+    return results;
+
+}
+
+int main( int argc, char *argv[] ) {
+
+    std::string baselinePath;
+    std::string savePath;
+    std::string filter;
+
+    for ( int i = 1; i < argc; i++ ) {
+        const std::string arg = argv[i];
+        if ( arg == "--baseline" && i + 1 < argc ) {
+            baselinePath = argv[++i];
+        } else if ( arg == "--save" && i + 1 < argc ) {
+            savePath = argv[++i];
+        } else if ( arg == "--filter" && i + 1 < argc ) {
+            filter = argv[++i];
+        } else {
+            std::fprintf( stderr, "usage: raymario-bench [--baseline file.json] [--save file.json] [--filter text]\n" );
+            return 2;
+        }
+    }
+
+    const std::vector<BenchResult> results = runAll( filter );
+
+    if ( !savePath.empty() && !saveResults( savePath, results ) ) {
+        std::fprintf( stderr, "could not write %s\n", savePath.c_str() );
+        return 1;
+    }
+
+    if ( baselinePath.empty() ) {
+        return 0;
+    }
+
+    const std::map<std::string, BenchResult> baseline = loadResults( baselinePath );
+
+    if ( baseline.empty() ) {
+        std::fprintf( stderr, "no baseline in %s\n", baselinePath.c_str() );
+        return 1;
+    }
+
+    int regressions = 0;
+    std::printf( "\ncompared with %s:\n", baselinePath.c_str() );
+
+    for ( const auto &result : results ) {
+
+        const auto it = baseline.find( result.name );
+        if ( it == baseline.end() ) {
+            std::printf( "%-28s new\n", result.name.c_str() );
+            continue;
+        }
+
+        const BenchResult &base = it->second;
+        const bool slower = result.nsPerOp > base.nsPerOp * SLOWER_THRESHOLD;
+        const bool allocates = result.allocsPerOp > base.allocsPerOp + 0.005;
+
+        std::printf( "%-28s %+7.1f%% time %+9.2f allocs/op%s\n", result.name.c_str(),
+                     ( result.nsPerOp / base.nsPerOp - 1 ) * 100, result.allocsPerOp - base.allocsPerOp,
+                     slower || allocates ? "  REGRESSION" : "" );
+
+        if ( slower || allocates ) {
+            regressions++;
+        }
+
+    }
+
+    std::printf( "%d regression(s)\n", regressions );
+
+    return regressions > 0 ? 1 : 0;
+
+}
@@ -0,0 +1,425 @@
+/**
+ * @file main.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief raymario-mapctl: validates, converts, normalizes and summarizes
+ * RayMario maps without opening a window. Links only the map model and
+ * its I/O (MapFile, MapBinaryFile, TileLayer), so it can run on a build
+ * server over a whole directory of maps, one file per core.
+ *
+ * usage:
+ *    raymario-mapctl validate <paths...> [-j N] [--report file.json]
+ *    raymario-mapctl convert <paths...> --to text|binary [--out dir] [-j N]
+ *    raymario-mapctl stats <paths...> [-j N]
+ *    raymario-mapctl normalize <paths...> [-j N]
+ *
+ * Directories are expanded to the .txt and .rmap files directly inside
+ * them. The exit code is 1 when any file had errors. Every command can
+ * also write its results as JSON with --report.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "MapBinaryFile.h"
+#include "MapFile.h"
+#include "MapValidator.h"
+#include "ThreadPool.h"
+#include "TileLayer.h"
+
+namespace fs = std::filesystem;
+
+// same capacity as the editor, so a map that passes here loads there too
+static constexpr int MAX_LINES = 40;
+static constexpr int MAX_COLUMNS = 400;
+static constexpr int MAX_LAYERS = 7;
+
+enum class Command {
+    validate,
+    convert,
+    stats,
+    normalize
+};
+
+struct Options {
+    Command command;
+    std::vector<std::string> files;
+    bool toBinary = false;
+    std::string outDir;
+    std::string reportPath;
+    int jobs = 0;
+};
+
+struct FileResult {
+    std::vector<MapError> errors;
+    std::string output;
+};
+
+static bool isBinaryPath( const std::string &path ) {
+    return fs::path( path ).extension() == ".rmap";
+}
+
+static bool readFile( const std::string &path, std::string &content ) {
+    std::ifstream file( path, std::ios::binary );
+    if ( !file ) {
+        return false;
+    }
+    content.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+    return true;
+}
+
+/**
+ * Loads a map with each glyph as its own palette index, the way the
+ * editor would, but without textures.
+ */
+static bool loadMap( const std::string &path, MapMetadata &metadata, std::vector<TileLayer> &layers, std::vector<MapError> &errors ) {
+
+    for ( int k = 0; k < MAX_LAYERS; k++ ) {
+        layers.emplace_back( MAX_LINES, MAX_COLUMNS, 0, 0 );
+    }
+
+    if ( isBinaryPath( path ) ) {
+        return MapBinaryFile::load( path, metadata, layers, MapFile::resolveGlyphAsIndex, MapBinaryFile::resolveColorAsIndex, errors );
+    }
+    return MapFile::load( path, metadata, layers[0], MapFile::resolveGlyphAsIndex, errors );
+
+}
+
+static void validateFile( const std::string &path, FileResult &result ) {
+    MapMetadata metadata;
+    std::vector<TileLayer> layers;
+    loadMap( path, metadata, layers, result.errors );
+    MapValidator::validate( metadata, layers, result.errors );
+}
+
+static void convertFile( const std::string &path, const Options &options, FileResult &result ) {
+
+    if ( isBinaryPath( path ) == options.toBinary ) {
+        result.output = "skipped, already " + std::string( options.toBinary ? "binary" : "text" );
+        return;
+    }
+
+    fs::path target = fs::path( path ).replace_extension( options.toBinary ? ".rmap" : ".txt" );
+    if ( !options.outDir.empty() ) {
+        target = fs::path( options.outDir ) / target.filename();
+    }
+
+    const bool ok = options.toBinary ?
+        MapBinaryFile::convertTextToBinary( path, target.string(), result.errors ) :
+        MapBinaryFile::convertBinaryToText( path, target.string(), result.errors );
+
+    if ( ok ) {
+        result.output = "-> " + target.string();
+    }
+
+}
+
+static void statsFile( const std::string &path, FileResult &result ) {
+
+    const auto start = std::chrono::steady_clock::now();
+
+    MapMetadata metadata;
+    std::vector<TileLayer> layers;
+    loadMap( path, metadata, layers, result.errors );
+
+    const auto end = std::chrono::steady_clock::now();
+
+    int usedLayers = 0;
+    int cells = 0;
+    std::array<bool, 128> glyphs{};
+
+    for ( const auto &layer : layers ) {
+        int layerCells = 0;
+        for ( int i = 0; i < layer.getLines(); i++ ) {
+            for ( int j = 0; j < layer.getColumns(); j++ ) {
+                const uint16_t tileId = layer.getTileId( layer.getIndex( i, j ) );
+                if ( tileId != TileLayer::EMPTY_TILE ) {
+                    glyphs[tileId & 0x7F] = true;
+                    layerCells++;
+                }
+            }
+        }
+        if ( layerCells > 0 ) {
+            usedLayers++;
+        }
+        cells += layerCells;
+    }
+
+    std::error_code ec;
+    const auto fileSize = fs::file_size( path, ec );
+
+    char buffer[256];
+    std::snprintf( buffer, sizeof( buffer ), "%dx%d, %d layer(s), %d cell(s), %d glyph(s), %llu bytes, %.3f ms",
+                   layers[0].getLines(), layers[0].getColumns(), usedLayers, cells,
+                   static_cast<int>( std::count( glyphs.begin(), glyphs.end(), true ) ),
+                   static_cast<unsigned long long>( ec ? 0 : fileSize ),
+                   std::chrono::duration<double, std::milli>( end - start ).count() );
+    result.output = buffer;
+
+}
+
+/**
+ * Rewrites a map in the form the editor saves it. The file is only
+ * replaced when its bytes change, and never when it had errors, since
+ * whatever could not be read would be lost.
+ */
+static void normalizeFile( const std::string &path, FileResult &result ) {
+
+    MapMetadata metadata;
+    std::vector<TileLayer> layers;
+
+    if ( !loadMap( path, metadata, layers, result.errors ) ) {
+        return;
+    }
+
+    std::string before;
+    if ( !readFile( path, before ) ) {
+        result.errors.emplace_back( 0, 0, "could not read " + path );
+        return;
+    }
+
+    const std::string temp = path + ".tmp";
+    const bool saved = isBinaryPath( path ) ?
+        MapBinaryFile::save( temp, metadata, layers, MapFile::getGlyphIndexPalette(), {}, result.errors ) :
+        MapFile::save( temp, metadata, layers, MapFile::getGlyphIndexPalette(), result.errors );
+
+    std::string after;
+    std::error_code ec;
+
+    if ( !saved || !readFile( temp, after ) ) {
+        fs::remove( temp, ec );
+        return;
+    }
+
+    if ( after == before ) {
+        fs::remove( temp, ec );
+        result.output = "unchanged";
+        return;
+    }
+
+    fs::rename( temp, path, ec );
+    if ( ec ) {
+        fs::remove( temp, ec );
+        result.errors.emplace_back( 0, 0, "could not replace " + path );
+        return;
+    }
+
+    result.output = "normalized";
+
+}
+
+static void processFile( const std::string &path, const Options &options, FileResult &result ) {
+    switch ( options.command ) {
+        case Command::validate: validateFile( path, result ); break;
+        case Command::convert: convertFile( path, options, result ); break;
+        case Command::stats: statsFile( path, result ); break;
+        case Command::normalize: normalizeFile( path, result ); break;
+    }
+}
+
+static bool expandPath( const std::string &path, std::vector<std::string> &files ) {
+
+    std::error_code ec;
+
+    if ( !fs::is_directory( path, ec ) ) {
+        files.push_back( path );
+        return true;
+    }
+
+    std::vector<std::string> found;
+    for ( const auto &entry : fs::directory_iterator( path, ec ) ) {
+        const auto extension = entry.path().extension();
+        if ( entry.is_regular_file() && ( extension == ".txt" || extension == ".rmap" ) ) {
+            found.push_back( entry.path().string() );
+        }
+    }
+
+    std::sort( found.begin(), found.end() );
+    files.insert( files.end(), found.begin(), found.end() );
+
+    return !ec;
+
+}
+
+static std::string jsonString( const std::string &value ) {
+
+    std::string out = "\"";
+
+    for ( const char c : value ) {
+        switch ( c ) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ( static_cast<unsigned char>( c ) < 0x20 ) {
+                    char escaped[8];
+                    std::snprintf( escaped, sizeof( escaped ), "\\u%04x", c );
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+
+    return out + '"';
+
+}
+
+/**
+ * One object per file, in input order, with its errors; the totals at the
+ * end let a build step fail without parsing the whole list.
+ */
+static bool writeReport( const std::string &path, const Options &options, const std::vector<FileResult> &results, int failed, double seconds ) {
+
+    std::string json = "{\n  \"files\": [";
+
+    for ( size_t i = 0; i < results.size(); i++ ) {
+
+        const FileResult &result = results[i];
+        json += i == 0 ? "\n" : ",\n";
+        json += "    { \"path\": " + jsonString( options.files[i] ) +
+                ", \"ok\": " + ( result.errors.empty() ? "true" : "false" );
+
+        if ( !result.output.empty() ) {
+            json += ", \"result\": " + jsonString( result.output );
+        }
+
+        json += ", \"errors\": [";
+        for ( size_t e = 0; e < result.errors.size(); e++ ) {
+            const MapError &error = result.errors[e];
+            json += ( e == 0 ? "\n" : ",\n" );
+            json += "      { \"line\": " + std::to_string( error.line ) +
+                    ", \"column\": " + std::to_string( error.column ) +
+                    ", \"message\": " + jsonString( error.message ) + " }";
+        }
+        json += result.errors.empty() ? "] }" : "\n    ] }";
+
+    }
+
+    char totals[128];
+    std::snprintf( totals, sizeof( totals ), "\n  ],\n  \"total\": %zu,\n  \"failed\": %d,\n  \"seconds\": %.3f\n}\n",
+                   results.size(), failed, seconds );
+    json += totals;
+
+    std::ofstream file( path, std::ios::binary );
+    return file && file.write( json.data(), static_cast<std::streamsize>( json.size() ) );
+
+}
+
+static void printUsage() {
+    std::fprintf( stderr,
+        "usage:\n"
+        "   raymario-mapctl validate <paths...> [-j N] [--report file.json]\n"
+        "   raymario-mapctl convert <paths...> --to text|binary [--out dir] [-j N]\n"
+        "   raymario-mapctl stats <paths...> [-j N]\n"
+        "   raymario-mapctl normalize <paths...> [-j N]\n" );
+}
+
+static bool parseOptions( int argc, char *argv[], Options &options ) {
+
+    if ( argc < 3 ) {
+        return false;
+    }
+
+    const std::string command = argv[1];
+    if ( command == "validate" ) {
+        options.command = Command::validate;
+    } else if ( command == "convert" ) {
+        options.command = Command::convert;
+    } else if ( command == "stats" ) {
+        options.command = Command::stats;
+    } else if ( command == "normalize" ) {
+        options.command = Command::normalize;
+    } else {
+        return false;
+    }
+
+    bool hasTarget = false;
+
+    for ( int i = 2; i < argc; i++ ) {
+        const std::string arg = argv[i];
+        if ( arg == "-j" && i + 1 < argc ) {
+            options.jobs = std::max( std::atoi( argv[++i] ), 1 );
+        } else if ( arg == "--to" && i + 1 < argc ) {
+            const std::string to = argv[++i];
+            if ( to != "text" && to != "binary" ) {
+                return false;
+            }
+            options.toBinary = to == "binary";
+            hasTarget = true;
+        } else if ( arg == "--out" && i + 1 < argc ) {
+            options.outDir = argv[++i];
+        } else if ( arg == "--report" && i + 1 < argc ) {
+            options.reportPath = argv[++i];
+        } else if ( !arg.empty() && arg[0] == '-' ) {
+            return false;
+        } else if ( !expandPath( arg, options.files ) ) {
+            std::fprintf( stderr, "could not read directory %s\n", arg.c_str() );
+        }
+    }
+
+    return options.command != Command::convert || hasTarget;
+
+}
+
+int main( int argc, char *argv[] ) {
+
+    Options options;
+
+    if ( !parseOptions( argc, argv, options ) ) {
+        printUsage();
+        return 2;
+    }
+
+    if ( !options.outDir.empty() ) {
+        std::error_code ec;
+        fs::create_directories( options.outDir, ec );
+    }
+
+    // one task per file; results are kept and printed in input order
+    std::vector<FileResult> results( options.files.size() );
+    const auto start = std::chrono::steady_clock::now();
+
+    {
+        ThreadPool pool( options.jobs );
+        pool.parallelFor( static_cast<int>( options.files.size() ), [&]( int i ) {
+            processFile( options.files[i], options, results[i] );
+        });
+    }
+
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    int failed = 0;
+
+    for ( size_t i = 0; i < results.size(); i++ ) {
+        const FileResult &result = results[i];
+        if ( result.errors.empty() ) {
+            std::printf( "%s: %s\n", options.files[i].c_str(), result.output.empty() ? "ok" : result.output.c_str() );
+        } else {
+            failed++;
+            for ( const auto &error : result.errors ) {
+                std::printf( "%s:%d:%d: error: %s\n", options.files[i].c_str(), error.line, error.column, error.message.c_str() );
+            }
+        }
+    }
+
+    std::printf( "%zu file(s), %d with errors, %.3f s\n", results.size(), failed, seconds );
+
+    if ( !options.reportPath.empty() && !writeReport( options.reportPath, options, results, failed, seconds ) ) {
+        std::fprintf( stderr, "could not write %s\n", options.reportPath.c_str() );
+        return 1;
+    }
+
+    return failed > 0 ? 1 : 0;
+
+}
@@ -0,0 +1,516 @@
+/**
+ * @file main.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief raymario-rrespack: walks resources/ and writes a fresh
+ * resources.rres with a central directory, plus the AssetManifest.h header
+ * that ResourceManager enumerates the assets from. Replaces the hand
+ * maintained rrespacker project, that had to be updated every time an
+ * asset was added.
+ *
+ * usage:
+ *    raymario-rrespack [--root dir] [--out file.rres] [--manifest file.h] [-j N]
+ *
+ * Every png, mp3, ogg and wav under images, musics and sfx is packed as a
+ * raw chunk, named as the editor loads it ("resources/images/..."). The
+ * base directories, with the sheets the sprites were cut from, are left
+ * out. Files with the same content are stored once: their directory
+ * entries share the chunk. Chunks are compressed with DEFLATE in parallel
+ * and stored as they are when that saves less than a sixteenth of them,
+ * which is the case of most png and mp3 files: those are then read
+ * straight from the mapped archive, without a copy.
+ *
+ * The archive is written to a temporary file and renamed over the old one,
+ * so an editor that has it mapped keeps reading the old contents until it
+ * reloads. Windows may refuse to replace a mapped file, so the old archive
+ * is then renamed to resources.rres.old first; when even that fails the
+ * archive is left as it was and the error says so. The manifest is only
+ * rewritten when it changes.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+#include "ThreadPool.h"
+
+#define RRES_IMPLEMENTATION
+#include "rres.h"
+
+namespace fs = std::filesystem;
+
+// the directories that are packed and the extensions taken from them
+static const std::vector<std::string> PACKED_DIRECTORIES = { "images", "musics", "sfx" };
+static const std::vector<std::string> PACKED_EXTENSIONS = { ".png", ".mp3", ".ogg", ".wav" };
+
+// source sheets, not loaded by the editor
+static const std::string SKIPPED_DIRECTORY = "base";
+
+// compressed chunks are kept when they are at least 1/MIN_SAVING smaller
+static constexpr size_t MIN_SAVING = 16;
+
+struct Options {
+    std::string root = "resources";
+    std::string outPath = "resources/resources.rres";
+    std::string manifestPath = "src/include/AssetManifest.h";
+    int jobs = 0;
+};
+
+struct Asset {
+    std::string path;               // file on disk
+    std::string name;               // name in the central directory
+    unsigned int id = 0;
+    std::vector<unsigned char> bytes;
+    unsigned long long hash = 0;
+    int canonical = -1;             // asset whose chunk holds this content
+    bool readFailed = false;
+};
+
+struct Chunk {
+    int asset = -1;
+    unsigned int offset = 0;
+    rresResourceChunkInfo info{};
+    std::vector<unsigned char> packed;
+};
+
+static bool readFile( const std::string &path, std::vector<unsigned char> &bytes ) {
+    std::ifstream file( path, std::ios::binary );
+    if ( !file ) {
+        return false;
+    }
+    bytes.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+    return true;
+}
+
+// FNV-1a, only to bucket the candidates for deduplication
+static unsigned long long hashBytes( const std::vector<unsigned char> &bytes ) {
+    unsigned long long hash = 14695981039346656037ull;
+    for ( unsigned char byte : bytes ) {
+        hash = ( hash ^ byte ) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static unsigned int computeId( const std::string &name ) {
+    return rresComputeCRC32( reinterpret_cast<unsigned char*>( const_cast<char*>( name.data() ) ), static_cast<int>( name.size() ) );
+}
+
+// big endian, as rrespacker stores the extension props
+static unsigned int fourCC( const std::string &text, size_t start ) {
+    unsigned int value = 0;
+    for ( size_t i = start; i < start + 4; i++ ) {
+        value = ( value << 8 ) | static_cast<unsigned char>( i < text.size() ? text[i] : 0 );
+    }
+    return value;
+}
+
+static void appendU32( std::vector<unsigned char> &data, unsigned int value ) {
+    const size_t size = data.size();
+    data.resize( size + 4 );
+    std::memcpy( data.data() + size, &value, 4 );
+}
+
+static bool isPacked( const fs::path &path ) {
+    const std::string extension = path.extension().string();
+    return std::find( PACKED_EXTENSIONS.begin(), PACKED_EXTENSIONS.end(), extension ) != PACKED_EXTENSIONS.end();
+}
+
+/**
+ * Lists the packed files under root, sorted by name so that two runs over
+ * the same tree write the same archive.
+ */
+static bool collectAssets( const std::string &root, std::vector<Asset> &assets ) {
+
+    for ( const auto &directory : PACKED_DIRECTORIES ) {
+
+        std::error_code ec;
+        const fs::path base = fs::path( root ) / directory;
+
+        if ( !fs::is_directory( base, ec ) ) {
+            std::fprintf( stderr, "could not read directory %s\n", base.string().c_str() );
+            return false;
+        }
+
+        for ( fs::recursive_directory_iterator it( base, ec ), end; it != end; it.increment( ec ) ) {
+            if ( it->is_directory( ec ) ) {
+                if ( it->path().filename() == SKIPPED_DIRECTORY ) {
+                    it.disable_recursion_pending();
+                }
+            } else if ( isPacked( it->path() ) ) {
+                Asset asset;
+                asset.path = it->path().string();
+                asset.name = "resources/" + fs::relative( it->path(), root, ec ).generic_string();
+                asset.id = computeId( asset.name );
+                assets.push_back( std::move( asset ) );
+            }
+        }
+
+    }
+
+    std::sort( assets.begin(), assets.end(), []( const Asset &a, const Asset &b ) {
+        return a.name < b.name;
+    });
+
+    return true;
+
+}
+
+/**
+ * The first asset with a given content keeps its chunk, the next ones
+ * point to it. The hash only narrows the comparison down.
+ */
+static void deduplicate( std::vector<Asset> &assets ) {
+
+    std::map<unsigned long long, std::vector<int>> buckets;
+
+    for ( int i = 0; i < static_cast<int>( assets.size() ); i++ ) {
+        Asset &asset = assets[i];
+        std::vector<int> &bucket = buckets[asset.hash];
+        for ( int candidate : bucket ) {
+            if ( assets[candidate].bytes == asset.bytes ) {
+                asset.canonical = candidate;
+                break;
+            }
+        }
+        if ( asset.canonical == -1 ) {
+            asset.canonical = i;
+            bucket.push_back( i );
+        }
+    }
+
+}
+
+/**
+ * Chunk data: propCount, props (size, extension as two fourCCs, reserved)
+ * and the file, DEFLATE compressed when that is worth a copy at load.
+ */
+static void packChunk( const Asset &asset, Chunk &chunk ) {
+
+    const std::string extension = fs::path( asset.path ).extension().string();
+
+    std::vector<unsigned char> base;
+    base.reserve( 20 + asset.bytes.size() );
+    appendU32( base, 4 );
+    appendU32( base, static_cast<unsigned int>( asset.bytes.size() ) );
+    appendU32( base, fourCC( extension, 0 ) );
+    appendU32( base, fourCC( extension, 4 ) );
+    appendU32( base, 0 );
+    base.insert( base.end(), asset.bytes.begin(), asset.bytes.end() );
+
+    std::memcpy( chunk.info.type, "RAWD", 4 );
+    chunk.info.id = asset.id;
+    chunk.info.compType = RRES_COMP_NONE;
+    chunk.info.cipherType = RRES_CIPHER_NONE;
+    chunk.info.baseSize = static_cast<unsigned int>( base.size() );
+
+    int compressedSize = 0;
+    unsigned char *compressed = CompressData( base.data(), static_cast<int>( base.size() ), &compressedSize );
+
+    if ( compressed != nullptr && compressedSize > 0 && static_cast<size_t>( compressedSize ) <= base.size() - base.size() / MIN_SAVING ) {
+        chunk.info.compType = RRES_COMP_DEFLATE;
+        chunk.packed.assign( compressed, compressed + compressedSize );
+    } else {
+        chunk.packed = std::move( base );
+    }
+    MemFree( compressed );
+
+    chunk.info.packedSize = static_cast<unsigned int>( chunk.packed.size() );
+    chunk.info.crc32 = rresComputeCRC32( chunk.packed.data(), static_cast<int>( chunk.packed.size() ) );
+
+}
+
+/**
+ * Entries: id, offset, reserved, fileNameSize and the name, NULL terminated
+ * and padded to 4 bytes, the layout rresLoadCentralDirectory reads.
+ */
+static std::vector<unsigned char> buildCentralDirectory( const std::vector<Asset> &assets, const std::vector<Chunk> &chunks, const std::vector<int> &chunkOfAsset ) {
+
+    std::vector<unsigned char> data;
+    appendU32( data, 1 );
+    appendU32( data, static_cast<unsigned int>( assets.size() ) );
+
+    for ( size_t i = 0; i < assets.size(); i++ ) {
+        const Asset &asset = assets[i];
+        const Chunk &chunk = chunks[chunkOfAsset[asset.canonical]];
+        const unsigned int fileNameSize = static_cast<unsigned int>( ( asset.name.size() + 1 + 3 ) / 4 * 4 );
+        appendU32( data, chunk.info.id );
+        appendU32( data, chunk.offset );
+        appendU32( data, 0 );
+        appendU32( data, fileNameSize );
+        const size_t start = data.size();
+        data.resize( start + fileNameSize, 0 );
+        std::memcpy( data.data() + start, asset.name.data(), asset.name.size() );
+    }
+
+    return data;
+
+}
+
+/**
+ * Renames the new archive over the old one. When the old one can not be
+ * replaced (on Windows, while the editor has it mapped) it is moved aside
+ * to path.old, which the editor keeps reading until it reloads, and
+ * removed when it is no longer in use (here or on the next run).
+ */
+static bool replaceArchive( const std::string &temporaryPath, const std::string &path ) {
+
+    std::error_code ec;
+    fs::rename( temporaryPath, path, ec );
+    if ( !ec ) {
+        return true;
+    }
+
+    const std::string oldPath = path + ".old";
+    std::error_code asideEc;
+    fs::remove( oldPath, asideEc );
+    fs::rename( path, oldPath, asideEc );
+
+    if ( !asideEc ) {
+        fs::rename( temporaryPath, path, ec );
+        if ( !ec ) {
+            fs::remove( oldPath, asideEc );
+            return true;
+        }
+        fs::rename( oldPath, path, asideEc );
+    }
+
+    std::fprintf( stderr, "could not replace %s, it may be in use by a running editor (%s): close it and pack again\n",
+                  path.c_str(), ec.message().c_str() );
+    return false;
+
+}
+
+static bool writeArchive( const std::string &path, const std::vector<Asset> &assets, std::vector<Chunk> &chunks, const std::vector<int> &chunkOfAsset ) {
+
+    unsigned int offset = sizeof( rresFileHeader );
+    for ( Chunk &chunk : chunks ) {
+        chunk.offset = offset;
+        offset += sizeof( rresResourceChunkInfo ) + chunk.info.packedSize;
+    }
+
+    Chunk directory;
+    directory.packed = buildCentralDirectory( assets, chunks, chunkOfAsset );
+    std::memcpy( directory.info.type, "CDIR", 4 );
+    directory.info.id = 0;
+    directory.info.packedSize = static_cast<unsigned int>( directory.packed.size() );
+    directory.info.baseSize = directory.info.packedSize;
+    directory.info.crc32 = rresComputeCRC32( directory.packed.data(), static_cast<int>( directory.packed.size() ) );
+
+    // rres seeks to cdOffset from the end of the header
+    rresFileHeader header{};
+    std::memcpy( header.id, "rres", 4 );
+    header.version = 100;
+    header.chunkCount = static_cast<unsigned short>( chunks.size() + 1 );
+    header.cdOffset = offset - sizeof( rresFileHeader );
+
+    const std::string temporaryPath = path + ".tmp";
+
+    {
+        std::ofstream file( temporaryPath, std::ios::binary );
+        if ( !file ) {
+            return false;
+        }
+        file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+        chunks.push_back( std::move( directory ) );
+        for ( const Chunk &chunk : chunks ) {
+            file.write( reinterpret_cast<const char*>( &chunk.info ), sizeof( chunk.info ) );
+            file.write( reinterpret_cast<const char*>( chunk.packed.data() ), static_cast<std::streamsize>( chunk.packed.size() ) );
+        }
+        chunks.pop_back();
+        if ( !file ) {
+            return false;
+        }
+    }
+
+    if ( !replaceArchive( temporaryPath, path ) ) {
+        std::error_code ec;
+        fs::remove( temporaryPath, ec );
+        return false;
+    }
+
+    return true;
+
+}
+
+static std::string buildManifest( const std::vector<Asset> &assets ) {
+
+    std::ostringstream ss;
+
+    ss << "/**\n"
+          " * @file AssetManifest.h\n"
+          " * @author Prof. Dr. David Buzatto\n"
+          " * @brief Assets packed into resources/resources.rres, sorted by path.\n"
+          " * Generated by raymario-rrespack (make pack), do not edit.\n"
+          " *\n"
+          " * @copyright Copyright (c) 2024\n"
+          " */\n"
+          "#pragma once\n"
+          "\n"
+          "struct AssetManifestEntry {\n"
+          "    const char *path;\n"
+          "    unsigned int id;            // rres resource id, shared by files with the same content\n"
+          "    unsigned int size;\n"
+          "};\n"
+          "\n"
+          "inline constexpr AssetManifestEntry ASSET_MANIFEST[] = {\n";
+
+    for ( const Asset &asset : assets ) {
+        char id[16];
+        std::snprintf( id, sizeof( id ), "0x%08x", assets[asset.canonical].id );
+        ss << "    { \"" << asset.name << "\", " << id << ", " << asset.bytes.size() << " },\n";
+    }
+
+    ss << "};\n";
+
+    return ss.str();
+
+}
+
+static bool writeManifest( const std::string &path, const std::string &manifest ) {
+
+    std::vector<unsigned char> current;
+    if ( readFile( path, current ) && std::string( current.begin(), current.end() ) == manifest ) {
+        return true;
+    }
+
+    std::ofstream file( path, std::ios::binary );
+    return file && file.write( manifest.data(), static_cast<std::streamsize>( manifest.size() ) );
+
+}
+
+static void printUsage() {
+    std::fprintf( stderr,
+        "usage:\n"
+        "   raymario-rrespack [--root dir] [--out file.rres] [--manifest file.h] [-j N]\n" );
+}
+
+static bool parseOptions( int argc, char *argv[], Options &options ) {
+
+    for ( int i = 1; i < argc; i++ ) {
+        const std::string arg = argv[i];
+        if ( arg == "-j" && i + 1 < argc ) {
+            options.jobs = std::max( std::atoi( argv[++i] ), 1 );
+        } else if ( arg == "--root" && i + 1 < argc ) {
+            options.root = argv[++i];
+        } else if ( arg == "--out" && i + 1 < argc ) {
+            options.outPath = argv[++i];
+        } else if ( arg == "--manifest" && i + 1 < argc ) {
+            options.manifestPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+
+}
+
+int main( int argc, char *argv[] ) {
+
+    Options options;
+
+    if ( !parseOptions( argc, argv, options ) ) {
+        printUsage();
+        return 2;
+    }
+
+    // CompressData logs every call
+    SetTraceLogLevel( LOG_WARNING );
+
+    std::vector<Asset> assets;
+    if ( !collectAssets( options.root, assets ) ) {
+        return 1;
+    }
+
+    // the header counts the chunks, the central directory included, in 16 bits
+    if ( assets.size() >= 65535 ) {
+        std::fprintf( stderr, "too many files for one rres archive: %zu\n", assets.size() );
+        return 1;
+    }
+
+    std::map<unsigned int, int> ids;
+    for ( int i = 0; i < static_cast<int>( assets.size() ); i++ ) {
+        const auto [it, inserted] = ids.emplace( assets[i].id, i );
+        if ( !inserted ) {
+            std::fprintf( stderr, "%s and %s have the same id %08x\n", assets[it->second].name.c_str(), assets[i].name.c_str(), assets[i].id );
+            return 1;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<Chunk> chunks;
+    std::vector<int> chunkOfAsset( assets.size(), -1 );
+    size_t totalBytes = 0;
+    size_t packedBytes = 0;
+    int compressedChunks = 0;
+
+    {
+        ThreadPool pool( options.jobs );
+
+        pool.parallelFor( static_cast<int>( assets.size() ), [&]( int i ) {
+            Asset &asset = assets[i];
+            asset.readFailed = !readFile( asset.path, asset.bytes );
+            asset.hash = hashBytes( asset.bytes );
+        });
+
+        for ( const Asset &asset : assets ) {
+            if ( asset.readFailed ) {
+                std::fprintf( stderr, "could not read %s\n", asset.path.c_str() );
+                return 1;
+            }
+        }
+
+        deduplicate( assets );
+
+        for ( int i = 0; i < static_cast<int>( assets.size() ); i++ ) {
+            totalBytes += assets[i].bytes.size();
+            if ( assets[i].canonical == i ) {
+                chunkOfAsset[i] = static_cast<int>( chunks.size() );
+                chunks.emplace_back();
+                chunks.back().asset = i;
+            }
+        }
+
+        pool.parallelFor( static_cast<int>( chunks.size() ), [&]( int i ) {
+            packChunk( assets[chunks[i].asset], chunks[i] );
+        });
+    }
+
+    for ( const Chunk &chunk : chunks ) {
+        packedBytes += chunk.info.packedSize;
+        if ( chunk.info.compType != RRES_COMP_NONE ) {
+            compressedChunks++;
+        }
+    }
+
+    if ( !writeArchive( options.outPath, assets, chunks, chunkOfAsset ) ) {
+        std::fprintf( stderr, "could not write %s\n", options.outPath.c_str() );
+        return 1;
+    }
+
+    if ( !writeManifest( options.manifestPath, buildManifest( assets ) ) ) {
+        std::fprintf( stderr, "could not write %s\n", options.manifestPath.c_str() );
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    std::printf( "%zu file(s), %zu chunk(s) (%zu duplicate(s), %d compressed), %zu -> %zu bytes, %.3f s\n",
+                 assets.size(), chunks.size(), assets.size() - chunks.size(), compressedChunks,
+                 totalBytes, packedBytes, seconds );
+    std::printf( "%s\n%s\n", options.outPath.c_str(), options.manifestPath.c_str() );
+
+    return 0;
+
+}
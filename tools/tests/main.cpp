@@ -0,0 +1,1005 @@
+/**
+ * @file main.cpp
+ * @author Prof. Dr. David Buzatto
+ * @brief raymario-tests: checks the map model without a window. Each test
+ * is a function registered in TESTS; a failed check prints where it failed
+ * and the test goes on, so one run reports every failure.
+ *
+ * usage:
+ *    raymario-tests [--filter text]
+ *
+ * The exit code is 1 when any check failed.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AutoTiler.h"
+#include "EditJournal.h"
+#include "MapBinaryFile.h"
+#include "MapFile.h"
+#include "TileLayer.h"
+
+// same sizes as the editor
+static constexpr int MAX_LINES = 40;
+static constexpr int MAX_COLUMNS = 400;
+
+static int failedChecks = 0;
+
+static void check( bool condition, const char *file, int line, const std::string &message ) {
+    if ( !condition ) {
+        failedChecks++;
+        std::printf( "    %s:%d: %s\n", file, line, message.c_str() );
+    }
+}
+
+#define CHECK( condition, message ) check( ( condition ), __FILE__, __LINE__, ( message ) )
+
+struct Test {
+    const char *name;
+    void ( *run )();
+};
+
+/**
+ * Shadow of a layer indexed by line counted from the bottom, since the map
+ * grows upwards, and column. Resizing drops what is outside the new size.
+ */
+class LayerModel {
+
+    std::vector<uint32_t> cells;
+
+public:
+
+    int lines = 0;
+    int columns = 0;
+
+    LayerModel()
+        :
+        cells( MAX_LINES * MAX_COLUMNS, TileLayer::DEFAULT_FLAGS ) {
+    }
+
+    uint32_t &at( int bottomLine, int column ) {
+        return cells[bottomLine * MAX_COLUMNS + column];
+    }
+
+    void resize( int newLines, int newColumns ) {
+        for ( int b = 0; b < MAX_LINES; b++ ) {
+            for ( int j = 0; j < MAX_COLUMNS; j++ ) {
+                if ( b >= newLines || j >= newColumns ) {
+                    at( b, j ) = TileLayer::DEFAULT_FLAGS;
+                }
+            }
+        }
+        lines = newLines;
+        columns = newColumns;
+    }
+
+    // every cell of the capacity: the used ones match, the others are empty
+    bool matches( const TileLayer &layer ) {
+        for ( int i = 0; i < MAX_LINES; i++ ) {
+            for ( int j = 0; j < MAX_COLUMNS; j++ ) {
+                const bool used = i < lines && j < columns;
+                const uint32_t expected = used ? at( lines - 1 - i, j ) : TileLayer::DEFAULT_FLAGS;
+                if ( layer.getCell( layer.getIndex( i, j ) ) != expected ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+};
+
+static void fill( TileLayer &layer, LayerModel &model, unsigned int seed ) {
+    for ( int i = 0; i < layer.getLines(); i++ ) {
+        for ( int j = 0; j < layer.getColumns(); j++ ) {
+            const int bottomLine = layer.getLines() - 1 - i;
+            const uint16_t tileId = static_cast<uint16_t>( 1 + ( bottomLine * MAX_COLUMNS + j + seed ) % 65535 );
+            const uint32_t cell = static_cast<uint32_t>( tileId ) << 8 | ( ( bottomLine + j + seed ) % 8 );
+            layer.setCell( layer.getIndex( i, j ), cell );
+            model.at( bottomLine, j ) = cell;
+        }
+    }
+}
+
+static void resizeAndCheck( TileLayer &layer, LayerModel &model, int lines, int columns ) {
+    layer.resize( lines, columns );
+    model.resize( lines, columns );
+    CHECK( layer.getLines() == lines && layer.getColumns() == columns,
+           "resize to " + std::to_string( lines ) + "x" + std::to_string( columns ) + " gave " +
+           std::to_string( layer.getLines() ) + "x" + std::to_string( layer.getColumns() ) );
+    CHECK( model.matches( layer ), "cells differ after resizing to " + std::to_string( lines ) + "x" + std::to_string( columns ) );
+}
+
+/**
+ * Shrinks and grows each dimension through its whole range one step at a
+ * time, then jumps between pseudo random sizes, refilling now and then.
+ * After every resize the kept cells must be unchanged and every cell
+ * outside the size must be empty.
+ */
+static void testResizeSweep() {
+
+    TileLayer layer( MAX_LINES, MAX_COLUMNS, MAX_LINES, MAX_COLUMNS );
+    LayerModel model;
+    model.resize( MAX_LINES, MAX_COLUMNS );
+    fill( layer, model, 0 );
+
+    for ( int c = MAX_COLUMNS; c >= 0; c-- ) {
+        resizeAndCheck( layer, model, MAX_LINES, c );
+    }
+    for ( int c = 0; c <= MAX_COLUMNS; c++ ) {
+        resizeAndCheck( layer, model, MAX_LINES, c );
+    }
+
+    fill( layer, model, 1 );
+
+    for ( int l = MAX_LINES; l >= 0; l-- ) {
+        resizeAndCheck( layer, model, l, MAX_COLUMNS );
+    }
+    for ( int l = 0; l <= MAX_LINES; l++ ) {
+        resizeAndCheck( layer, model, l, MAX_COLUMNS );
+    }
+
+    unsigned int state = 12345;
+    const auto next = [&state]( int bound ) {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>( ( state >> 16 ) % static_cast<unsigned int>( bound + 1 ) );
+    };
+
+    for ( int step = 0; step < 500; step++ ) {
+        resizeAndCheck( layer, model, next( MAX_LINES ), next( MAX_COLUMNS ) );
+        if ( step % 50 == 0 ) {
+            fill( layer, model, step );
+        }
+    }
+
+    // out of range sizes are clamped
+    layer.resize( MAX_LINES + 10, -5 );
+    CHECK( layer.getLines() == MAX_LINES && layer.getColumns() == 0, "out of range sizes are not clamped" );
+
+}
+
+/**
+ * Bounds, runs and selection fills against a cell by cell walk, over
+ * pseudo random rectangles and single cells, on a layer whose stride is
+ * not a multiple of 64.
+ */
+static void testSelection() {
+
+    TileLayer layer( MAX_LINES, MAX_COLUMNS, MAX_LINES, MAX_COLUMNS );
+    unsigned int state = 54321;
+    const auto next = [&state]( int bound ) {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>( ( state >> 16 ) % static_cast<unsigned int>( bound ) );
+    };
+
+    for ( int step = 0; step < 300; step++ ) {
+
+        layer.deselectAll();
+        const int shapes = 1 + next( 4 );
+        for ( int s = 0; s < shapes; s++ ) {
+            if ( next( 2 ) == 0 ) {
+                layer.setSelected( layer.getIndex( next( MAX_LINES ), next( MAX_COLUMNS ) ), true );
+            } else {
+                layer.selectRect( DirtyRect( next( MAX_LINES ), next( MAX_COLUMNS ), 1 + next( 10 ), 1 + next( 200 ) ), true );
+            }
+        }
+
+        const SelectionSet &selection = layer.getSelection();
+        int firstLine = MAX_LINES, lastLine = -1, firstColumn = MAX_COLUMNS, lastColumn = -1;
+        int cells = 0;
+        selection.forEach( [&]( int index ) {
+            firstLine = std::min( firstLine, index / MAX_COLUMNS );
+            lastLine = std::max( lastLine, index / MAX_COLUMNS );
+            firstColumn = std::min( firstColumn, index % MAX_COLUMNS );
+            lastColumn = std::max( lastColumn, index % MAX_COLUMNS );
+            cells++;
+        });
+
+        const DirtyRect bounds = selection.getBounds();
+        CHECK( bounds.line == firstLine && bounds.lines == lastLine - firstLine + 1 &&
+               bounds.column == firstColumn && bounds.columns == lastColumn - firstColumn + 1,
+               "wrong bounds at step " + std::to_string( step ) );
+
+        int runCells = 0;
+        bool runsSelected = true;
+        selection.forEachRun( [&]( int begin, int end ) {
+            runCells += end - begin;
+            for ( int i = begin; i < end; i++ ) {
+                runsSelected = runsSelected && selection.test( i );
+            }
+        });
+        CHECK( runCells == cells && runsSelected, "runs do not cover the selection at step " + std::to_string( step ) );
+
+        const uint16_t tileId = static_cast<uint16_t>( 1 + step );
+        CHECK( layer.fillSelection( tileId, TileCollisionType::solid, step % 2 == 0 ) == cells, "fill changed a wrong cell count" );
+        CHECK( layer.fillSelection( tileId, TileCollisionType::solid, step % 2 == 0 ) == 0, "a repeated fill changed cells" );
+
+        bool filled = true;
+        for ( int p = 0; p < MAX_LINES * MAX_COLUMNS; p++ ) {
+            if ( selection.test( p ) ) {
+                filled = filled && layer.getTileId( p ) == tileId && layer.isVisible( p ) == ( step % 2 == 0 );
+            }
+        }
+        CHECK( filled, "a selected cell was not filled at step " + std::to_string( step ) );
+
+    }
+
+}
+
+// sizes and cells of every layer, to compare whole states of the map
+static std::vector<uint32_t> snapshot( const std::vector<TileLayer> &layers ) {
+    std::vector<uint32_t> state;
+    for ( const TileLayer &layer : layers ) {
+        state.push_back( static_cast<uint32_t>( layer.getLines() << 16 | layer.getColumns() ) );
+        for ( int p = 0; p < layer.getMaxLines() * layer.getMaxColumns(); p++ ) {
+            state.push_back( layer.getCell( p ) );
+        }
+    }
+    return state;
+}
+
+static void paintCells( TileLayer &layer, int count, unsigned int &state ) {
+    for ( int i = 0; i < count; i++ ) {
+        state = state * 1103515245u + 12345u;
+        const int line = static_cast<int>( ( state >> 16 ) % static_cast<unsigned int>( layer.getLines() ) );
+        state = state * 1103515245u + 12345u;
+        const int column = static_cast<int>( ( state >> 16 ) % static_cast<unsigned int>( layer.getColumns() ) );
+        layer.setTile( layer.getIndex( line, column ), static_cast<uint16_t>( 1 + state % 50 ), TileCollisionType::solid, state % 3 != 0 );
+    }
+}
+
+/**
+ * Paints, fills and resizes, alone and mixed in one command, on two
+ * layers. Undo must bring back the exact state before each command and
+ * redo the one after it.
+ */
+static void testJournalUndoRedo() {
+
+    std::vector<TileLayer> layers( 2, TileLayer( MAX_LINES, MAX_COLUMNS, 20, 100 ) );
+    EditJournal journal( 1 << 16 );
+    journal.attach( layers );
+    unsigned int state = 777;
+
+    const std::vector<std::string> names = {
+        "paint", "fill of both layers", "shrinking resize", "growing resize",
+        "paint then shrinking resize", "paint then growing resize", "resize then paint" };
+    std::vector<std::vector<uint32_t>> states = { snapshot( layers ) };
+
+    for ( size_t step = 0; step < names.size(); step++ ) {
+
+        journal.beginCommand();
+
+        switch ( step ) {
+            case 0:
+                paintCells( layers[0], 200, state );
+                break;
+            case 1:
+                for ( TileLayer &layer : layers ) {
+                    layer.selectRect( DirtyRect( 0, 0, layer.getLines(), layer.getColumns() ), true );
+                    layer.fillSelection( 9, TileCollisionType::solid, true );
+                    layer.deselectAll();
+                }
+                break;
+            case 2:
+                layers[0].resize( 12, 60 );
+                layers[1].resize( 12, 60 );
+                break;
+            case 3:
+                layers[0].resize( 30, 150 );
+                layers[1].resize( 30, 150 );
+                break;
+            case 4:
+                paintCells( layers[0], 300, state );
+                paintCells( layers[1], 300, state );
+                layers[0].resize( 18, 90 );
+                layers[1].resize( 18, 90 );
+                break;
+            case 5:
+                paintCells( layers[0], 300, state );
+                layers[0].resize( 35, 120 );
+                layers[1].resize( 35, 120 );
+                break;
+            case 6:
+                layers[1].resize( 25, 110 );
+                paintCells( layers[1], 300, state );
+                break;
+        }
+
+        journal.endCommand();
+        states.push_back( snapshot( layers ) );
+        CHECK( states.back() != states[states.size() - 2], names[step] + " changed nothing" );
+
+    }
+
+    for ( size_t step = names.size(); step > 0; step-- ) {
+        CHECK( journal.undo(), "undo of " + names[step - 1] + " refused" );
+        CHECK( snapshot( layers ) == states[step - 1], "undo of " + names[step - 1] + " did not restore the map" );
+    }
+    CHECK( !journal.canUndo(), "undo possible past the first command" );
+
+    for ( size_t step = 0; step < names.size(); step++ ) {
+        CHECK( journal.redo(), "redo of " + names[step] + " refused" );
+        CHECK( snapshot( layers ) == states[step + 1], "redo of " + names[step] + " did not repeat it" );
+    }
+    CHECK( !journal.canRedo(), "redo possible past the last command" );
+
+}
+
+/**
+ * Commands with the same merge key are undone at once, a new edit drops
+ * the commands that could be redone, and a command that changes nothing
+ * is not kept.
+ */
+static void testJournalStrokesAndRedo() {
+
+    std::vector<TileLayer> layers( 1, TileLayer( MAX_LINES, MAX_COLUMNS, MAX_LINES, MAX_COLUMNS ) );
+    EditJournal journal( 1 << 16 );
+    journal.attach( layers );
+    unsigned int state = 4242;
+
+    const std::vector<uint32_t> initial = snapshot( layers );
+    for ( int frame = 0; frame < 10; frame++ ) {
+        journal.beginCommand( 1 );
+        paintCells( layers[0], 5, state );
+        journal.endCommand();
+    }
+    const std::vector<uint32_t> stroke = snapshot( layers );
+
+    CHECK( journal.undo() && snapshot( layers ) == initial, "a stroke is not undone at once" );
+    CHECK( !journal.canUndo(), "a stroke was split in more than one command" );
+    CHECK( journal.redo() && snapshot( layers ) == stroke, "a stroke is not redone at once" );
+
+    journal.beginCommand();
+    paintCells( layers[0], 20, state );
+    journal.endCommand();
+    const std::vector<uint32_t> second = snapshot( layers );
+
+    journal.beginCommand();
+    layers[0].setCell( 0, layers[0].getCell( 0 ) );
+    journal.endCommand();
+    CHECK( journal.undo() && snapshot( layers ) == stroke, "a command without changes was kept" );
+
+    journal.beginCommand();
+    paintCells( layers[0], 20, state );
+    journal.endCommand();
+    CHECK( !journal.canRedo(), "a new edit did not clear the redo stack" );
+    CHECK( journal.undo() && snapshot( layers ) == stroke, "undo after a new edit went to the wrong state" );
+    CHECK( journal.redo() && snapshot( layers ) != second, "redo brought back a dropped command" );
+
+}
+
+/**
+ * A small journal keeps only the newest commands that fit, counting both
+ * runs and cell words, and a command that does not fit alone can not be
+ * undone, nor anything before it. A whole map fill is a single run.
+ */
+static void testJournalEviction() {
+
+    std::vector<TileLayer> layers( 1, TileLayer( MAX_LINES, MAX_COLUMNS, MAX_LINES, MAX_COLUMNS ) );
+    std::vector<std::vector<uint32_t>> states = { snapshot( layers ) };
+
+    {
+        // 64 cell changes: 16 runs and 128 words, so 3 commands of 20 cells
+        EditJournal journal( 64 );
+        journal.attach( layers );
+        for ( int step = 0; step < 5; step++ ) {
+            journal.beginCommand();
+            layers[0].selectRect( DirtyRect( step, 10, 1, 20 ), true );
+            layers[0].fillSelection( static_cast<uint16_t>( 1 + step ), TileCollisionType::solid, true );
+            layers[0].deselectAll();
+            journal.endCommand();
+            states.push_back( snapshot( layers ) );
+        }
+        int undone = 0;
+        while ( journal.undo() ) {
+            undone++;
+        }
+        CHECK( undone == 3, "expected 3 commands kept, got " + std::to_string( undone ) );
+        CHECK( snapshot( layers ) == states[2], "eviction kept the wrong commands" );
+
+        // 20 scattered cells need 20 runs
+        journal.beginCommand();
+        for ( int i = 0; i < 20; i++ ) {
+            layers[0].setTile( layers[0].getIndex( i, i * 3 ), 7, TileCollisionType::solid, true );
+        }
+        journal.endCommand();
+        CHECK( !journal.canUndo() && !journal.canRedo(), "a command larger than the journal can be undone" );
+    }
+
+    EditJournal journal( MAX_LINES * MAX_COLUMNS );
+    journal.attach( layers );
+    const std::vector<uint32_t> before = snapshot( layers );
+    for ( int step = 0; step < 2; step++ ) {
+        journal.beginCommand();
+        layers[0].selectRect( DirtyRect( 0, 0, MAX_LINES, MAX_COLUMNS ), true );
+        layers[0].fillSelection( static_cast<uint16_t>( 100 + step ), TileCollisionType::solid, true );
+        layers[0].deselectAll();
+        journal.endCommand();
+        CHECK( journal.canUndo(), "a whole map fill does not fit in a journal of the map size" );
+    }
+    CHECK( journal.undo() && !journal.canUndo(), "two whole map fills fit in a journal of the map size" );
+    CHECK( snapshot( layers ) != before, "undo of the second fill went past the first one" );
+
+}
+
+/**
+ * Replication in each direction, alone and both ways, against a cell by
+ * cell copy of the pattern, over pseudo random layer sizes and selections
+ * made of a few rectangles and cells (so usually not rectangular, and
+ * rarely dividing the space left to the edges). Cells outside the targets
+ * and past the size of the layer must not change.
+ */
+static void testReplicate() {
+
+    TileLayer layer( MAX_LINES, MAX_COLUMNS, 7, 10 );
+    LayerModel model;
+    model.resize( 7, 10 );
+    fill( layer, model, 3 );
+
+    // a 4 column pattern with 3 columns left on each side: partial repeats
+    layer.selectRect( DirtyRect( 2, 3, 1, 4 ), true );
+    const std::vector<uint32_t> before = snapshot( std::vector<TileLayer>( 1, layer ) );
+    const auto cellAt = [&before]( int line, int column ) {
+        return before[1 + line * MAX_COLUMNS + column];
+    };
+    layer.replicateSelection( true, true, false, false );
+    CHECK( layer.getCell( layer.getIndex( 2, 7 ) ) == cellAt( 2, 3 ) &&
+           layer.getCell( layer.getIndex( 2, 8 ) ) == cellAt( 2, 4 ) &&
+           layer.getCell( layer.getIndex( 2, 9 ) ) == cellAt( 2, 5 ), "right replication does not restart the pattern" );
+    CHECK( layer.getCell( layer.getIndex( 2, 0 ) ) == cellAt( 2, 4 ) &&
+           layer.getCell( layer.getIndex( 2, 1 ) ) == cellAt( 2, 5 ) &&
+           layer.getCell( layer.getIndex( 2, 2 ) ) == cellAt( 2, 6 ), "left replication does not end next to the pattern" );
+    CHECK( layer.getCell( layer.getIndex( 2, 10 ) ) == TileLayer::DEFAULT_FLAGS, "replication went past the edge of the layer" );
+    layer.deselectAll();
+
+    unsigned int state = 2468;
+    const auto next = [&state]( int bound ) {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>( ( state >> 16 ) % static_cast<unsigned int>( bound ) );
+    };
+    const auto wrap = []( int value, int period ) {
+        return ( value % period + period ) % period;
+    };
+
+    for ( int step = 0; step < 300; step++ ) {
+
+        const int lines = 1 + next( MAX_LINES );
+        const int columns = 1 + next( MAX_COLUMNS );
+        layer.resize( lines, columns );
+        model.resize( lines, columns );
+        fill( layer, model, static_cast<unsigned int>( step ) );
+
+        const int shapes = 1 + next( 3 );
+        for ( int s = 0; s < shapes; s++ ) {
+            if ( next( 3 ) == 0 ) {
+                layer.setSelected( layer.getIndex( next( lines ), next( columns ) ), true );
+            } else {
+                layer.selectRect( DirtyRect( next( lines ), next( columns ), 1 + next( 5 ), 1 + next( 30 ) ), true );
+            }
+        }
+
+        const DirtyRect source = layer.getSelection().getBounds();
+        const int direction = next( 4 );
+        const bool both = next( 2 ) == 0;
+        const bool left = direction == 0 || ( direction == 1 && both );
+        const bool right = direction == 1 || ( direction == 0 && both );
+        const bool up = direction == 2 || ( direction == 3 && both );
+        const bool down = direction == 3 || ( direction == 2 && both );
+
+        const std::vector<uint32_t> original = snapshot( std::vector<TileLayer>( 1, layer ) );
+        layer.replicateSelection( left, right, up, down );
+
+        bool matches = true;
+        for ( int i = 0; i < MAX_LINES && matches; i++ ) {
+            for ( int j = 0; j < MAX_COLUMNS && matches; j++ ) {
+                const bool inLines = i >= source.line && i < source.line + source.lines;
+                const bool inColumns = j >= source.column && j < source.column + source.columns;
+                const bool target =
+                    ( left && inLines && j < source.column ) ||
+                    ( right && inLines && j >= source.column + source.columns && j < columns ) ||
+                    ( up && inColumns && i < source.line ) ||
+                    ( down && inColumns && i >= source.line + source.lines && i < lines );
+                const int fromLine = target ? source.line + wrap( i - source.line, source.lines ) : i;
+                const int fromColumn = target ? source.column + wrap( j - source.column, source.columns ) : j;
+                matches = layer.getCell( layer.getIndex( i, j ) ) == original[1 + fromLine * MAX_COLUMNS + fromColumn];
+            }
+        }
+        CHECK( matches, "wrong replication at step " + std::to_string( step ) );
+
+        layer.deselectAll();
+
+    }
+
+}
+
+/**
+ * Flood fills against a breadth first search over a copy of the layer, on
+ * pseudo random layer sizes and cells drawn from a few tiles so regions
+ * have odd shapes. Seeds include the corners, so fills run along the edges
+ * of the layer, and every fill is repeated with the same tile, which must
+ * leave the cells as they are.
+ */
+static void testFloodFill() {
+
+    TileLayer layer( MAX_LINES, MAX_COLUMNS, MAX_LINES, MAX_COLUMNS );
+    unsigned int state = 1357;
+    const auto next = [&state]( int bound ) {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>( ( state >> 16 ) % static_cast<unsigned int>( bound ) );
+    };
+
+    for ( int step = 0; step < 200; step++ ) {
+
+        const int lines = step % 10 == 0 ? MAX_LINES : 1 + next( MAX_LINES );
+        const int columns = step % 10 == 0 ? MAX_COLUMNS : 1 + next( MAX_COLUMNS );
+        layer.resize( 0, 0 );
+        layer.resize( lines, columns );
+        for ( int i = 0; i < lines; i++ ) {
+            for ( int j = 0; j < columns; j++ ) {
+                const int kind = next( 4 );
+                if ( kind > 0 ) {
+                    layer.setTile( layer.getIndex( i, j ), static_cast<uint16_t>( 1 + kind % 2 ), kind == 3 ? TileCollisionType::solid : TileCollisionType::non_solid, true );
+                }
+            }
+        }
+
+        int seedLine = next( lines );
+        int seedColumn = next( columns );
+        if ( step % 5 < 4 ) {
+            seedLine = step % 5 < 2 ? 0 : lines - 1;
+            seedColumn = step % 5 % 2 == 0 ? 0 : columns - 1;
+        }
+
+        const std::vector<uint32_t> original = snapshot( std::vector<TileLayer>( 1, layer ) );
+        const auto cellAt = [&original]( int p ) {
+            return original[1 + p];
+        };
+        const auto sameKind = [&]( int p, int q ) {
+            return ( cellAt( p ) >> 8 ) == ( cellAt( q ) >> 8 ) && ( cellAt( p ) & TileLayer::COLLISION_MASK ) == ( cellAt( q ) & TileLayer::COLLISION_MASK );
+        };
+
+        const int seed = layer.getIndex( seedLine, seedColumn );
+        std::vector<bool> region( MAX_LINES * MAX_COLUMNS, false );
+        std::vector<int> queue = { seed };
+        region[seed] = true;
+        for ( size_t k = 0; k < queue.size(); k++ ) {
+            const int line = queue[k] / MAX_COLUMNS;
+            const int column = queue[k] % MAX_COLUMNS;
+            const int neighbours[4][2] = { { line - 1, column }, { line + 1, column }, { line, column - 1 }, { line, column + 1 } };
+            for ( const auto &[l, c] : neighbours ) {
+                if ( l >= 0 && l < lines && c >= 0 && c < columns ) {
+                    const int p = layer.getIndex( l, c );
+                    if ( !region[p] && sameKind( p, seed ) ) {
+                        region[p] = true;
+                        queue.push_back( p );
+                    }
+                }
+            }
+        }
+
+        // tiles the layer does not hold, so the filled region can not grow
+        const uint16_t tileId = static_cast<uint16_t>( 3 + next( 3 ) );
+        const bool visible = next( 2 ) == 0;
+        const uint32_t filledCell = static_cast<uint32_t>( tileId ) << 8 | static_cast<uint32_t>( TileCollisionType::solid ) | ( visible ? TileLayer::VISIBLE_FLAG : 0 );
+
+        const int filled = layer.floodFill( seed, tileId, TileCollisionType::solid, visible );
+        CHECK( filled == static_cast<int>( queue.size() ),
+               "filled " + std::to_string( filled ) + " cells instead of " + std::to_string( queue.size() ) + " at step " + std::to_string( step ) );
+
+        bool matches = true;
+        for ( int p = 0; p < MAX_LINES * MAX_COLUMNS && matches; p++ ) {
+            matches = layer.getCell( p ) == ( region[p] ? filledCell : cellAt( p ) );
+        }
+        CHECK( matches, "wrong cells after the fill at step " + std::to_string( step ) );
+
+        const std::vector<uint32_t> afterFill = snapshot( std::vector<TileLayer>( 1, layer ) );
+        CHECK( layer.floodFill( seed, tileId, TileCollisionType::solid, visible ) == filled &&
+               snapshot( std::vector<TileLayer>( 1, layer ) ) == afterFill,
+               "filling a filled region again changed cells at step " + std::to_string( step ) );
+
+    }
+
+    layer.resize( 10, 10 );
+    CHECK( layer.floodFill( layer.getIndex( 10, 0 ), 1, TileCollisionType::solid, true ) == 0 &&
+           layer.floodFill( layer.getIndex( 0, 10 ), 1, TileCollisionType::solid, true ) == 0,
+           "a fill outside the layer filled cells" );
+
+}
+
+// piece letter of a cell of a terrain set registered as palette indexes 1..18
+static char pieceAt( const TileLayer &layer, int line, int column ) {
+    const uint16_t tileId = layer.getTileId( layer.getIndex( line, column ) );
+    return tileId == TileLayer::EMPTY_TILE ? ' ' : static_cast<char>( 'A' + tileId - 1 );
+}
+
+static void paintTerrain( TileLayer &layer, const std::vector<std::string> &rows ) {
+    layer.resize( 0, 0 );
+    layer.resize( static_cast<int>( rows.size() ), static_cast<int>( rows[0].size() ) );
+    for ( int i = 0; i < layer.getLines(); i++ ) {
+        for ( int j = 0; j < layer.getColumns(); j++ ) {
+            if ( rows[i][j] != ' ' ) {
+                layer.setTile( layer.getIndex( i, j ), 1, TileCollisionType::solid, true );
+            }
+        }
+    }
+}
+
+static void checkPieces( const TileLayer &layer, const std::vector<std::string> &expected, const std::string &what ) {
+    for ( int i = 0; i < layer.getLines(); i++ ) {
+        std::string row;
+        for ( int j = 0; j < layer.getColumns(); j++ ) {
+            row += pieceAt( layer, i, j );
+        }
+        CHECK( row == expected[i], what + ": line " + std::to_string( i ) + " is \"" + row + "\" instead of \"" + expected[i] + "\"" );
+    }
+}
+
+/**
+ * Pieces of small shapes: tops and ends, fill, both inner corners and the
+ * borders of the map (the top is open, the others continue the terrain).
+ * Then, over pseudo random terrain, retiling around a painted cell must
+ * give the same layer as retiling everything, changing only the 3x3 cells
+ * around it.
+ */
+static void testAutoTiler() {
+
+    AutoTiler tiler;
+    std::array<uint16_t, 18> indexes;
+    for ( int p = 0; p < AutoTiler::PIECES; p++ ) {
+        indexes[p] = static_cast<uint16_t>( 1 + p );
+    }
+    tiler.setPieces( 1, indexes );
+
+    TileLayer layer( MAX_LINES, MAX_COLUMNS, MAX_LINES, MAX_COLUMNS );
+    const auto retileAll = [&]() {
+        tiler.retile( layer, DirtyRect( 0, 0, layer.getLines(), layer.getColumns() ) );
+    };
+
+    paintTerrain( layer, { "       ", " #     ", "   ### ", "       " } );
+    retileAll();
+    checkPieces( layer, { "       ", " B     ", "   EBF ", "       " }, "isolated cell and strip" );
+
+    paintTerrain( layer, { "       ", " ##### ", " ##### ", " ##### ", "       " } );
+    retileAll();
+    checkPieces( layer, { "       ", " EBBBF ", " CAAAD ", " CAAAD ", "       " }, "interior fill" );
+
+    paintTerrain( layer, { "         ", "   ###   ", " ####### ", " ####### ", "         " } );
+    retileAll();
+    checkPieces( layer, { "         ", "   EBF   ", " EBGAHBF ", " CAAAAAD ", "         " }, "inner corners" );
+
+    paintTerrain( layer, { "###", "###", "###" } );
+    retileAll();
+    checkPieces( layer, { "BBB", "AAA", "AAA" }, "borders of the map" );
+
+    unsigned int state = 8642;
+    const auto next = [&state]( int bound ) {
+        state = state * 1103515245u + 12345u;
+        return static_cast<int>( ( state >> 16 ) % static_cast<unsigned int>( bound ) );
+    };
+
+    layer.resize( 0, 0 );
+    layer.resize( 12, 30 );
+    for ( int p = 0; p < 12 * 30 / 2; p++ ) {
+        layer.setTile( layer.getIndex( next( 12 ), next( 30 ) ), 1, TileCollisionType::solid, true );
+    }
+    retileAll();
+
+    for ( int step = 0; step < 300; step++ ) {
+
+        const int line = next( layer.getLines() );
+        const int column = next( layer.getColumns() );
+        const int p = layer.getIndex( line, column );
+        const std::vector<uint32_t> before = snapshot( std::vector<TileLayer>( 1, layer ) );
+
+        if ( tiler.isTerrain( layer.getTileId( p ) ) ) {
+            layer.resetTile( p );
+        } else {
+            layer.setTile( p, 1, TileCollisionType::solid, true );
+        }
+        tiler.retile( layer, DirtyRect( line, column, 1, 1 ) );
+
+        bool local = true;
+        for ( int i = 0; i < layer.getLines(); i++ ) {
+            for ( int j = 0; j < layer.getColumns(); j++ ) {
+                const bool near = std::abs( i - line ) <= 1 && std::abs( j - column ) <= 1;
+                local = local && ( near || layer.getCell( layer.getIndex( i, j ) ) == before[1 + layer.getIndex( i, j )] );
+            }
+        }
+        CHECK( local, "a painted cell changed cells outside its neighbourhood at step " + std::to_string( step ) );
+
+        const std::vector<uint32_t> retiled = snapshot( std::vector<TileLayer>( 1, layer ) );
+        retileAll();
+        CHECK( snapshot( std::vector<TileLayer>( 1, layer ) ) == retiled, "retiling around a painted cell missed cells at step " + std::to_string( step ) );
+
+    }
+
+}
+
+static std::string readFile( const std::filesystem::path &path ) {
+    std::ifstream file( path, std::ios::binary );
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+static std::vector<std::filesystem::path> getShippedMaps() {
+    std::vector<std::filesystem::path> paths;
+    for ( const auto &entry : std::filesystem::directory_iterator( "resources/maps" ) ) {
+        if ( entry.path().extension() == ".txt" ) {
+            paths.push_back( entry.path() );
+        }
+    }
+    std::sort( paths.begin(), paths.end() );
+    return paths;
+}
+
+static void checkSameText( const std::string &expected, const std::string &actual, const std::string &what ) {
+    if ( actual != expected ) {
+        size_t p = 0;
+        while ( p < expected.size() && p < actual.size() && expected[p] == actual[p] ) {
+            p++;
+        }
+        const int line = 1 + static_cast<int>( std::count( expected.begin(), expected.begin() + p, '\n' ) );
+        CHECK( false, what + " differs, first at line " + std::to_string( line ) );
+    }
+}
+
+/**
+ * Every shipped map, unknown glyphs included, must be written back byte
+ * for byte as it was read.
+ */
+static void testMapRoundTrip() {
+
+    const auto paths = getShippedMaps();
+    CHECK( !paths.empty(), "no maps in resources/maps" );
+
+    for ( const auto &path : paths ) {
+
+        const std::string text = readFile( path );
+        MapMetadata metadata;
+        std::vector<TileLayer> layers;
+        layers.emplace_back( MAX_LINES, MAX_COLUMNS, 0, 0 );
+        std::vector<MapError> errors;
+
+        MapFile::parse( text, metadata, layers[0], MapFile::resolveGlyphAsIndex, errors );
+        checkSameText( text, MapFile::write( metadata, layers, MapFile::getGlyphIndexPalette(), errors ), path.string() + " after load and save" );
+
+    }
+
+}
+
+/**
+ * Every shipped map saved as .rmap and read back must give the same text.
+ */
+static void testBinaryRoundTrip() {
+
+    const std::filesystem::path binaryPath = std::filesystem::temp_directory_path() / "raymario-tests.rmap";
+
+    for ( const auto &path : getShippedMaps() ) {
+
+        const std::string text = readFile( path );
+        MapMetadata metadata;
+        std::vector<TileLayer> layers;
+        layers.emplace_back( MAX_LINES, MAX_COLUMNS, 0, 0 );
+        std::vector<MapError> errors;
+
+        MapFile::parse( text, metadata, layers[0], MapFile::resolveGlyphAsIndex, errors );
+        errors.clear();
+
+        CHECK( MapBinaryFile::save( binaryPath.string(), metadata, layers, MapFile::getGlyphIndexPalette(), {}, errors ),
+               path.string() + " could not be saved as .rmap" );
+
+        MapMetadata loadedMetadata;
+        std::vector<TileLayer> loadedLayers;
+        loadedLayers.emplace_back( MAX_LINES, MAX_COLUMNS, 0, 0 );
+
+        MapBinaryFile::load( binaryPath.string(), loadedMetadata, loadedLayers,
+                             MapFile::resolveGlyphAsIndex, MapBinaryFile::resolveColorAsIndex, errors );
+        loadedMetadata.firstGridLine = metadata.firstGridLine;
+        checkSameText( text, MapFile::write( loadedMetadata, loadedLayers, MapFile::getGlyphIndexPalette(), errors ), path.string() + " after .rmap save and load" );
+
+    }
+
+    std::filesystem::remove( binaryPath );
+
+}
+
+/**
+ * Colored tiles keep their color and every tile its own flags in .rmap,
+ * even where the text format has no glyph for them.
+ */
+static void testBinaryKeepsCells() {
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "raymario-tests-cells.rmap";
+
+    MapMetadata metadata;
+    std::vector<TileLayer> layers;
+    layers.emplace_back( 4, 4, 4, 4 );
+    layers.emplace_back( 4, 4, 4, 4 );
+
+    // palette: 1 a red colored tile, 'A' a terrain tile
+    std::vector<char> paletteGlyphs{ 0, MapFile::COLORED_TILE, 'A' };
+    std::vector<Color> paletteColors{ Color( 0, 0, 0, 0 ), Color( 230, 41, 55, 128 ), Color( 0, 0, 0, 0 ) };
+
+    layers[0].setTile( layers[0].getIndex( 0, 0 ), 1, TileCollisionType::solid, true );
+    layers[0].setTile( layers[0].getIndex( 3, 3 ), 1, TileCollisionType::solid_only_for_baddies, false );
+    layers[1].setTile( layers[1].getIndex( 1, 2 ), 2, TileCollisionType::non_solid, false );
+
+    std::vector<MapError> errors;
+    CHECK( MapBinaryFile::save( path.string(), metadata, layers, paletteGlyphs, paletteColors, errors ), "save failed" );
+
+    std::vector<Color> colors;
+    int glyphResolves = 0;
+    std::vector<TileLayer> loaded;
+    loaded.emplace_back( 4, 4, 0, 0 );
+    loaded.emplace_back( 4, 4, 0, 0 );
+
+    MapBinaryFile::load( path.string(), metadata, loaded,
+        [&glyphResolves]( char glyph, const MapGlyph &info, const std::string &textureKey ) -> uint16_t {
+            glyphResolves++;
+            return 2;
+        },
+        [&colors]( Color color ) -> uint16_t {
+            colors.push_back( color );
+            return 1;
+        },
+        errors );
+
+    CHECK( errors.empty(), "load reported errors" );
+    CHECK( glyphResolves == 1, "each glyph entry must be resolved once" );
+    CHECK( colors.size() == 2, "each color entry must be resolved once" );
+    CHECK( !colors.empty() && colors[0].r == 230 && colors[0].g == 41 && colors[0].b == 55 && colors[0].a == 128, "color changed" );
+
+    for ( int k = 0; k < 2; k++ ) {
+        for ( int p = 0; p < 16; p++ ) {
+            const int index = layers[k].getIndex( p / 4, p % 4 );
+            CHECK( loaded[k].getCell( index ) == layers[k].getCell( index ),
+                   "cell " + std::to_string( p ) + " of layer " + std::to_string( k ) + " changed" );
+        }
+    }
+
+    std::filesystem::remove( path );
+
+}
+
+/**
+ * Headers claiming sizes the file can't hold are rejected before the
+ * layers are allocated, and converters write nothing then.
+ */
+static void testBinaryRejectsBadSizes() {
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "raymario-tests-bad.rmap";
+    const std::filesystem::path textPath = std::filesystem::temp_directory_path() / "raymario-tests-bad.txt";
+
+    const auto writeHeader = [&path]( uint16_t layerCount, int32_t lines, int32_t columns ) {
+        std::string bytes( MapBinaryFile::MAGIC, 4 );
+        const auto put = [&bytes]( uint32_t value, int size ) {
+            for ( int i = 0; i < size; i++ ) {
+                bytes.push_back( static_cast<char>( ( value >> ( i * 8 ) ) & 0xff ) );
+            }
+        };
+        put( MapBinaryFile::VERSION, 2 );
+        put( layerCount, 2 );
+        put( static_cast<uint32_t>( lines ), 4 );
+        put( static_cast<uint32_t>( columns ), 4 );
+        put( 0, 4 );
+        put( 0, 4 );
+        std::ofstream( path, std::ios::binary ) << bytes;
+    };
+
+    const struct { uint16_t layers; int32_t lines; int32_t columns; } sizes[] = {
+        { 1, 200000, 200000 },
+        { 0, 200000, 200000 },
+        { 1, 40, 400 },         // fine, but the file has no layer data
+        { 1000, 1, 1 },
+        { 1, -1, 10 }
+    };
+
+    for ( const auto &size : sizes ) {
+
+        writeHeader( size.layers, size.lines, size.columns );
+        std::filesystem::remove( textPath );
+
+        std::vector<MapError> errors;
+        CHECK( !MapBinaryFile::convertBinaryToText( path.string(), textPath.string(), errors ),
+               "header of " + std::to_string( size.layers ) + " layers of " + std::to_string( size.lines ) + "x" + std::to_string( size.columns ) + " was accepted" );
+        CHECK( !std::filesystem::exists( textPath ), "a text file was written for a bad map" );
+
+    }
+
+    std::filesystem::remove( path );
+    std::filesystem::remove( textPath );
+
+}
+
+/**
+ * A visible colored tile has no glyph, so saving must fail and leave the
+ * existing file as it was.
+ */
+static void testLossySaveRefused() {
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "raymario-tests-lossy.txt";
+    const std::string original = "kept";
+    std::ofstream( path, std::ios::binary ) << original;
+
+    MapMetadata metadata;
+    std::vector<TileLayer> layers;
+    layers.emplace_back( 2, 2, 2, 2 );
+    layers[0].setTile( layers[0].getIndex( 0, 0 ), 1, TileCollisionType::solid, true );
+
+    const std::vector<char> paletteGlyphs{ 0, MapFile::COLORED_TILE };
+    std::vector<MapError> errors;
+
+    CHECK( !MapFile::save( path.string(), metadata, layers, paletteGlyphs, errors ), "save with a lost tile succeeded" );
+    CHECK( readFile( path ) == original, "save with a lost tile replaced the file" );
+
+    std::filesystem::remove( path );
+
+}
+
+static const std::vector<Test> TESTS = {
+    { "TileLayer resize sweep", testResizeSweep },
+    { "SelectionSet bounds, runs and fills", testSelection },
+    { "TileLayer replicates the selection", testReplicate },
+    { "TileLayer flood fill against a breadth first search", testFloodFill },
+    { "AutoTiler pieces and local retiling", testAutoTiler },
+    { "EditJournal undo and redo of paints and resizes", testJournalUndoRedo },
+    { "EditJournal strokes and the redo stack", testJournalStrokesAndRedo },
+    { "EditJournal ring eviction", testJournalEviction },
+    { "MapFile round trip of resources/maps", testMapRoundTrip },
+    { "MapFile refuses lossy saves", testLossySaveRefused },
+    { "MapBinaryFile round trip of resources/maps", testBinaryRoundTrip },
+    { "MapBinaryFile keeps colors and flags", testBinaryKeepsCells },
+    { "MapBinaryFile rejects bad sizes", testBinaryRejectsBadSizes }
+};
+
+int main( int argc, char *argv[] ) {
+
+    std::string filter;
+
+    for ( int i = 1; i < argc; i++ ) {
+        const std::string arg = argv[i];
+        if ( arg == "--filter" && i + 1 < argc ) {
+            filter = argv[++i];
+        } else {
+            std::fprintf( stderr, "usage:\n   raymario-tests [--filter text]\n" );
+            return 2;
+        }
+    }
+
+    int failedTests = 0;
+    int ran = 0;
+
+    for ( const Test &test : TESTS ) {
+
+        if ( !filter.empty() && std::string( test.name ).find( filter ) == std::string::npos ) {
+            continue;
+        }
+
+        const int before = failedChecks;
+        test.run();
+        ran++;
+
+        const bool passed = failedChecks == before;
+        if ( !passed ) {
+            failedTests++;
+        }
+        std::printf( "%s %s\n", passed ? "ok  " : "FAIL", test.name );
+
+    }
+
+    std::printf( "%d test(s), %d failed\n", ran, failedTests );
+
+    return failedTests > 0 ? 1 : 0;
+
+}